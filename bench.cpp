@@ -0,0 +1,646 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "vector.hpp"
+#include "parallel_sort.hpp"
+#include "radix_sort.hpp"
+#include "concurrent_vector.hpp"
+#include "segmented_vector.hpp"
+#include "tiered_vector.hpp"
+#include "gap_vector.hpp"
+#include "soa_vector.hpp"
+#include "bit_vector.hpp"
+#include "packed_int_vector.hpp"
+#include "delta_vector.hpp"
+#include "dict_vector.hpp"
+#include "rle_vector.hpp"
+#include "compressed_vector.hpp"
+#include "string_vector.hpp"
+#include "jagged_vector.hpp"
+#include "sparse_vector.hpp"
+
+namespace {
+
+    typedef std::chrono::steady_clock bench_clock;
+
+    template <std::size_t Size>
+    struct blob{
+        unsigned char bytes[Size];
+        blob() : bytes() {}
+        explicit blob(unsigned char value) { for (std::size_t i = 0; i < Size; ++i) bytes[i] = value; }
+    };
+
+    double elapsed_ns(bench_clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(bench_clock::now() - start).count();
+    }
+
+    //keeps the optimizer from dropping benchmarked work
+    volatile std::size_t sink;
+
+    //push_back of ~16 MiB of elements, repeated; prints ns per push and capacity overhead
+    template <std::size_t Size>
+    void bench_push_back() {
+        const std::size_t count = (std::size_t(16) << 20) / Size;
+        const int rounds = 5;
+
+        double art_ns = 0, std_ns = 0;
+        std::size_t art_capacity = 0, std_capacity = 0;
+        for (int round = 0; round < rounds; ++round) {
+            auto start = bench_clock::now();
+            {
+                art::vector<blob<Size>> art_vec;
+                for (std::size_t i = 0; i < count; ++i) art_vec.emplace_back((unsigned char) i);
+                art_capacity = art_vec.capacity();
+                sink = art_vec.size();
+            }
+            art_ns += elapsed_ns(start);
+
+            start = bench_clock::now();
+            {
+                std::vector<blob<Size>> std_vec;
+                for (std::size_t i = 0; i < count; ++i) std_vec.emplace_back((unsigned char) i);
+                std_capacity = std_vec.capacity();
+                sink = std_vec.size();
+            }
+            std_ns += elapsed_ns(start);
+        }
+
+        std::printf("push_back %3zu B: art %7.2f ns/op (slack %5.1f%%)   std %7.2f ns/op (slack %5.1f%%)\n",
+                    Size,
+                    art_ns / rounds / count, 100.0 * (art_capacity - count) / count,
+                    std_ns / rounds / count, 100.0 * (std_capacity - count) / count);
+    }
+
+    void bench_growth() {
+        bench_push_back<1>();
+        bench_push_back<2>();
+        bench_push_back<4>();
+        bench_push_back<8>();
+        bench_push_back<16>();
+        bench_push_back<32>();
+        bench_push_back<64>();
+        bench_push_back<128>();
+        bench_push_back<256>();
+    }
+
+    art::vector<std::uint64_t> random_keys(std::size_t count, std::uint64_t seed) {
+        art::vector<std::uint64_t> keys(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+            keys[i] = seed;
+        }
+        return keys;
+    }
+
+    void bench_parallel_sort() {
+        const std::size_t count = std::size_t(1) << 23;
+        art::vector<std::uint64_t> keys = random_keys(count, 42);
+
+        auto start = bench_clock::now();
+        std::sort(keys.begin(), keys.end());
+        double std_ms = elapsed_ns(start) / 1e6;
+
+        keys = random_keys(count, 42);
+        start = bench_clock::now();
+        art::parallel_sort(keys);
+        double sort_ms = elapsed_ns(start) / 1e6;
+
+        keys = random_keys(count, 42);
+        start = bench_clock::now();
+        art::parallel_stable_sort(keys);
+        double stable_ms = elapsed_ns(start) / 1e6;
+
+        std::printf("sort %zu u64 (%zu threads): std::sort %.1f ms, parallel_sort %.1f ms, parallel_stable_sort %.1f ms\n",
+                    count, art::thread_pool::instance().size() + 1, std_ms, sort_ms, stable_ms);
+    }
+
+    //uniform 64-bit ids, and skewed ones where most values are small (shifted by a random amount)
+    void bench_radix_sort() {
+        const std::size_t count = std::size_t(1) << 23;
+        const char* names[] = {"uniform", "skewed"};
+        for (int distribution = 0; distribution < 2; ++distribution) {
+            art::vector<std::uint64_t> original = random_keys(count, 7);
+            if (distribution == 1) {
+                for (std::size_t i = 0; i < count; ++i) original[i] >>= original[i] % 61;
+            }
+
+            art::vector<std::uint64_t> keys(original);
+            auto start = bench_clock::now();
+            std::sort(keys.begin(), keys.end());
+            double std_ms = elapsed_ns(start) / 1e6;
+
+            keys = original;
+            start = bench_clock::now();
+            art::radix_sort(keys);
+            double radix_ms = elapsed_ns(start) / 1e6;
+
+            std::printf("radix_sort %zu u64 %-8s: std::sort %.1f ms, radix_sort %.1f ms (%.1fx)\n",
+                        count, names[distribution], std_ms, radix_ms, std_ms / radix_ms);
+        }
+    }
+
+    //std::copy / std::equal / std::fill should take the same memmove/memcmp/memset paths as on std::vector
+    template <typename Container>
+    void run_algorithms(Container& a, Container& b, double& copy_ns, double& equal_ns, double& fill_ns) {
+        const int rounds = 200;
+        auto start = bench_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            std::copy(a.begin(), a.end(), b.begin());
+            sink = std::size_t(b[round]);
+        }
+        copy_ns = elapsed_ns(start) / rounds;
+
+        start = bench_clock::now();
+        for (int round = 0; round < rounds; ++round) sink = std::equal(a.begin(), a.end(), b.begin());
+        equal_ns = elapsed_ns(start) / rounds;
+
+        start = bench_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            std::fill(b.begin(), b.end(), (unsigned char) round);
+            sink = std::size_t(b[round]);
+        }
+        fill_ns = elapsed_ns(start) / rounds;
+    }
+
+    void bench_algorithms() {
+        const std::size_t count = std::size_t(1) << 22;
+        art::vector<unsigned char> art_a(count, 1), art_b(count, 2);
+        std::vector<unsigned char> std_a(count, 1), std_b(count, 2);
+        double art_copy, art_equal, art_fill, std_copy, std_equal, std_fill;
+        run_algorithms(art_a, art_b, art_copy, art_equal, art_fill);
+        run_algorithms(std_a, std_b, std_copy, std_equal, std_fill);
+        std::printf("algorithms on %zu bytes: copy art %.0f / std %.0f us, equal art %.0f / std %.0f us, "
+                    "fill art %.0f / std %.0f us\n", count, art_copy / 1e3, std_copy / 1e3,
+                    art_equal / 1e3, std_equal / 1e3, art_fill / 1e3, std_fill / 1e3);
+    }
+
+    //appends from every hardware thread: art::vector behind a mutex against concurrent_vector
+    void bench_concurrent_push() {
+        const std::size_t threads = std::max(2u, std::thread::hardware_concurrency());
+        const std::size_t per_thread = std::size_t(1) << 18;
+
+        auto run = [&](auto&& push) {
+            std::vector<std::thread> workers;
+            auto start = bench_clock::now();
+            for (std::size_t t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] { for (std::size_t i = 0; i < per_thread; ++i) push(t * per_thread + i); });
+            }
+            for (auto& worker : workers) worker.join();
+            return elapsed_ns(start) / (threads * per_thread);
+        };
+
+        art::vector<std::size_t> locked;
+        std::mutex lock;
+        double locked_ns = run([&](std::size_t value) {
+            std::lock_guard<std::mutex> guard(lock);
+            locked.emplace_back(value);
+        });
+        art::concurrent_vector<std::size_t> concurrent;
+        double concurrent_ns = run([&](std::size_t value) { concurrent.push_back(value); });
+        sink = locked.size() + concurrent.size();
+
+        std::printf("concurrent push_back (%zu threads): mutex + art::vector %.1f ns/op, concurrent_vector %.1f ns/op\n",
+                    threads, locked_ns, concurrent_ns);
+    }
+
+    //growth of non-trivially movable elements: art::vector relocates them, segmented_vector never does
+    void bench_segmented_push() {
+        const std::size_t count = std::size_t(1) << 20;
+        const std::string value(48, 'x');
+        auto start = bench_clock::now();
+        {
+            art::vector<std::string> art_vec;
+            for (std::size_t i = 0; i < count; ++i) art_vec.emplace_back(value);
+            sink = art_vec.size();
+        }
+        double art_ns = elapsed_ns(start) / count;
+
+        start = bench_clock::now();
+        {
+            art::segmented_vector<std::string> seg_vec;
+            for (std::size_t i = 0; i < count; ++i) seg_vec.emplace_back(value);
+            sink = seg_vec.size();
+        }
+        double seg_ns = elapsed_ns(start) / count;
+
+        std::printf("push_back %zu strings: art::vector %.1f ns/op, segmented_vector %.1f ns/op\n", count, art_ns, seg_ns);
+    }
+
+    void bench_tiered_insert() {
+        const std::size_t size = std::size_t(1) << 20, inserts = 2000;
+        art::vector<int> art_vec;
+        art::tiered_vector<int> tier_vec;
+        for (std::size_t i = 0; i < size; ++i) {
+            art_vec.push_back(int(i));
+            tier_vec.push_back(int(i));
+        }
+
+        auto start = bench_clock::now();
+        for (std::size_t i = 0; i < inserts; ++i) art_vec.insert(art_vec.cbegin() + art_vec.size() / 2, int(i));
+        double art_ns = elapsed_ns(start) / inserts;
+
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < inserts; ++i) tier_vec.insert(tier_vec.cbegin() + tier_vec.size() / 2, int(i));
+        double tier_ns = elapsed_ns(start) / inserts;
+        sink = art_vec.size() + tier_vec.size();
+
+        std::printf("middle insert into %zu ints: art::vector %.0f ns/op, tiered_vector %.0f ns/op\n", size, art_ns, tier_ns);
+    }
+
+    //inserts at a cursor in the middle that advances by one, like typing
+    void bench_gap_insert() {
+        const std::size_t size = std::size_t(1) << 20, inserts = 2000;
+        art::vector<int> art_vec;
+        art::gap_vector<int> gap_vec;
+        for (std::size_t i = 0; i < size; ++i) {
+            art_vec.push_back(int(i));
+            gap_vec.push_back(int(i));
+        }
+
+        auto start = bench_clock::now();
+        for (std::size_t i = 0; i < inserts; ++i) art_vec.insert(art_vec.cbegin() + size / 2 + i, int(i));
+        double art_ns = elapsed_ns(start) / inserts;
+
+        start = bench_clock::now();
+        for (std::size_t i = 0; i < inserts; ++i) gap_vec.insert(gap_vec.cbegin() + size / 2 + i, int(i));
+        double gap_ns = elapsed_ns(start) / inserts;
+        sink = art_vec.size() + gap_vec.size();
+
+        std::printf("cursor insert into %zu ints: art::vector %.0f ns/op, gap_vector %.0f ns/op\n", size, art_ns, gap_ns);
+    }
+
+    struct particle{
+        double x, y, z, vx, vy, vz, mass, charge, age;
+        std::uint64_t id;
+    };
+
+    //sums one field of a 10 field record stored row-wise and column-wise
+    void bench_soa_scan() {
+        const std::size_t count = std::size_t(1) << 20, rounds = 20;
+        art::vector<particle> aos;
+        art::soa_vector<double, double, double, double, double, double, double, double, double, std::uint64_t> soa;
+        for (std::size_t i = 0; i < count; ++i) {
+            double v = double(i % 1000);
+            aos.push_back(particle{v, v, v, v, v, v, v, v, v, i});
+            soa.emplace_back(v, v, v, v, v, v, v, v, v, std::uint64_t(i));
+        }
+
+        double total = 0;
+        auto start = bench_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (const particle& p : aos) total += p.mass;
+        }
+        double aos_ns = elapsed_ns(start) / (count * rounds);
+
+        start = bench_clock::now();
+        for (std::size_t r = 0; r < rounds; ++r) {
+            for (double mass : soa.column<6>()) total += mass;
+        }
+        double soa_ns = elapsed_ns(start) / (count * rounds);
+        sink = std::size_t(total);
+
+        std::printf("sum one field of %zu records: art::vector %.2f ns/row, soa_vector %.2f ns/row\n", count, aos_ns, soa_ns);
+    }
+
+    //counts set flags stored a byte each and packed 64 per word
+    void bench_bit_count() {
+        const std::size_t count = std::size_t(1) << 26;
+        art::vector<bool> bytes(count, false);
+        art::bit_vector bits(count);
+        for (std::size_t i = 0; i < count; i += 3) {
+            bytes[i] = true;
+            bits[i] = true;
+        }
+
+        auto start = bench_clock::now();
+        std::size_t byte_ones = std::size_t(std::count(bytes.begin(), bytes.end(), true));
+        double byte_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        std::size_t bit_ones = bits.count();
+        double bit_ms = elapsed_ns(start) / 1e6;
+        sink = byte_ones + bit_ones;
+
+        std::printf("count %zu flags: art::vector<bool> %.2f ms in %zu MB, bit_vector %.2f ms in %zu MB\n",
+                    count, byte_ms, count >> 20, bit_ms, (count / 8) >> 20);
+    }
+
+    //sums 64 bit ids that span 20 bits around a large base
+    void bench_packed_scan() {
+        const std::size_t count = std::size_t(1) << 24;
+        art::vector<std::uint64_t> ids;
+        ids.reserve(count);
+        std::uint64_t seed = 7;
+        for (std::size_t i = 0; i < count; ++i) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            ids.emplace_back((std::uint64_t(1) << 40) + (seed >> 44));
+        }
+        art::packed_int_vector packed(ids);
+
+        std::uint64_t total = 0;
+        auto start = bench_clock::now();
+        for (std::size_t i = 0; i < count; ++i) total += ids[i];
+        double plain_ns = elapsed_ns(start) / count;
+
+        start = bench_clock::now();
+        packed.for_each([&total](std::uint64_t id) { total += id; });
+        double packed_ns = elapsed_ns(start) / count;
+        sink = std::size_t(total);
+
+        std::printf("scan %zu 20 bit ids: art::vector %.2f ns/value in %zu MB, packed_int_vector %.2f ns/value in %zu MB\n",
+                    count, plain_ns, (count * sizeof(std::uint64_t)) >> 20, packed_ns, packed.memory_bytes() >> 20);
+    }
+
+    //intersects a dense posting list with a sparse one
+    void bench_delta_intersection() {
+        const std::size_t dense_count = std::size_t(1) << 22, sparse_count = std::size_t(1) << 12;
+        art::vector<std::uint32_t> dense, sparse;
+        std::uint32_t seed = 3, value = 0;
+        for (std::size_t i = 0; i < dense_count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            value += 1 + (seed >> 28);
+            dense.emplace_back(value);
+        }
+        for (std::size_t i = 0; i < sparse_count; ++i) sparse.emplace_back(dense[i * (dense_count / sparse_count)]);
+        art::delta_vector dense_deltas(dense), sparse_deltas(sparse);
+
+        std::vector<std::uint32_t> plain_result;
+        auto start = bench_clock::now();
+        std::set_intersection(dense.begin(), dense.end(), sparse.begin(), sparse.end(), std::back_inserter(plain_result));
+        double plain_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        art::delta_vector delta_result = art::set_intersection(dense_deltas, sparse_deltas);
+        double delta_ms = elapsed_ns(start) / 1e6;
+        sink = plain_result.size() + delta_result.size();
+
+        std::printf("intersect %zu and %zu ids: art::vector %.2f ms in %zu MB, delta_vector %.2f ms in %zu MB\n",
+                    dense_count, sparse_count, plain_ms, (dense_count * sizeof(std::uint32_t)) >> 20,
+                    delta_ms, dense_deltas.memory_bytes() >> 20);
+    }
+
+    void bench_dict_filter() {
+        const std::size_t count = std::size_t(1) << 22;
+        const char* statuses[] = {"pending", "active", "suspended", "closed", "archived", "deleted"};
+        art::vector<std::string> plain;
+        plain.reserve(count);
+        std::uint32_t seed = 5;
+        for (std::size_t i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            plain.emplace_back(statuses[(seed >> 16) % 6]);
+        }
+        art::dict_vector<std::string> dict(plain.begin(), plain.end());
+        const std::string wanted = "suspended";
+
+        auto start = bench_clock::now();
+        art::bit_vector plain_mask(count);
+        for (std::size_t i = 0; i < count; ++i) plain_mask[i] = plain[i] == wanted;
+        double plain_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        art::bit_vector dict_mask = dict.equal_mask(wanted);
+        double dict_ms = elapsed_ns(start) / 1e6;
+        sink = plain_mask.count() + dict_mask.count();
+
+        std::printf("status == %s over %zu rows: art::vector<std::string> %.2f ms in %zu MB, dict_vector %.2f ms in %zu MB\n",
+                    wanted.c_str(), count, plain_ms, (count * sizeof(std::string)) >> 20, dict_ms, dict.memory_bytes() >> 20);
+    }
+
+    void bench_rle_encode() {
+        const std::size_t count = std::size_t(1) << 24;
+        art::vector<std::int32_t> series;
+        series.reserve(count);
+        std::uint32_t seed = 9;
+        std::int32_t level = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            if ((seed >> 22) == 0) level = std::int32_t(seed & 0xff);
+            series.emplace_back(level);
+        }
+
+        auto start = bench_clock::now();
+        art::rle_vector<std::int32_t> runs(series);
+        double encode_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        std::int64_t plain_sum = 0;
+        for (std::int32_t value : series) plain_sum += value;
+        double plain_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        std::int64_t run_sum = 0;
+        for (auto run : runs.runs()) run_sum += std::int64_t(run.value) * std::int64_t(run.length());
+        double run_ms = elapsed_ns(start) / 1e6;
+        sink = std::size_t(plain_sum + run_sum);
+
+        std::printf("rle %zu values in %zu runs: encode %.2f ms, sum art::vector %.2f ms in %zu MB, rle_vector %.3f ms in %zu KB\n",
+                    count, runs.run_count(), encode_ms, plain_ms, (count * sizeof(std::int32_t)) >> 20, run_ms, runs.memory_bytes() >> 10);
+    }
+
+    void bench_compressed_history() {
+        struct sample{
+            std::uint64_t time;
+            std::int32_t value;
+            std::uint32_t flags;
+        };
+        const std::size_t count = std::size_t(1) << 23;
+        std::uint32_t seed = 13;
+        std::int32_t level = 0;
+        auto next = [&](std::size_t i) {
+            seed = seed * 1664525u + 1013904223u;
+            if ((seed >> 24) == 0) level += std::int32_t(seed >> 20 & 15) - 8;
+            return sample{1700000000000ull + i * 250, level, (seed >> 31) ? 1u : 0u};
+        };
+
+        auto start = bench_clock::now();
+        art::vector<sample> plain;
+        for (std::size_t i = 0; i < count; ++i) plain.emplace_back(next(i));
+        double plain_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        art::compressed_vector<sample> history;
+        for (std::size_t i = 0; i < count; ++i) history.push_back(plain[i]);
+        history.flush();
+        double history_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        std::int64_t total = 0;
+        history.for_each_chunk([&](art::span<const sample> chunk) {
+            for (const sample& s : chunk) total += s.value;
+        });
+        double scan_ms = elapsed_ns(start) / 1e6;
+        sink = std::size_t(total);
+
+        std::printf("history of %zu samples: append art::vector %.1f ms in %zu MB, compressed_vector %.1f ms in %zu MB, "
+                    "full scan %.1f ms\n", count, plain_ms, (plain.capacity() * sizeof(sample)) >> 20, history_ms,
+                    history.memory_bytes() >> 20, scan_ms);
+    }
+
+    void bench_string_sort() {
+        const std::size_t count = std::size_t(1) << 22;
+        std::vector<std::string> source;
+        source.reserve(count);
+        std::uint32_t seed = 17;
+        for (std::size_t i = 0; i < count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            std::string text = "user/";
+            for (std::uint32_t c = 0, length = 4 + (seed >> 28); c < length; ++c) {
+                seed = seed * 1664525u + 1013904223u;
+                text.push_back(char('a' + (seed >> 24) % 26));
+            }
+            source.push_back(text);
+        }
+
+        auto start = bench_clock::now();
+        art::vector<std::string> plain;
+        for (const std::string& text : source) plain.emplace_back(text);
+        std::sort(plain.begin(), plain.end());
+        double plain_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        art::string_vector strings;
+        for (const std::string& text : source) strings.push_back(text);
+        strings.sort();
+        double strings_ms = elapsed_ns(start) / 1e6;
+        sink = plain.size() + strings.size();
+
+        std::printf("build and sort %zu strings: art::vector<std::string> %.0f ms, string_vector %.0f ms in %zu MB\n",
+                    count, plain_ms, strings_ms, strings.memory_bytes() >> 20);
+    }
+
+    void bench_jagged_build() {
+        const std::size_t vertices = std::size_t(1) << 20, edge_count = std::size_t(1) << 23;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        edges.reserve(edge_count);
+        std::uint32_t seed = 29;
+        for (std::size_t i = 0; i < edge_count; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            std::uint32_t from = seed % vertices;
+            seed = seed * 1664525u + 1013904223u;
+            edges.emplace_back(from, seed % vertices);
+        }
+
+        auto start = bench_clock::now();
+        art::vector<art::vector<std::uint32_t>> nested(vertices);
+        for (const auto& edge : edges) nested[edge.first].emplace_back(edge.second);
+        double nested_build_ms = elapsed_ns(start) / 1e6;
+        std::size_t nested_bytes = nested.capacity() * sizeof(art::vector<std::uint32_t>);
+        for (const auto& row : nested) nested_bytes += row.capacity() * sizeof(std::uint32_t);
+
+        start = bench_clock::now();
+        auto graph = art::jagged_vector<std::uint32_t>::from_pairs(vertices, edges.begin(), edges.end());
+        double jagged_build_ms = elapsed_ns(start) / 1e6;
+
+        //one hop of a traversal: sum the neighbours of every vertex
+        start = bench_clock::now();
+        std::uint64_t nested_sum = 0;
+        for (const auto& row : nested) {
+            for (std::uint32_t to : row) nested_sum += to;
+        }
+        double nested_scan_ms = elapsed_ns(start) / 1e6;
+
+        start = bench_clock::now();
+        std::uint64_t jagged_sum = 0;
+        for (art::span<const std::uint32_t> row : static_cast<const art::jagged_vector<std::uint32_t>&>(graph)) {
+            for (std::uint32_t to : row) jagged_sum += to;
+        }
+        double jagged_scan_ms = elapsed_ns(start) / 1e6;
+        sink = std::size_t(nested_sum + jagged_sum);
+
+        std::printf("adjacency of %zu edges: nested vectors build %.0f ms scan %.1f ms in %zu MB, "
+                    "jagged_vector build %.0f ms scan %.1f ms in %zu MB\n", edge_count, nested_build_ms, nested_scan_ms,
+                    nested_bytes >> 20, jagged_build_ms, jagged_scan_ms, graph.memory_bytes() >> 20);
+    }
+    void bench_sparse_dot() {
+        //hyper sparse: 10^4 non zeros over 10^9 dimensions, half of them shared by both operands
+        const std::size_t dims = 1000000000, nonzeros = 10000, rounds = 1000;
+        art::sparse_vector<double> a(dims), b(dims);
+        std::map<std::size_t, double> map_a, map_b;
+        std::uint64_t seed = 41;
+        for (std::size_t i = 0; i < nonzeros; ++i) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            std::size_t index = std::size_t(seed >> 20) % dims;
+            a.set(index, 1.0 + i % 3);
+            map_a[index] = 1.0 + i % 3;
+            if (i % 2) index = std::size_t(seed >> 3) % dims;
+            b.set(index, 0.5 * (i % 5));
+            if (i % 5) map_b[index] = 0.5 * (i % 5);
+            else map_b.erase(index);
+        }
+
+        auto start = bench_clock::now();
+        double map_sum = 0;
+        for (std::size_t round = 0; round < rounds; ++round) {
+            auto x = map_a.begin(), y = map_b.begin();
+            while (x != map_a.end() && y != map_b.end()) {
+                if (x->first < y->first) ++x;
+                else if (y->first < x->first) ++y;
+                else map_sum += (x++)->second * (y++)->second;
+            }
+        }
+        double map_us = elapsed_ns(start) / 1e3 / rounds;
+
+        start = bench_clock::now();
+        double sparse_sum = 0;
+        for (std::size_t round = 0; round < rounds; ++round) sparse_sum += a.dot(b);
+        double sparse_us = elapsed_ns(start) / 1e3 / rounds;
+
+        //clustered: a quarter of 2^24 dimensions filled in runs, so most stored chunks are dense
+        const std::size_t cluster_dims = std::size_t(1) << 24;
+        art::vector<double> dense_a(cluster_dims, 0.0), dense_b(cluster_dims, 0.0);
+        for (std::size_t i = 0; i < cluster_dims; ++i) {
+            if ((i >> 14) % 4 == 0) dense_a[i] = double(i % 11);
+            if ((i >> 14) % 4 == 0 || (i >> 14) % 4 == 1) dense_b[i] = double(i % 7);
+        }
+        art::sparse_vector<double> clustered_a(art::span<const double>(dense_a.data(), cluster_dims));
+        art::sparse_vector<double> clustered_b(art::span<const double>(dense_b.data(), cluster_dims));
+
+        start = bench_clock::now();
+        double dense_sum = 0;
+        for (std::size_t round = 0; round < 10; ++round) {
+            for (std::size_t i = 0; i < cluster_dims; ++i) dense_sum += dense_a[i] * dense_b[i];
+        }
+        double dense_ms = elapsed_ns(start) / 1e6 / 10;
+
+        start = bench_clock::now();
+        double clustered_sum = 0;
+        for (std::size_t round = 0; round < 10; ++round) clustered_sum += clustered_a.dot(clustered_b);
+        double clustered_ms = elapsed_ns(start) / 1e6 / 10;
+        sink = std::size_t(map_sum + sparse_sum + dense_sum + clustered_sum);
+
+        std::printf("dot of %zu non zeros in %zu dims: std::map %.1f us, sparse_vector %.1f us in %zu KB; "
+                    "clustered 2^24 dims: dense %.2f ms, sparse_vector %.2f ms (%zu of %zu chunks dense)\n",
+                    nonzeros, dims, map_us, sparse_us, a.memory_bytes() >> 10, dense_ms, clustered_ms,
+                    clustered_a.dense_chunks(), clustered_a.chunk_count());
+    }
+}
+
+int main() {
+    bench_growth();
+    bench_parallel_sort();
+    bench_radix_sort();
+    bench_algorithms();
+    bench_concurrent_push();
+    bench_segmented_push();
+    bench_tiered_insert();
+    bench_gap_insert();
+    bench_soa_scan();
+    bench_bit_count();
+    bench_packed_scan();
+    bench_delta_intersection();
+    bench_dict_filter();
+    bench_rle_encode();
+    bench_compressed_history();
+    bench_string_sort();
+    bench_jagged_build();
+    bench_sparse_dot();
+    return 0;
+}
@@ -0,0 +1,589 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+#include "span.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        inline unsigned popcount64(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_popcountll(word));
+#else
+            word = word - ((word >> 1) & 0x5555555555555555ull);
+            word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+            word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+            return unsigned((word * 0x0101010101010101ull) >> 56);
+#endif
+        }
+
+        //word must not be 0
+        inline unsigned count_trailing_zeros64(std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctzll(word));
+#else
+            unsigned zeros = 0;
+            while (!(word & 1)) {
+                word >>= 1;
+                ++zeros;
+            }
+            return zeros;
+#endif
+        }
+
+        //position of the set bit of rank nth in word, which has more than nth set bits
+        inline unsigned select64(std::uint64_t word, unsigned nth) noexcept {
+#if defined(__BMI2__)
+            return count_trailing_zeros64(_pdep_u64(std::uint64_t(1) << nth, word));
+#else
+            for (; nth; --nth) word &= word - 1;
+            return count_trailing_zeros64(word);
+#endif
+        }
+    }
+
+    //Packed flags, 64 per std::uint64_t word. Bits past size() in the last word are kept zero, so
+    //count, comparisons and the bulk operators work a word at a time without masking; the bulk loops
+    //are plain word loops the compiler vectorizes. Element access goes through a proxy reference
+    //like std::vector<bool>.
+    template <typename Allocator = std::allocator<std::uint64_t>>
+    class basic_bit_vector{
+    public:
+        typedef bool                                                                       value_type;
+        typedef std::uint64_t                                                              word_type;
+        typedef Allocator                                                                  allocator_type;
+        typedef std::size_t                                                                size_type;
+        typedef std::ptrdiff_t                                                             difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> word_allocator;
+
+        static const size_type WORD_BITS = 64;
+        static const size_type npos = size_type(-1);
+
+        class reference{
+        public:
+            reference(word_type* word, word_type mask) noexcept : _m_word(word), _m_mask(mask) {}
+            reference(const reference&) = default;
+
+            operator bool() const noexcept {return (*_m_word & _m_mask) != 0;}
+            bool operator~() const noexcept {return !bool(*this);}
+            reference& operator=(bool value) noexcept {
+                if (value) *_m_word |= _m_mask;
+                else *_m_word &= ~_m_mask;
+                return *this;
+            }
+            reference& operator=(const reference& other) noexcept {return *this = bool(other);}
+            reference& flip() noexcept {*_m_word ^= _m_mask; return *this;}
+
+        private:
+            word_type* _m_word;
+            word_type _m_mask;
+        };
+        typedef bool const_reference;
+
+        typedef detail::index_iterator<basic_bit_vector, reference, bool>  iterator;
+        typedef detail::index_iterator<const basic_bit_vector, bool, bool> const_iterator;
+
+        // construct/copy/destroy
+        explicit basic_bit_vector(const Allocator& alloc = Allocator());
+        explicit basic_bit_vector(size_type size, bool value = false, const Allocator& alloc = Allocator());
+        basic_bit_vector(std::initializer_list<bool> init, const Allocator& alloc = Allocator());
+
+        allocator_type get_allocator() const;
+
+        reference       operator[](size_type pos);
+        bool            operator[](size_type pos) const;
+        reference       at(size_type pos);
+        bool            at(size_type pos) const;
+        bool            test(size_type pos) const;
+        reference       front();
+        bool            front() const;
+        reference       back();
+        bool            back() const;
+
+        iterator        begin() noexcept;
+        const_iterator  begin() const noexcept;
+        const_iterator  cbegin() const noexcept;
+        iterator        end() noexcept;
+        const_iterator  end() const noexcept;
+        const_iterator  cend() const noexcept;
+
+        //the packed words, bit i of the vector is bit i % 64 of word i / 64
+        span<const word_type> words() const noexcept;
+        span<word_type> words() noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+        void reserve(size_type bits);
+        size_type capacity() const noexcept;
+        void shrink_to_fit();
+
+        // modifiers
+        void clear() noexcept;
+        void push_back(bool value);
+        void pop_back();
+        void resize(size_type count, bool value = false);
+        void swap(basic_bit_vector& other) noexcept;
+
+        basic_bit_vector& set() noexcept;
+        basic_bit_vector& set(size_type pos, bool value = true);
+        basic_bit_vector& reset() noexcept;
+        basic_bit_vector& reset(size_type pos);
+        basic_bit_vector& flip() noexcept;
+        basic_bit_vector& flip(size_type pos);
+
+        // queries
+        size_type count() const noexcept;
+        bool all() const noexcept;
+        bool any() const noexcept;
+        bool none() const noexcept;
+        //index of the first set bit, npos if there is none
+        size_type find_first() const noexcept;
+        //index of the first set bit after pos, npos if there is none
+        size_type find_next(size_type pos) const noexcept;
+
+        //both operands must have the same size
+        basic_bit_vector& operator&=(const basic_bit_vector& other);
+        basic_bit_vector& operator|=(const basic_bit_vector& other);
+        basic_bit_vector& operator^=(const basic_bit_vector& other);
+        //clears the bits set in other
+        basic_bit_vector& subtract(const basic_bit_vector& other);
+        basic_bit_vector operator~() const;
+
+        template <class A>
+        friend bool operator==(const basic_bit_vector<A>& lhs, const basic_bit_vector<A>& rhs);
+
+    private:
+        vector<word_type, word_allocator> _m_words;
+        size_type _m_size = 0;
+
+        static size_type _m_word_count(size_type bits) noexcept {return (bits + WORD_BITS - 1) / WORD_BITS;}
+        static word_type _m_mask(size_type pos) noexcept {return word_type(1) << (pos % WORD_BITS);}
+        //zeroes the bits past size() in the last word
+        void _m_clear_tail() noexcept;
+        void _m_check_size(const basic_bit_vector& other) const;
+    };
+
+    typedef basic_bit_vector<> bit_vector;
+
+    template <typename Allocator> const typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::WORD_BITS;
+    template <typename Allocator> const typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::npos;
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::_m_clear_tail() noexcept {
+        if (_m_size % WORD_BITS) _m_words[_m_words.size() - 1] &= _m_mask(_m_size) - 1;
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::_m_check_size(const basic_bit_vector& other) const {
+        if (other._m_size != _m_size) throw std::invalid_argument("bit_vector sizes differ");
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>::basic_bit_vector(const Allocator& alloc) : _m_words(word_allocator(alloc)) {}
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>::basic_bit_vector(size_type size, bool value, const Allocator& alloc)
+        : _m_words(word_allocator(alloc)) {
+        resize(size, value);
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>::basic_bit_vector(std::initializer_list<bool> init, const Allocator& alloc)
+        : _m_words(word_allocator(alloc)) {
+        reserve(init.size());
+        for (bool value : init) push_back(value);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::allocator_type basic_bit_vector<Allocator>::get_allocator() const {
+        return allocator_type(_m_words.get_allocator());
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::reference basic_bit_vector<Allocator>::operator[](size_type pos) {
+        return reference(&_m_words[pos / WORD_BITS], _m_mask(pos));
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::operator[](size_type pos) const {
+        return (_m_words[pos / WORD_BITS] & _m_mask(pos)) != 0;
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::reference basic_bit_vector<Allocator>::at(size_type pos) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::test(size_type pos) const {
+        return at(pos);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::reference basic_bit_vector<Allocator>::front() {
+        return (*this)[0];
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::reference basic_bit_vector<Allocator>::back() {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::back() const {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::iterator basic_bit_vector<Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::const_iterator basic_bit_vector<Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::const_iterator basic_bit_vector<Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::iterator basic_bit_vector<Allocator>::end() noexcept {
+        return iterator(this, _m_size);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::const_iterator basic_bit_vector<Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::const_iterator basic_bit_vector<Allocator>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator>
+    span<const typename basic_bit_vector<Allocator>::word_type> basic_bit_vector<Allocator>::words() const noexcept {
+        return span<const word_type>(_m_words.data(), _m_words.size());
+    }
+
+    template<typename Allocator>
+    span<typename basic_bit_vector<Allocator>::word_type> basic_bit_vector<Allocator>::words() noexcept {
+        return span<word_type>(_m_words.data(), _m_words.size());
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::max_size() const noexcept {
+        return std::numeric_limits<size_type>::max();
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::reserve(size_type bits) {
+        _m_words.reserve(_m_word_count(bits));
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::capacity() const noexcept {
+        return _m_words.capacity() * WORD_BITS;
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::shrink_to_fit() {
+        _m_words.shrink_to_fit();
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::clear() noexcept {
+        _m_words.clear();
+        _m_size = 0;
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::push_back(bool value) {
+        if (_m_size % WORD_BITS == 0) _m_words.emplace_back(word_type(0));
+        if (value) _m_words[_m_size / WORD_BITS] |= _m_mask(_m_size);
+        ++_m_size;
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::pop_back() {
+        resize(_m_size - 1);
+    }
+
+    //the new bits of a partly used last word are already zero
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::resize(size_type count, bool value) {
+        size_type old_size = _m_size;
+        size_type words = _m_word_count(count);
+        if (words < _m_words.size()) _m_words.erase(_m_words.begin() + words, _m_words.end());
+        else while (_m_words.size() < words) _m_words.emplace_back(value ? ~word_type(0) : word_type(0));
+        _m_size = count;
+        if (value && count > old_size && old_size % WORD_BITS) {
+            _m_words[old_size / WORD_BITS] |= ~(_m_mask(old_size) - 1);
+        }
+        _m_clear_tail();
+    }
+
+    template<typename Allocator>
+    void basic_bit_vector<Allocator>::swap(basic_bit_vector& other) noexcept {
+        _m_words.swap(other._m_words);
+        std::swap(_m_size, other._m_size);
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::set() noexcept {
+        std::fill(_m_words.begin(), _m_words.end(), ~word_type(0));
+        _m_clear_tail();
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::set(size_type pos, bool value) {
+        at(pos) = value;
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::reset() noexcept {
+        std::fill(_m_words.begin(), _m_words.end(), word_type(0));
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::reset(size_type pos) {
+        at(pos) = false;
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::flip() noexcept {
+        word_type* words = _m_words.data();
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) words[i] = ~words[i];
+        _m_clear_tail();
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::flip(size_type pos) {
+        at(pos).flip();
+        return *this;
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::count() const noexcept {
+        const word_type* words = _m_words.data();
+        size_type ones = 0;
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) ones += detail::popcount64(words[i]);
+        return ones;
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::all() const noexcept {
+        return count() == _m_size;
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::any() const noexcept {
+        return find_first() != npos;
+    }
+
+    template<typename Allocator>
+    bool basic_bit_vector<Allocator>::none() const noexcept {
+        return !any();
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::find_first() const noexcept {
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) {
+            if (_m_words[i]) return i * WORD_BITS + detail::count_trailing_zeros64(_m_words[i]);
+        }
+        return npos;
+    }
+
+    template<typename Allocator>
+    typename basic_bit_vector<Allocator>::size_type basic_bit_vector<Allocator>::find_next(size_type pos) const noexcept {
+        ++pos;
+        if (pos >= _m_size) return npos;
+        size_type i = pos / WORD_BITS;
+        word_type word = _m_words[i] & ~(_m_mask(pos) - 1);
+        for (size_type n = _m_words.size();;) {
+            if (word) return i * WORD_BITS + detail::count_trailing_zeros64(word);
+            if (++i == n) return npos;
+            word = _m_words[i];
+        }
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::operator&=(const basic_bit_vector& other) {
+        _m_check_size(other);
+        word_type* words = _m_words.data();
+        const word_type* others = other._m_words.data();
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) words[i] &= others[i];
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::operator|=(const basic_bit_vector& other) {
+        _m_check_size(other);
+        word_type* words = _m_words.data();
+        const word_type* others = other._m_words.data();
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) words[i] |= others[i];
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::operator^=(const basic_bit_vector& other) {
+        _m_check_size(other);
+        word_type* words = _m_words.data();
+        const word_type* others = other._m_words.data();
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) words[i] ^= others[i];
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator>& basic_bit_vector<Allocator>::subtract(const basic_bit_vector& other) {
+        _m_check_size(other);
+        word_type* words = _m_words.data();
+        const word_type* others = other._m_words.data();
+        for (size_type i = 0, n = _m_words.size(); i < n; ++i) words[i] &= ~others[i];
+        return *this;
+    }
+
+    template<typename Allocator>
+    basic_bit_vector<Allocator> basic_bit_vector<Allocator>::operator~() const {
+        basic_bit_vector result(*this);
+        result.flip();
+        return result;
+    }
+
+    template <class Allocator>
+    basic_bit_vector<Allocator> operator&(basic_bit_vector<Allocator> lhs, const basic_bit_vector<Allocator>& rhs) {
+        return lhs &= rhs;
+    }
+
+    template <class Allocator>
+    basic_bit_vector<Allocator> operator|(basic_bit_vector<Allocator> lhs, const basic_bit_vector<Allocator>& rhs) {
+        return lhs |= rhs;
+    }
+
+    template <class Allocator>
+    basic_bit_vector<Allocator> operator^(basic_bit_vector<Allocator> lhs, const basic_bit_vector<Allocator>& rhs) {
+        return lhs ^= rhs;
+    }
+
+    template <class Allocator>
+    bool operator==(const basic_bit_vector<Allocator>& lhs, const basic_bit_vector<Allocator>& rhs) {
+        return lhs._m_size == rhs._m_size && std::equal(lhs._m_words.begin(), lhs._m_words.end(), rhs._m_words.begin());
+    }
+
+    template <class Allocator>
+    bool operator!=(const basic_bit_vector<Allocator>& lhs, const basic_bit_vector<Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    //Rank/select directory over a bit_vector: one cumulative count per 512 bit block, 1/8 bit of
+    //overhead per bit. rank is O(1), select a binary search over the blocks plus a scan of at most
+    //eight words. The index describes the bits at build time; rebuild it after modifying them.
+    template <typename Allocator = std::allocator<std::uint64_t>>
+    class basic_bit_rank_select{
+    public:
+        typedef std::size_t size_type;
+
+        static const size_type BLOCK_WORDS = 8;
+        static const size_type npos = size_type(-1);
+
+        basic_bit_rank_select() = default;
+        explicit basic_bit_rank_select(const basic_bit_vector<Allocator>& bits);
+
+        //set bits in [0, pos)
+        size_type rank(size_type pos) const noexcept;
+        //index of the set bit with rank nth counting from 0, npos if there are not that many
+        size_type select(size_type nth) const noexcept;
+        size_type ones() const noexcept {return _m_blocks.empty() ? 0 : _m_blocks[_m_blocks.size() - 1];}
+
+    private:
+        const std::uint64_t* _m_words = nullptr;
+        size_type _m_word_count = 0;
+        //ones before each block, plus the total at the end
+        vector<size_type> _m_blocks;
+    };
+
+    typedef basic_bit_rank_select<> bit_rank_select;
+
+    template <typename Allocator> const typename basic_bit_rank_select<Allocator>::size_type basic_bit_rank_select<Allocator>::BLOCK_WORDS;
+    template <typename Allocator> const typename basic_bit_rank_select<Allocator>::size_type basic_bit_rank_select<Allocator>::npos;
+
+    template <typename Allocator>
+    basic_bit_rank_select<Allocator>::basic_bit_rank_select(const basic_bit_vector<Allocator>& bits)
+        : _m_words(bits.words().data()), _m_word_count(bits.words().size()) {
+        _m_blocks.reserve(_m_word_count / BLOCK_WORDS + 2);
+        size_type ones = 0;
+        for (size_type i = 0; i < _m_word_count; ++i) {
+            if (i % BLOCK_WORDS == 0) _m_blocks.emplace_back(ones);
+            ones += detail::popcount64(_m_words[i]);
+        }
+        _m_blocks.emplace_back(ones);
+    }
+
+    template <typename Allocator>
+    typename basic_bit_rank_select<Allocator>::size_type basic_bit_rank_select<Allocator>::rank(size_type pos) const noexcept {
+        size_type word = pos / 64;
+        size_type ones = _m_blocks[word / BLOCK_WORDS];
+        for (size_type i = word / BLOCK_WORDS * BLOCK_WORDS; i < word; ++i) ones += detail::popcount64(_m_words[i]);
+        if (pos % 64) ones += detail::popcount64(_m_words[word] & ((std::uint64_t(1) << (pos % 64)) - 1));
+        return ones;
+    }
+
+    template <typename Allocator>
+    typename basic_bit_rank_select<Allocator>::size_type basic_bit_rank_select<Allocator>::select(size_type nth) const noexcept {
+        if (nth >= ones()) return npos;
+        //last block starting with at most nth ones
+        size_type block = size_type(std::upper_bound(_m_blocks.begin(), _m_blocks.end(), nth) - _m_blocks.begin()) - 1;
+        nth -= _m_blocks[block];
+        for (size_type i = block * BLOCK_WORDS;; ++i) {
+            size_type ones = detail::popcount64(_m_words[i]);
+            if (nth < ones) return i * 64 + detail::select64(_m_words[i], unsigned(nth));
+            nth -= ones;
+        }
+    }
+}
@@ -1,9 +1,38 @@
 
 #include <vector>
+#include <atomic>
+#include <cstdint>
 #include <exception>
+#include <functional>
+#include <map>
+#include <numeric>
+#include <string>
+#include <thread>
 
 #include "catch.hpp"
 #include "vector.hpp"
+#include "push_latency.hpp"
+#include "parallel.hpp"
+#include "parallel_sort.hpp"
+#include "radix_sort.hpp"
+#include "concurrent_vector.hpp"
+#include "sharded_vector.hpp"
+#include "rcu_vector.hpp"
+#include "cow_vector.hpp"
+#include "persistent_vector.hpp"
+#include "segmented_vector.hpp"
+#include "tiered_vector.hpp"
+#include "gap_vector.hpp"
+#include "soa_vector.hpp"
+#include "bit_vector.hpp"
+#include "packed_int_vector.hpp"
+#include "delta_vector.hpp"
+#include "dict_vector.hpp"
+#include "rle_vector.hpp"
+#include "compressed_vector.hpp"
+#include "string_vector.hpp"
+#include "jagged_vector.hpp"
+#include "sparse_vector.hpp"
 
 TEST_CASE("Constructing vector") {
 
@@ -359,4 +388,1981 @@ TEST_CASE("emplace_back"){
             REQUIRE(art_vec[0].getA() == 10);
         }
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Push latency hook") {
+
+    SECTION("histogram percentiles") {
+        art::latency_histogram histogram;
+        for (std::uint64_t i = 1; i <= 1000; ++i) histogram.record(i);
+        REQUIRE(histogram.count() == 1000);
+        REQUIRE(histogram.min() == 1);
+        REQUIRE(histogram.max() == 1000);
+        REQUIRE(histogram.value_at_percentile(100.0) == 1000);
+        auto median = histogram.value_at_percentile(50.0);
+        REQUIRE(median >= 500);
+        REQUIRE(median <= 516);
+    }
+
+#ifdef ART_VECTOR_PUSH_LATENCY
+    SECTION("every push is recorded and growth is traced") {
+        art::vector<art::growth_trace_event> events;
+        art::push_latency_hook hook(std::chrono::nanoseconds(0), [&events](const art::growth_trace_event& event) {
+            events.emplace_back(event);
+        });
+        art::vector<int> art_vec;
+        art_vec.set_push_hook(&hook);
+        REQUIRE(art_vec.push_hook() == &hook);
+        for (int i = 0; i < 5; ++i) {
+            int value = i;
+            art_vec.push_back(std::move(value));
+        }
+        art_vec.insert(art_vec.begin(), 7);
+        REQUIRE(hook.histogram().count() == 6);
+        bool saw_growth = false;
+        for (auto it = events.begin(); it != events.end(); ++it) {
+            if (it->new_capacity != it->old_capacity) saw_growth = true;
+        }
+        REQUIRE(saw_growth);
+    }
+
+    SECTION("no hook, no records") {
+        art::push_latency_hook hook;
+        art::vector<int> art_vec;
+        art_vec.emplace_back(1);
+        art_vec.set_push_hook(&hook);
+        art_vec.set_push_hook(nullptr);
+        art_vec.emplace_back(2);
+        REQUIRE(hook.histogram().count() == 0);
+    }
+#else
+    SECTION("hook compiled out") {
+        //no hook pointer next to the allocator and the three pointers
+        REQUIRE(sizeof(art::vector<int>) <= 4 * sizeof(int*));
+    }
+#endif
+}
+
+TEST_CASE("Growth policy") {
+
+    SECTION("first allocation depends on element size") {
+        REQUIRE(art::growth_policy<char>::next_capacity(0, 1) == 64);
+        REQUIRE(art::growth_policy<int>::next_capacity(0, 1) == 16);
+        REQUIRE(art::growth_policy<char[256]>::next_capacity(0, 1) == 1);
+        REQUIRE(art::growth_policy<int>::next_capacity(0, 100) == 100);
+    }
+
+    SECTION("small vectors double, large vectors grow by half and fill pages") {
+        typedef art::growth_policy<int> policy;
+        REQUIRE(policy::next_capacity(16, 17) == 32);
+        std::size_t large = policy::LARGE_CAPACITY * 2;
+        std::size_t grown = policy::next_capacity(large, large + 1);
+        REQUIRE(grown >= large + large / 2);
+        REQUIRE(grown < large * 2);
+        REQUIRE(grown * sizeof(int) % policy::PAGE_BYTES == 0);
+    }
+
+    SECTION("push_back follows the policy") {
+        art::vector<int> art_vec;
+        art_vec.emplace_back(1);
+        REQUIRE(art_vec.capacity() == art::growth_policy<int>::FIRST_CAPACITY);
+        for (int i = 0; i < 100; ++i) art_vec.emplace_back(i);
+        REQUIRE(art_vec.size() == 101);
+        REQUIRE(art_vec.capacity() == 128);
+        REQUIRE(art_vec[100] == 99);
+    }
+}
+
+TEST_CASE("Parallel construction and destruction") {
+
+    struct counted{
+        static std::atomic<int>& alive() { static std::atomic<int> count(0); return count; }
+        int value;
+        counted() : value(7) { ++alive(); }
+        counted(const counted& other) : value(other.value) { ++alive(); }
+        ~counted() { --alive(); }
+    };
+
+    art::set_parallel_threshold(64);
+
+    SECTION("copy, assign and destroy above the threshold") {
+        {
+            art::vector<counted> source(10000);
+            REQUIRE(counted::alive() == 10000);
+            art::vector<counted> copy(source);
+            art::vector<counted> assigned;
+            assigned = source;
+            REQUIRE(counted::alive() == 30000);
+            REQUIRE(copy.size() == source.size());
+            REQUIRE(assigned[9999].value == 7);
+        }
+        REQUIRE(counted::alive() == 0);
+    }
+
+    SECTION("assign value and iterator range") {
+        art::vector<std::string> art_vec;
+        art_vec.assign(1000, std::string("feature"));
+        REQUIRE(art_vec.size() == 1000);
+        REQUIRE(art_vec[999] == "feature");
+
+        std::vector<int> std_vec(5000);
+        for (int i = 0; i < 5000; ++i) std_vec[i] = i;
+        art::vector<int> from_range(std_vec.begin(), std_vec.end());
+        REQUIRE(from_range == std_vec);
+    }
+
+    SECTION("thread pool covers the range and rethrows") {
+        art::thread_pool pool(3);
+        std::vector<std::atomic<int>> hits(1001);
+        pool.parallel_chunks(hits.size(), [&hits](std::size_t first, std::size_t last) {
+            for (std::size_t i = first; i < last; ++i) ++hits[i];
+        });
+        bool all_once = true;
+        for (auto& hit : hits) all_once = all_once && hit == 1;
+        REQUIRE(all_once);
+        REQUIRE_THROWS_AS(pool.parallel_chunks(100, [](std::size_t first, std::size_t) {
+            if (first != 0) throw std::runtime_error("chunk failed");
+        }), std::runtime_error);
+    }
+
+    SECTION("move construction steals the buffer") {
+        art::vector<int> source = {1, 2, 3};
+        const int* data = source.data();
+        art::vector<int> moved(std::move(source));
+        REQUIRE(moved.data() == data);
+        REQUIRE(moved.size() == 3);
+        REQUIRE(source.empty());
+    }
+
+    art::set_parallel_threshold(0);
+}
+
+TEST_CASE("Parallel algorithms") {
+    art::thread_pool pool(3);
+    art::parallel::options opts;
+    opts.pool = &pool;
+
+    art::vector<long long> art_vec;
+    for (long long i = 0; i < 100000; ++i) art_vec.emplace_back(i);
+
+    SECTION("for_each touches every element once") {
+        art::parallel::parallel_for_each(art_vec.begin(), art_vec.end(), [](long long& value) { value *= 2; }, opts);
+        bool doubled = true;
+        for (long long i = 0; i < 100000; ++i) doubled = doubled && art_vec[i] == 2 * i;
+        REQUIRE(doubled);
+    }
+
+    SECTION("transform into another vector") {
+        art::vector<long long> squares(art_vec.size());
+        auto end = art::parallel::parallel_transform(art_vec.begin(), art_vec.end(), squares.begin(),
+                                                     [](long long value) { return value * value; }, opts);
+        REQUIRE(end == squares.end());
+        REQUIRE(squares[99999] == 99999LL * 99999LL);
+    }
+
+    SECTION("reduce with adaptive and fixed chunks") {
+        auto plus = [](long long a, long long b) { return a + b; };
+        long long expected = 99999LL * 100000LL / 2;
+        REQUIRE(art::parallel::parallel_reduce(art_vec.begin(), art_vec.end(), 0LL, plus, opts) == expected);
+        opts.grain = 7;
+        REQUIRE(art::parallel::parallel_reduce(art_vec.begin(), art_vec.end(), 5LL, plus, opts) == expected + 5);
+        REQUIRE(art::parallel::parallel_reduce(art_vec.begin(), art_vec.begin(), 5LL, plus, opts) == 5);
+    }
+
+    SECTION("deterministic reduce is reproducible") {
+        art::vector<double> values;
+        for (int i = 0; i < 50000; ++i) values.emplace_back(1.0 / (i + 1));
+        opts.deterministic = true;
+        auto plus = [](double a, double b) { return a + b; };
+        double first = art::parallel::parallel_reduce(values.begin(), values.end(), 0.0, plus, opts);
+        bool same = true;
+        for (int run = 0; run < 5; ++run) {
+            same = same && art::parallel::parallel_reduce(values.begin(), values.end(), 0.0, plus, opts) == first;
+        }
+        REQUIRE(same);
+    }
+
+    SECTION("exceptions reach the caller") {
+        opts.grain = 100;
+        REQUIRE_THROWS_AS(art::parallel::parallel_for_each(art_vec.begin(), art_vec.end(), [](long long value) {
+            if (value == 54321) throw std::runtime_error("bad element");
+        }, opts), std::runtime_error);
+    }
+}
+
+TEST_CASE("Parallel sort") {
+    art::thread_pool pool(3);
+    art::parallel::options opts;
+    opts.pool = &pool;
+
+    SECTION("sample sort matches std::sort") {
+        std::vector<unsigned> std_vec;
+        art::vector<unsigned> art_vec;
+        unsigned state = 12345;
+        for (int i = 0; i < 200000; ++i) {
+            state = state * 1103515245u + 12345u;
+            std_vec.push_back(state >> 8);
+            art_vec.emplace_back(state >> 8);
+        }
+        std::sort(std_vec.begin(), std_vec.end());
+        art::parallel_sort(art_vec, std::less<unsigned>(), opts);
+        REQUIRE(art_vec == std_vec);
+
+        art::parallel_sort(art_vec, std::greater<unsigned>(), opts);
+        REQUIRE(std::is_sorted(art_vec.begin(), art_vec.end(), std::greater<unsigned>()));
+    }
+
+    SECTION("stable sort keeps equal keys in order") {
+        art::vector<std::pair<int, int>> art_vec;
+        for (int i = 0; i < 100000; ++i) art_vec.emplace_back((i * 7919) % 97, i);
+        auto by_key = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+        art::parallel_stable_sort(art_vec, by_key, opts);
+        bool stable = true;
+        for (std::size_t i = 1; i < art_vec.size(); ++i) {
+            stable = stable && (art_vec[i - 1].first < art_vec[i].first ||
+                                (art_vec[i - 1].first == art_vec[i].first && art_vec[i - 1].second < art_vec[i].second));
+        }
+        REQUIRE(stable);
+    }
+
+    SECTION("small and constant inputs") {
+        art::vector<int> small = {3, 1, 2};
+        art::parallel_sort(small);
+        REQUIRE(small == std::vector<int>{1, 2, 3});
+
+        art::vector<std::string> same(50000, std::string("key"));
+        art::parallel_sort(same, std::less<std::string>(), opts);
+        REQUIRE(same.size() == 50000);
+        REQUIRE(same[49999] == "key");
+    }
+
+    SECTION("few distinct keys and move-only elements") {
+        art::vector<std::pair<int, int>> pairs;
+        std::vector<std::pair<int, int>> expected;
+        unsigned state = 777;
+        for (int i = 0; i < 200000; ++i) {
+            state = state * 1103515245u + 12345u;
+            //half the input is one key, the rest spread over a handful
+            int key = (state >> 16) % 2 ? 3 : int((state >> 8) % 6);
+            pairs.emplace_back(key, i);
+            expected.emplace_back(key, i);
+        }
+        auto by_key = [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.first < b.first; };
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+        art::parallel_stable_sort(pairs, by_key, opts);
+        REQUIRE(pairs == expected);
+        art::parallel_sort(pairs, std::greater<std::pair<int, int>>(), opts);
+        REQUIRE(std::is_sorted(pairs.begin(), pairs.end(), std::greater<std::pair<int, int>>()));
+
+        art::vector<std::unique_ptr<int>> owned;
+        for (int i = 0; i < 100000; ++i) owned.emplace_back(new int((i * 7919) % 1000));
+        auto by_value = [](const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) { return *a < *b; };
+        art::parallel_sort(owned, by_value, opts);
+        REQUIRE(std::is_sorted(owned.begin(), owned.end(), by_value));
+        REQUIRE(*owned.back() == 999);
+    }
+}
+
+TEST_CASE("Radix sort") {
+
+    SECTION("unsigned 64 bit keys") {
+        std::vector<std::uint64_t> std_vec;
+        art::vector<std::uint64_t> art_vec;
+        std::uint64_t state = 88172645463325252ull;
+        for (int i = 0; i < 10000; ++i) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            std_vec.push_back(state);
+            art_vec.emplace_back(state);
+        }
+        std::sort(std_vec.begin(), std_vec.end());
+        art::radix_sort(art_vec);
+        REQUIRE(art_vec == std_vec);
+    }
+
+    SECTION("signed and floating point keys") {
+        std::vector<int> std_ints;
+        art::vector<int> art_ints;
+        std::vector<double> std_doubles;
+        art::vector<double> art_doubles;
+        for (int i = 0; i < 3000; ++i) {
+            int value = (i * 7919) % 2001 - 1000;
+            std_ints.push_back(value);
+            art_ints.emplace_back(value);
+            std_doubles.push_back(value * 0.25);
+            art_doubles.emplace_back(value * 0.25);
+        }
+        std::sort(std_ints.begin(), std_ints.end());
+        std::sort(std_doubles.begin(), std_doubles.end());
+        art::radix_sort(art_ints);
+        art::radix_sort(art_doubles);
+        REQUIRE(art_ints == std_ints);
+        REQUIRE(art_doubles == std_doubles);
+    }
+
+    SECTION("pairs are sorted stably by key") {
+        art::vector<std::pair<std::uint32_t, int>> art_vec;
+        for (int i = 0; i < 5000; ++i) art_vec.emplace_back(std::uint32_t((i * 31) % 17), i);
+        art::radix_sort(art_vec);
+        bool stable = true;
+        for (std::size_t i = 1; i < art_vec.size(); ++i) {
+            stable = stable && (art_vec[i - 1].first < art_vec[i].first ||
+                                (art_vec[i - 1].first == art_vec[i].first && art_vec[i - 1].second < art_vec[i].second));
+        }
+        REQUIRE(stable);
+    }
+
+    SECTION("small inputs and bytes") {
+        art::vector<unsigned char> bytes = {5, 200, 3, 3, 0};
+        art::radix_sort(bytes);
+        REQUIRE(bytes == std::vector<unsigned char>{0, 3, 3, 5, 200});
+
+        art::vector<std::uint16_t> same(1000, 7);
+        art::radix_sort(same);
+        REQUIRE(same[999] == 7);
+    }
+}
+
+TEST_CASE("Contiguous iterators") {
+
+    SECTION("iterators unwrap to the data pointer") {
+        art::vector<int> art_vec = {1, 2, 3, 4};
+        const art::vector<int>& const_vec = art_vec;
+        REQUIRE(art::to_address(art_vec.begin()) == art_vec.data());
+        REQUIRE(art::to_address(const_vec.end()) == art_vec.data() + 4);
+        art::vector<int>::const_iterator first = art_vec.begin();
+        REQUIRE(first == const_vec.begin());
+        REQUIRE(art_vec.end() - first == 4);
+    }
+
+    SECTION("standard algorithms") {
+        std::vector<int> std_vec = {1, 2, 3, 4, 5};
+        art::vector<int> art_vec(5);
+        std::copy(std_vec.begin(), std_vec.end(), art_vec.begin());
+        REQUIRE(std::equal(art_vec.begin(), art_vec.end(), std_vec.begin()));
+        std::fill(art_vec.begin(), art_vec.end(), 9);
+        REQUIRE(std::count(art_vec.cbegin(), art_vec.cend(), 9) == 5);
+    }
+
+    SECTION("reverse iteration") {
+        art::vector<int> art_vec = {1, 2, 3};
+        std::vector<int> reversed(art_vec.rbegin(), art_vec.rend());
+        REQUIRE(reversed == std::vector<int>{3, 2, 1});
+        const art::vector<int>& const_vec = art_vec;
+        REQUIRE(*const_vec.rbegin() == 3);
+        REQUIRE(const_vec.crend() - const_vec.crbegin() == 3);
+    }
+
+    SECTION("erase range shifts the tail") {
+        std::vector<int> std_vec = {1, 2, 6, 7};
+        art::vector<int> art_vec = {1, 2, 3, 4, 5, 6, 7};
+        auto it = art_vec.erase(art_vec.cbegin() + 2, art_vec.cbegin() + 5);
+        REQUIRE(*it == 6);
+        REQUIRE(art_vec == std_vec);
+    }
+}
+
+TEST_CASE("Concurrent vector") {
+    SECTION("single thread push and access") {
+        art::concurrent_vector<std::string> con_vec;
+        REQUIRE(con_vec.empty());
+        for (int i = 0; i < 1000; ++i) REQUIRE(con_vec.push_back(std::to_string(i)) == std::size_t(i));
+        REQUIRE(con_vec.size() == 1000);
+        REQUIRE(con_vec[999] == "999");
+        REQUIRE(con_vec.at(10) == "10");
+        REQUIRE_THROWS_AS(con_vec.at(1000), std::out_of_range);
+        REQUIRE(con_vec.capacity() >= 1000);
+        art::vector<std::string> art_vec = con_vec.to_vector();
+        REQUIRE(art_vec.size() == 1000);
+        REQUIRE(std::equal(con_vec.begin(), con_vec.end(), art_vec.begin()));
+    }
+
+    SECTION("growth never moves elements") {
+        art::concurrent_vector<int> con_vec;
+        con_vec.push_back(1);
+        const int* first = &con_vec[0];
+        for (int i = 0; i < 100000; ++i) con_vec.emplace_back(i);
+        REQUIRE(&con_vec[0] == first);
+        REQUIRE(*first == 1);
+    }
+
+    SECTION("reserve and clear") {
+        art::concurrent_vector<int> con_vec;
+        con_vec.reserve(100);
+        REQUIRE(con_vec.capacity() >= 100);
+        con_vec.push_back(3);
+        con_vec.clear();
+        REQUIRE(con_vec.empty());
+        REQUIRE(con_vec.capacity() == 0);
+    }
+
+    SECTION("concurrent writers and readers") {
+        struct checked{
+            std::size_t value;
+            std::size_t twice;
+            explicit checked(std::size_t v) : value(v), twice(v * 2) {}
+        };
+        const std::size_t writers = 4, per_writer = 20000;
+        art::concurrent_vector<checked> con_vec;
+        std::atomic<bool> torn(false);
+        std::atomic<std::size_t> done(0);
+        std::thread reader([&] {
+            while (done.load() < writers) {
+                for (const checked& element : con_vec) if (element.twice != element.value * 2) torn = true;
+            }
+        });
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                for (std::size_t i = 0; i < per_writer; ++i) con_vec.emplace_back(w * per_writer + i);
+                ++done;
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        reader.join();
+
+        REQUIRE(!torn);
+        REQUIRE(con_vec.size() == writers * per_writer);
+        std::vector<bool> seen(writers * per_writer);
+        for (const checked& element : con_vec) seen[element.value] = true;
+        REQUIRE(std::count(seen.begin(), seen.end(), true) == std::ptrdiff_t(writers * per_writer));
+    }
+}
+
+TEST_CASE("Sharded vector") {
+    SECTION("threads fill their own shards") {
+        const std::size_t writers = 4, per_writer = 5000;
+        art::sharded_vector<std::size_t> sharded;
+        std::vector<std::thread> threads;
+        for (std::size_t w = 0; w < writers; ++w) {
+            threads.emplace_back([&, w] {
+                for (std::size_t i = 0; i < per_writer; ++i) sharded.push_back(w * per_writer + i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        REQUIRE(sharded.shard_count() == writers);
+        REQUIRE(sharded.size() == writers * per_writer);
+        for (std::size_t s = 0; s < writers; ++s) REQUIRE(sharded.shard(s).size() == per_writer);
+
+        art::vector<std::size_t> merged = sharded.merge();
+        REQUIRE(merged.size() == writers * per_writer);
+        //shards keep their order, each one as written by its thread
+        for (std::size_t s = 0; s < writers; ++s) {
+            REQUIRE(std::equal(sharded.shard(s).begin(), sharded.shard(s).end(), merged.begin() + s * per_writer));
+        }
+        std::sort(merged.begin(), merged.end());
+        for (std::size_t i = 0; i < merged.size(); ++i) REQUIRE(merged[i] == i);
+    }
+
+    SECTION("a failed copy leaves nothing behind") {
+        struct counted{
+            static int& live() {static int count = 0; return count;}
+            static int& copies_left() {static int count = -1; return count;}
+            int value;
+            explicit counted(int v) : value(v) {++live();}
+            counted(const counted& other) : value(other.value) {
+                if (copies_left() == 0) throw std::runtime_error("copy failed");
+                if (copies_left() > 0) --copies_left();
+                ++live();
+            }
+            ~counted() {--live();}
+        };
+        {
+            art::sharded_vector<counted> sharded;
+            for (int i = 0; i < 100; ++i) sharded.emplace_back(i);
+            std::thread([&] { for (int i = 0; i < 100; ++i) sharded.emplace_back(i); }).join();
+            std::thread([&] { for (int i = 0; i < 100; ++i) sharded.emplace_back(i); }).join();
+            REQUIRE(counted::live() == 300);
+            counted::copies_left() = 150;
+            REQUIRE_THROWS_AS(sharded.merge(), std::runtime_error);
+            REQUIRE(counted::live() == 300);
+            counted::copies_left() = -1;
+            REQUIRE(sharded.merge().size() == 300);
+            REQUIRE(counted::live() == 300);
+        }
+        REQUIRE(counted::live() == 0);
+    }
+
+    SECTION("view skips empty shards") {
+        art::sharded_vector<int> sharded;
+        sharded.push_back(1);
+        sharded.push_back(2);
+        std::thread([&] { sharded.local(); }).join();
+        std::thread([&] { sharded.emplace_back(3); }).join();
+        std::thread([&] { sharded.local(); }).join();
+        REQUIRE(sharded.shard_count() == 4);
+
+        auto all = sharded.view();
+        REQUIRE(all.size() == 3);
+        REQUIRE(std::vector<int>(all.begin(), all.end()) == std::vector<int>{1, 2, 3});
+        REQUIRE(all[2] == 3);
+        REQUIRE(*(all.begin() + 2) == 3);
+        REQUIRE(all.end() - all.begin() == 3);
+        all[0] = 10;
+        REQUIRE(sharded.shard(0)[0] == 10);
+
+        const art::sharded_vector<int>& const_sharded = sharded;
+        REQUIRE(std::count(const_sharded.view().begin(), const_sharded.view().end(), 3) == 1);
+    }
+
+    SECTION("for_each and take") {
+        art::sharded_vector<std::string> sharded;
+        for (int i = 0; i < 1000; ++i) sharded.push_back(std::to_string(i));
+        std::thread([&] { for (int i = 1000; i < 2000; ++i) sharded.push_back(std::to_string(i)); }).join();
+
+        sharded.for_each([](std::string& value) { value += "!"; });
+        std::atomic<std::size_t> marked(0);
+        const art::sharded_vector<std::string>& const_sharded = sharded;
+        const_sharded.for_each([&](const std::string& value) { if (value.back() == '!') ++marked; });
+        REQUIRE(marked == 2000);
+
+        art::vector<std::string> taken = sharded.take();
+        REQUIRE(taken.size() == 2000);
+        REQUIRE(taken[0] == "0!");
+        REQUIRE(taken[1999] == "1999!");
+        REQUIRE(sharded.empty());
+        REQUIRE(sharded.shard_count() == 2);
+    }
+
+    SECTION("containers do not share shards") {
+        art::sharded_vector<int> first, second;
+        first.push_back(1);
+        second.push_back(2);
+        REQUIRE(first.merge() == art::vector<int>{1});
+        REQUIRE(second.merge() == art::vector<int>{2});
+    }
+
+    SECTION("a thread forgets destroyed containers") {
+        art::sharded_vector<int> kept;
+        std::size_t slots = 0;
+        std::thread([&] {
+            kept.push_back(0);
+            for (int i = 0; i < 1000; ++i) {
+                art::sharded_vector<int> temporary;
+                temporary.push_back(i);
+                temporary.push_back(i + 1);
+                kept.push_back(i);
+            }
+            slots = art::detail::thread_slots().slots.size();
+        }).join();
+        REQUIRE(slots <= 2);
+        REQUIRE(kept.size() == 1001);
+        REQUIRE(kept.shard_count() == 1);
+    }
+}
+
+//counts the bytes it has outstanding, for containers that rebind their allocator
+template <typename Type>
+struct counting_allocator{
+    typedef Type value_type;
+
+    //art::vector default constructs its allocator before assigning the given one
+    counting_allocator() noexcept : bytes(nullptr) {}
+    explicit counting_allocator(std::ptrdiff_t* bytes) noexcept : bytes(bytes) {}
+    template <typename Other>
+    counting_allocator(const counting_allocator<Other>& other) noexcept : bytes(other.bytes) {}
+
+    Type* allocate(std::size_t count) {
+        *bytes += std::ptrdiff_t(count * sizeof(Type));
+        return std::allocator<Type>().allocate(count);
+    }
+    void deallocate(Type* pointer, std::size_t count) noexcept {
+        *bytes -= std::ptrdiff_t(count * sizeof(Type));
+        std::allocator<Type>().deallocate(pointer, count);
+    }
+    template <typename Other, typename... Args>
+    void construct(Other* pointer, Args&&... args) {::new((void*) pointer) Other(std::forward<Args>(args)...);}
+    template <typename Other>
+    void destroy(Other* pointer) noexcept {pointer->~Other();}
+
+    std::ptrdiff_t* bytes;
+};
+
+template <typename Lhs, typename Rhs>
+bool operator==(const counting_allocator<Lhs>& lhs, const counting_allocator<Rhs>& rhs) noexcept {return lhs.bytes == rhs.bytes;}
+template <typename Lhs, typename Rhs>
+bool operator!=(const counting_allocator<Lhs>& lhs, const counting_allocator<Rhs>& rhs) noexcept {return !(lhs == rhs);}
+
+TEST_CASE("RCU vector") {
+    SECTION("readers keep their snapshot") {
+        art::rcu_vector<int> rcu(art::vector<int>{1, 2, 3});
+        {
+            auto before = rcu.read();
+            rcu.update([](art::vector<int>& values) { values.emplace_back(4); });
+            REQUIRE(before->size() == 3);
+            REQUIRE(rcu.read()->size() == 4);
+            REQUIRE(rcu.retired() == 1);
+        }
+        REQUIRE(rcu.reclaim() == 0);
+        rcu.assign(art::vector<int>{7});
+        REQUIRE(rcu.read().get() == art::vector<int>{7});
+        REQUIRE(rcu.retired() == 0);
+    }
+
+    SECTION("nested guards pin until the outermost one ends") {
+        art::rcu_vector<int> rcu;
+        auto outer = rcu.read();
+        {
+            auto inner = rcu.read();
+            REQUIRE(inner->empty());
+        }
+        rcu.assign(art::vector<int>{1});
+        REQUIRE(rcu.retired() == 1);
+        REQUIRE((*outer).empty());
+        art::rcu_vector<int>::read_guard moved(std::move(outer));
+        REQUIRE(moved->empty());
+    }
+
+    SECTION("concurrent readers and writer") {
+        const std::size_t readers = 3, updates = 2000;
+        art::rcu_vector<std::size_t> rcu(art::vector<std::size_t>(16, 0));
+        std::atomic<bool> done(false), inconsistent(false);
+        std::vector<std::thread> threads;
+        for (std::size_t r = 0; r < readers; ++r) {
+            threads.emplace_back([&] {
+                while (!done) {
+                    auto snapshot = rcu.read();
+                    //every update writes the same value to all elements
+                    for (std::size_t value : *snapshot) if (value != snapshot->front()) inconsistent = true;
+                }
+            });
+        }
+        for (std::size_t u = 1; u <= updates; ++u) {
+            rcu.update([u](art::vector<std::size_t>& values) { std::fill(values.begin(), values.end(), u); });
+        }
+        done = true;
+        for (auto& thread : threads) thread.join();
+
+        REQUIRE(!inconsistent);
+        REQUIRE(rcu.read()->front() == updates);
+        REQUIRE(rcu.reclaim() == 0);
+    }
+
+    SECTION("snapshots come from the allocator") {
+        std::ptrdiff_t bytes = 0;
+        {
+            art::rcu_vector<int, counting_allocator<int>> rcu{counting_allocator<int>(&bytes)};
+            std::ptrdiff_t empty = bytes;
+            REQUIRE(empty >= std::ptrdiff_t(sizeof(art::vector<int, counting_allocator<int>>)));
+            auto before = rcu.read();
+            rcu.update([](art::vector<int, counting_allocator<int>>& values) { values.emplace_back(1); });
+            REQUIRE(rcu.retired() == 1);
+            REQUIRE(bytes > empty + std::ptrdiff_t(sizeof(art::vector<int, counting_allocator<int>>)));
+            REQUIRE(before->empty());
+            REQUIRE(rcu.read()->front() == 1);
+        }
+        REQUIRE(bytes == 0);
+    }
+}
+
+TEST_CASE("Copy on write vector") {
+    SECTION("copies share until mutated") {
+        art::cow_vector<int> original = {1, 2, 3};
+        art::cow_vector<int> copy = original;
+        const art::cow_vector<int>& const_copy = copy;
+        REQUIRE(original.use_count() == 2);
+        REQUIRE(const_copy.data() == static_cast<const art::cow_vector<int>&>(original).data());
+        REQUIRE(const_copy[1] == 2);
+        REQUIRE(copy.use_count() == 2);
+
+        copy.push_back(4);
+        REQUIRE(original.unique());
+        REQUIRE(copy.unique());
+        REQUIRE(original.size() == 3);
+        REQUIRE(copy.size() == 4);
+
+        art::cow_vector<int> third = original;
+        third[0] = 10;
+        REQUIRE(original[0] == 1);
+        REQUIRE(third.get() == art::vector<int>{10, 2, 3});
+    }
+
+    SECTION("unique vectors mutate in place") {
+        art::cow_vector<std::string> strings(art::vector<std::string>{"a", "b"});
+        const std::string* before = static_cast<const art::cow_vector<std::string>&>(strings).data();
+        strings[0] = "c";
+        REQUIRE(strings.data() == before);
+        REQUIRE(strings.front() == "c");
+    }
+
+    SECTION("references taken while unique do not leak into copies") {
+        art::cow_vector<int> original = {1, 2, 3};
+        int& first = original[0];
+        art::cow_vector<int>::iterator last = original.end() - 1;
+        art::cow_vector<int> copy = original;
+        REQUIRE(original.unique());
+        REQUIRE(copy.unique());
+        first = 10;
+        *last = 30;
+        REQUIRE(original.get() == art::vector<int>{10, 2, 30});
+        REQUIRE(copy.get() == art::vector<int>{1, 2, 3});
+
+        copy.push_back(4);
+        art::cow_vector<int> assigned;
+        assigned = copy;
+        REQUIRE(assigned.use_count() == 2);
+    }
+
+    SECTION("positions survive the clone") {
+        art::cow_vector<int> original = {1, 2, 3, 4};
+        art::cow_vector<int> copy = original;
+        copy.erase(copy.cbegin() + 1, copy.cbegin() + 3);
+        REQUIRE(copy.get() == art::vector<int>{1, 4});
+        copy.insert(copy.cbegin() + 1, 7);
+        REQUIRE(copy.get() == art::vector<int>{1, 7, 4});
+        REQUIRE(original.get() == art::vector<int>{1, 2, 3, 4});
+        REQUIRE(copy != original);
+    }
+
+    SECTION("moved-from and cleared vectors are empty") {
+        art::cow_vector<int> original(3, 5);
+        art::cow_vector<int> moved(std::move(original));
+        REQUIRE(original.empty());
+        REQUIRE(original.use_count() == 0);
+        REQUIRE(moved.size() == 3);
+        original.emplace_back(1);
+        REQUIRE(original.size() == 1);
+        art::cow_vector<int> copy = moved;
+        moved.clear();
+        REQUIRE(moved.empty());
+        REQUIRE(copy.unique());
+        REQUIRE(copy == art::cow_vector<int>(3, 5));
+    }
+
+    SECTION("local reference count") {
+        typedef art::cow_vector<int, std::allocator<int>, art::local_refcount> local_vector;
+        local_vector original = {1, 2};
+        local_vector copy(original);
+        REQUIRE(copy.use_count() == 2);
+        copy.back() = 3;
+        REQUIRE(original.unique());
+        REQUIRE(original[1] == 2);
+        REQUIRE(copy[1] == 3);
+    }
+
+    SECTION("copies released on other threads") {
+        art::cow_vector<std::string> shared(art::vector<std::string>(100, "x"));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([copy = shared]() mutable {
+                for (int i = 0; i < 100; ++i) {
+                    art::cow_vector<std::string> local = copy;
+                    local.push_back("y");
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        REQUIRE(shared.unique());
+    }
+}
+
+TEST_CASE("Persistent vector") {
+    SECTION("push_back and set keep old versions") {
+        art::persistent_vector<int> empty;
+        art::persistent_vector<int> current = empty;
+        art::persistent_vector<int> at_thousand;
+        for (int i = 0; i < 5000; ++i) {
+            if (i == 1000) at_thousand = current;
+            current = current.push_back(i);
+        }
+        REQUIRE(empty.empty());
+        REQUIRE(current.size() == 5000);
+        REQUIRE(at_thousand.size() == 1000);
+        REQUIRE(at_thousand.back() == 999);
+        for (int i = 0; i < 5000; ++i) REQUIRE(current[i] == i);
+
+        art::persistent_vector<int> changed = current.set(4321, -1);
+        REQUIRE(changed[4321] == -1);
+        REQUIRE(current[4321] == 4321);
+        REQUIRE(changed.pop_back().size() == 4999);
+        REQUIRE_THROWS_AS(current.at(5000), std::out_of_range);
+        REQUIRE_THROWS_AS(current.set(5000, 0), std::out_of_range);
+    }
+
+    SECTION("conversion from and to art::vector") {
+        art::vector<std::string> values;
+        for (int i = 0; i < 40000; ++i) values.emplace_back(std::to_string(i));
+        art::persistent_vector<std::string> tree(values);
+        REQUIRE(tree.size() == values.size());
+        REQUIRE(std::equal(tree.begin(), tree.end(), values.begin()));
+        REQUIRE(tree.to_vector() == values);
+        art::persistent_vector<int> small = {1, 2, 3};
+        REQUIRE(small.end() - small.begin() == 3);
+        REQUIRE(*(small.begin() + 2) == 3);
+    }
+
+    SECTION("slice and concat match std::vector") {
+        std::vector<int> model;
+        art::persistent_vector<int> tree;
+        std::uint64_t state = 12345;
+        auto next = [&state](std::uint64_t bound) {
+            state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+            return std::size_t(state % bound);
+        };
+        for (int round = 0; round < 200; ++round) {
+            std::size_t size = next(round % 10 == 0 ? 3000 : 70);
+            art::vector<int> piece_values;
+            for (std::size_t i = 0; i < size; ++i) piece_values.emplace_back(int(round * 10000 + i));
+            art::persistent_vector<int> piece(piece_values);
+            if (next(2)) {
+                tree = tree.concat(piece);
+                model.insert(model.end(), piece_values.begin(), piece_values.end());
+            } else {
+                tree = piece.concat(tree);
+                model.insert(model.begin(), piece_values.begin(), piece_values.end());
+            }
+            if (round % 7 == 3 && !model.empty()) {
+                std::size_t from = next(model.size()), to = from + next(model.size() - from + 1);
+                tree = tree.slice(from, to);
+                model = std::vector<int>(model.begin() + from, model.begin() + to);
+            }
+            if (!model.empty()) {
+                std::size_t pos = next(model.size());
+                tree = tree.set(pos, -round);
+                model[pos] = -round;
+            }
+            tree = tree.push_back(round);
+            model.push_back(round);
+            REQUIRE(tree.size() == model.size());
+        }
+        REQUIRE(std::equal(tree.begin(), tree.end(), model.begin()));
+        for (std::size_t i = 0; i < model.size(); i += 97) REQUIRE(tree[i] == model[i]);
+        art::vector<int> flat = tree.to_vector();
+        REQUIRE(std::equal(flat.begin(), flat.end(), model.begin()));
+    }
+
+    SECTION("transient builds in place") {
+        art::persistent_vector<int> base = {1, 2, 3};
+        auto builder = base.transient();
+        for (int i = 0; i < 3000; ++i) builder.push_back(i);
+        builder.set(0, 100);
+        art::persistent_vector<int> built = builder.persistent();
+        builder.set(1, 200);
+        builder.push_back(7);
+
+        REQUIRE(base.size() == 3);
+        REQUIRE(base[0] == 1);
+        REQUIRE(built.size() == 3003);
+        REQUIRE(built[0] == 100);
+        REQUIRE(built[1] == 2);
+        REQUIRE(built.back() == 2999);
+        REQUIRE(builder.size() == 3004);
+        REQUIRE(builder[1] == 200);
+        REQUIRE(builder.persistent() != built);
+    }
+
+    SECTION("copied transients edit independently") {
+        art::persistent_vector<int> base = {1, 2, 3};
+        auto original = base.transient();
+        for (int i = 0; i < 100; ++i) original.push_back(i);
+        auto copy = original;
+        copy.set(0, 42);
+        original.set(1, 7);
+        copy.push_back(-1);
+
+        REQUIRE(original.size() == 103);
+        REQUIRE(original[0] == 1);
+        REQUIRE(original[1] == 7);
+        REQUIRE(copy.size() == 104);
+        REQUIRE(copy[0] == 42);
+        REQUIRE(copy[1] == 2);
+        REQUIRE(original.persistent()[0] == 1);
+
+        copy = original;
+        copy.set(2, 9);
+        REQUIRE(original[2] == 3);
+        REQUIRE(copy[2] == 9);
+        REQUIRE(base.size() == 3);
+    }
+}
+
+TEST_CASE("Segmented vector") {
+    SECTION("push_back never moves elements") {
+        art::segmented_vector<std::string, 8> seg_vec;
+        seg_vec.push_back("first");
+        const std::string* first = &seg_vec[0];
+        auto it = seg_vec.begin();
+        for (int i = 0; i < 1000; ++i) seg_vec.emplace_back(std::to_string(i));
+        REQUIRE(&seg_vec[0] == first);
+        REQUIRE(*it == "first");
+        REQUIRE(seg_vec.size() == 1001);
+        REQUIRE(seg_vec.chunk_count() == 126);
+        REQUIRE(seg_vec.capacity() == 1008);
+        REQUIRE(seg_vec.back() == "999");
+        REQUIRE(seg_vec.at(500) == "499");
+        REQUIRE_THROWS_AS(seg_vec.at(1001), std::out_of_range);
+    }
+
+    SECTION("non movable elements") {
+        struct pinned{
+            int value;
+            explicit pinned(int v) : value(v) {}
+            pinned(const pinned&) = delete;
+            pinned(pinned&&) = delete;
+        };
+        art::segmented_vector<pinned, 4> seg_vec;
+        for (int i = 0; i < 10; ++i) seg_vec.emplace_back(i);
+        int sum = 0;
+        for (const pinned& element : seg_vec) sum += element.value;
+        REQUIRE(sum == 45);
+        seg_vec.pop_back();
+        REQUIRE(seg_vec.size() == 9);
+    }
+
+    SECTION("vector operations match std::vector") {
+        std::vector<int> std_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        art::segmented_vector<int, 4> seg_vec = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+        REQUIRE(std::equal(seg_vec.begin(), seg_vec.end(), std_vec.begin()));
+
+        seg_vec.insert(seg_vec.cbegin() + 3, 42);
+        std_vec.insert(std_vec.begin() + 3, 42);
+        seg_vec.erase(seg_vec.cbegin() + 6, seg_vec.cbegin() + 9);
+        std_vec.erase(std_vec.begin() + 6, std_vec.begin() + 9);
+        REQUIRE(seg_vec.size() == std_vec.size());
+        REQUIRE(std::equal(seg_vec.begin(), seg_vec.end(), std_vec.begin()));
+        REQUIRE(std::vector<int>(seg_vec.rbegin(), seg_vec.rend()) == std::vector<int>(std_vec.rbegin(), std_vec.rend()));
+
+        seg_vec.resize(20, 7);
+        std_vec.resize(20, 7);
+        REQUIRE(std::equal(seg_vec.begin(), seg_vec.end(), std_vec.begin()));
+        seg_vec.resize(3);
+        seg_vec.shrink_to_fit();
+        REQUIRE(seg_vec.chunk_count() == 1);
+
+        art::segmented_vector<int, 4> copy(seg_vec);
+        REQUIRE(copy == seg_vec);
+        copy.push_back(0);
+        REQUIRE(seg_vec < copy);
+        art::segmented_vector<int, 4> moved(std::move(copy));
+        REQUIRE(moved.size() == 4);
+        REQUIRE(copy.empty());
+        seg_vec = moved;
+        REQUIRE(seg_vec == moved);
+        seg_vec.clear();
+        REQUIRE(seg_vec.empty());
+        REQUIRE(seg_vec.capacity() > 0);
+    }
+
+    SECTION("default chunk is a page") {
+        REQUIRE(art::segmented_vector<std::uint32_t>::CHUNK_SIZE == 1024);
+        REQUIRE(art::segmented_vector<char[3000]>::CHUNK_SIZE == 1);
+    }
+}
+
+TEST_CASE("Tiered vector") {
+    SECTION("middle inserts and erases match std::vector") {
+        std::vector<int> std_vec;
+        art::tiered_vector<int> tier_vec;
+        std::uint32_t seed = 12345;
+        for (int i = 0; i < 20000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            std::size_t pos = std_vec.empty() ? 0 : seed % (std_vec.size() + 1);
+            if (i % 3 == 2 && !std_vec.empty()) {
+                pos = seed % std_vec.size();
+                std_vec.erase(std_vec.begin() + pos);
+                tier_vec.erase(tier_vec.cbegin() + pos);
+            } else {
+                std_vec.insert(std_vec.begin() + pos, i);
+                tier_vec.insert(tier_vec.cbegin() + pos, i);
+            }
+        }
+        REQUIRE(tier_vec.size() == std_vec.size());
+        REQUIRE(std::equal(tier_vec.begin(), tier_vec.end(), std_vec.begin()));
+        REQUIRE(tier_vec.block_size() == 64);
+
+        tier_vec.erase(tier_vec.cbegin() + 10, tier_vec.cend() - 10);
+        std_vec.erase(std_vec.begin() + 10, std_vec.end() - 10);
+        REQUIRE(std::equal(tier_vec.begin(), tier_vec.end(), std_vec.begin()));
+        REQUIRE(tier_vec.block_size() == art::tiered_vector<int>::MIN_BLOCK_SIZE);
+    }
+
+    SECTION("standard algorithms") {
+        art::tiered_vector<int> tier_vec;
+        for (int i = 0; i < 1000; ++i) tier_vec.insert(tier_vec.cbegin(), i);
+        REQUIRE(tier_vec.front() == 999);
+        REQUIRE(std::is_sorted(tier_vec.rbegin(), tier_vec.rend()));
+        std::sort(tier_vec.begin(), tier_vec.end());
+        REQUIRE(std::is_sorted(tier_vec.begin(), tier_vec.end()));
+        REQUIRE(*std::lower_bound(tier_vec.cbegin(), tier_vec.cend(), 500) == 500);
+        REQUIRE(std::accumulate(tier_vec.begin(), tier_vec.end(), 0) == 499500);
+    }
+
+    SECTION("non trivial elements") {
+        art::tiered_vector<std::string> tier_vec(40, "x");
+        tier_vec.insert(tier_vec.cbegin() + 20, std::string(100, 'y'));
+        tier_vec.emplace(tier_vec.cbegin(), 3, 'z');
+        REQUIRE(tier_vec.size() == 42);
+        REQUIRE(tier_vec[0] == "zzz");
+        REQUIRE(tier_vec.at(21) == std::string(100, 'y'));
+        REQUIRE_THROWS_AS(tier_vec.at(42), std::out_of_range);
+
+        art::tiered_vector<std::string> copy(tier_vec);
+        REQUIRE(copy == tier_vec);
+        copy.erase(copy.cbegin());
+        REQUIRE(copy != tier_vec);
+        art::tiered_vector<std::string> moved(std::move(copy));
+        REQUIRE(moved.size() == 41);
+        REQUIRE(copy.empty());
+        tier_vec = moved;
+        REQUIRE(tier_vec == moved);
+        tier_vec.resize(5);
+        REQUIRE(tier_vec.back() == "x");
+        tier_vec.clear();
+        REQUIRE(tier_vec.empty());
+    }
+}
+
+TEST_CASE("Gap vector") {
+    SECTION("edits around a cursor match std::vector") {
+        std::vector<std::string> std_vec;
+        art::gap_vector<std::string> gap_vec;
+        std::size_t cursor = 0;
+        std::uint32_t seed = 777;
+        for (int i = 0; i < 5000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            if (seed % 10 == 0) cursor = std_vec.empty() ? 0 : seed % (std_vec.size() + 1);
+            if (seed % 4 == 1 && cursor > 0) {
+                --cursor;
+                std_vec.erase(std_vec.begin() + cursor);
+                gap_vec.erase(gap_vec.cbegin() + cursor);
+            } else {
+                std_vec.insert(std_vec.begin() + cursor, std::to_string(i));
+                gap_vec.insert(gap_vec.cbegin() + cursor, std::to_string(i));
+                ++cursor;
+            }
+            REQUIRE(gap_vec.gap_position() == cursor);
+        }
+        REQUIRE(gap_vec.size() == std_vec.size());
+        REQUIRE(std::equal(gap_vec.begin(), gap_vec.end(), std_vec.begin()));
+        REQUIRE(std::vector<std::string>(gap_vec.rbegin(), gap_vec.rend()) == std::vector<std::string>(std_vec.rbegin(), std_vec.rend()));
+
+        gap_vec.erase(gap_vec.cbegin() + 5, gap_vec.cbegin() + 50);
+        std_vec.erase(std_vec.begin() + 5, std_vec.begin() + 50);
+        gap_vec.insert(gap_vec.cbegin() + 2, 3, "abc");
+        std_vec.insert(std_vec.begin() + 2, 3, "abc");
+        REQUIRE(std::equal(gap_vec.begin(), gap_vec.end(), std_vec.begin()));
+    }
+
+    SECTION("compact gives contiguous data") {
+        art::gap_vector<int> gap_vec = {1, 2, 3, 7, 8, 9};
+        REQUIRE(gap_vec.is_compact());
+        gap_vec.insert(gap_vec.cbegin() + 3, 4);
+        gap_vec.insert(gap_vec.cbegin() + 4, 5);
+        gap_vec.emplace(gap_vec.cbegin() + 5, 6);
+        REQUIRE_FALSE(gap_vec.is_compact());
+        REQUIRE(gap_vec.gap_position() == 6);
+        int* data = gap_vec.compact();
+        REQUIRE(gap_vec.is_compact());
+        REQUIRE(data == gap_vec.data());
+        for (int i = 0; i < 9; ++i) REQUIRE(data[i] == i + 1);
+        std::sort(gap_vec.begin(), gap_vec.end(), std::greater<int>());
+        REQUIRE(gap_vec.front() == 9);
+        REQUIRE(gap_vec.at(8) == 1);
+        REQUIRE_THROWS_AS(gap_vec.at(9), std::out_of_range);
+    }
+
+    SECTION("copy, move and resize") {
+        art::gap_vector<std::string> gap_vec(4, "x");
+        gap_vec.insert(gap_vec.cbegin() + 1, "y");
+        art::gap_vector<std::string> copy(gap_vec);
+        REQUIRE(copy == gap_vec);
+        copy.push_back("z");
+        REQUIRE(gap_vec < copy);
+        art::gap_vector<std::string> moved(std::move(copy));
+        REQUIRE(moved.size() == 6);
+        REQUIRE(copy.empty());
+        gap_vec = moved;
+        REQUIRE(gap_vec == moved);
+        gap_vec.resize(2);
+        REQUIRE(gap_vec.back() == "y");
+        gap_vec.resize(4, "w");
+        REQUIRE(gap_vec.back() == "w");
+        gap_vec.shrink_to_fit();
+        REQUIRE(gap_vec.capacity() == 4);
+        gap_vec.pop_back();
+        gap_vec.clear();
+        REQUIRE(gap_vec.empty());
+    }
+}
+
+TEST_CASE("Structure of arrays vector") {
+    typedef art::soa_vector<double, char, std::string, std::int64_t> records;
+
+    SECTION("rows and columns") {
+        records soa_vec;
+        for (int i = 0; i < 100; ++i) soa_vec.emplace_back(i * 0.5, char('a' + i % 26), std::to_string(i), std::int64_t(i) * 1000);
+        REQUIRE(soa_vec.size() == 100);
+        REQUIRE(std::get<2>(soa_vec[42]) == "42");
+        REQUIRE(std::get<3>(soa_vec.back()) == 99000);
+        std::get<0>(soa_vec[1]) = 7.0;
+        REQUIRE(soa_vec.column<0>()[1] == 7.0);
+
+        art::span<double> prices = soa_vec.column<0>();
+        REQUIRE(prices.size() == 100);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(prices.data()) % records::COLUMN_ALIGNMENT == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(soa_vec.column<1>().data()) % records::COLUMN_ALIGNMENT == 0);
+        REQUIRE(reinterpret_cast<std::uintptr_t>(soa_vec.column<3>().data()) % records::COLUMN_ALIGNMENT == 0);
+        double sum = 0;
+        for (double price : prices) sum += price;
+        REQUIRE(sum == Approx(99 * 100 / 4.0 + 6.5));
+
+        int count = 0;
+        for (auto row : soa_vec) {
+            if (std::get<1>(row) == 'a') ++count;
+        }
+        REQUIRE(count == 4);
+        REQUIRE_THROWS_AS(soa_vec.at(100), std::out_of_range);
+    }
+
+    SECTION("modifiers keep columns in step") {
+        records soa_vec = {records::value_type(1.0, 'x', "one", 1), records::value_type(3.0, 'z', "three", 3)};
+        soa_vec.insert(soa_vec.cbegin() + 1, records::value_type(2.0, 'y', "two", 2));
+        REQUIRE(std::get<2>(soa_vec[1]) == "two");
+        REQUIRE(std::get<1>(soa_vec[2]) == 'z');
+        soa_vec.erase(soa_vec.cbegin());
+        REQUIRE(soa_vec.front() == std::make_tuple(2.0, 'y', std::string("two"), std::int64_t(2)));
+
+        records copy(soa_vec);
+        REQUIRE(copy == soa_vec);
+        soa_vec.resize(10);
+        REQUIRE(std::get<2>(soa_vec[9]).empty());
+        REQUIRE(copy != soa_vec);
+        soa_vec.resize(1);
+        soa_vec.shrink_to_fit();
+        REQUIRE(soa_vec.capacity() == 1);
+        records moved(std::move(copy));
+        REQUIRE(moved.size() == 2);
+        REQUIRE(copy.empty());
+        soa_vec = moved;
+        REQUIRE(soa_vec == moved);
+        soa_vec.pop_back();
+        REQUIRE(std::get<2>(soa_vec.back()) == "two");
+        soa_vec.clear();
+        REQUIRE(soa_vec.empty());
+    }
+
+    SECTION("columns come from the given allocator") {
+        std::ptrdiff_t bytes = 0;
+        typedef art::basic_soa_vector<counting_allocator<int>, double, std::int64_t> counted;
+        {
+            counted soa_vec(100, counting_allocator<int>(&bytes));
+            REQUIRE(bytes >= std::ptrdiff_t(100 * (sizeof(double) + sizeof(std::int64_t))));
+            REQUIRE(soa_vec.get_allocator().bytes == &bytes);
+            counted copy(soa_vec);
+            counted moved(std::move(copy));
+            moved.emplace_back(1.0, 2);
+            REQUIRE(moved.get_allocator() == soa_vec.get_allocator());
+        }
+        REQUIRE(bytes == 0);
+    }
+}
+
+TEST_CASE("Bit vector") {
+    SECTION("packed flags match std::vector<bool>") {
+        std::vector<bool> std_bits;
+        art::bit_vector bits;
+        std::uint32_t seed = 99;
+        for (int i = 0; i < 1000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            bool value = (seed >> 16) % 3 == 0;
+            std_bits.push_back(value);
+            bits.push_back(value);
+        }
+        REQUIRE(bits.size() == 1000);
+        REQUIRE(bits.words().size() == 16);
+        REQUIRE(std::equal(bits.begin(), bits.end(), std_bits.begin()));
+        REQUIRE(bits.count() == std::size_t(std::count(std_bits.begin(), std_bits.end(), true)));
+
+        std::vector<std::size_t> expected, found;
+        for (std::size_t i = 0; i < std_bits.size(); ++i) if (std_bits[i]) expected.push_back(i);
+        for (std::size_t i = bits.find_first(); i != art::bit_vector::npos; i = bits.find_next(i)) found.push_back(i);
+        REQUIRE(found == expected);
+
+        bits[3] = true;
+        bits[4] = bits[3];
+        bits[3].flip();
+        REQUIRE_FALSE(bits[3]);
+        REQUIRE(bits.test(4));
+        bits.set(999).reset(4).flip(0);
+        REQUIRE(bits.back());
+        REQUIRE(bits[0] != std_bits[0]);
+        REQUIRE_THROWS_AS(bits.set(1000), std::out_of_range);
+    }
+
+    SECTION("word-wise operations") {
+        art::bit_vector a(130), b(130, true);
+        REQUIRE(a.none());
+        REQUIRE(b.all());
+        REQUIRE(b.count() == 130);
+        REQUIRE(b.words()[2] == 3);
+        for (std::size_t i = 0; i < 130; i += 2) a[i] = true;
+        REQUIRE((a & b) == a);
+        REQUIRE((a | b) == b);
+        REQUIRE((a ^ b).count() == 65);
+        REQUIRE((~a) == (a ^ b));
+        REQUIRE((~b).none());
+        art::bit_vector c(b);
+        c.subtract(a);
+        REQUIRE(c.find_first() == 1);
+        REQUIRE(c.find_next(127) == 129);
+        REQUIRE(c.find_next(129) == art::bit_vector::npos);
+        REQUIRE_THROWS_AS(a &= art::bit_vector(129), std::invalid_argument);
+
+        b.resize(70);
+        REQUIRE(b.count() == 70);
+        b.resize(200, true);
+        REQUIRE(b.all());
+        b.resize(300);
+        REQUIRE(b.count() == 200);
+        b.pop_back();
+        REQUIRE(b.size() == 299);
+        b.reset();
+        REQUIRE(b.none());
+        b.set();
+        REQUIRE(b.count() == 299);
+        b.clear();
+        REQUIRE(b.empty());
+    }
+
+    SECTION("rank and select") {
+        art::bit_vector bits(5000);
+        std::vector<std::size_t> ones;
+        for (std::size_t i = 0; i < bits.size(); i += (i % 7) + 1) {
+            bits[i] = true;
+            ones.push_back(i);
+        }
+        art::bit_rank_select index(bits);
+        REQUIRE(index.ones() == ones.size());
+        for (std::size_t k = 0; k < ones.size(); ++k) {
+            REQUIRE(index.select(k) == ones[k]);
+            REQUIRE(index.rank(ones[k]) == k);
+            REQUIRE(index.rank(ones[k] + 1) == k + 1);
+        }
+        REQUIRE(index.rank(bits.size()) == ones.size());
+        REQUIRE(index.select(ones.size()) == art::bit_rank_select::npos);
+        REQUIRE(art::bit_rank_select(art::bit_vector()).rank(0) == 0);
+    }
+}
+
+TEST_CASE("Packed integer vector") {
+    SECTION("blocks of every width round trip") {
+        art::vector<std::uint64_t> values;
+        std::uint64_t seed = 42;
+        for (unsigned width = 0; width <= 64; ++width) {
+            std::uint64_t base = width == 64 ? 0 : seed % 1000000;
+            for (std::size_t i = 0; i < art::packed_int_vector::BLOCK_SIZE; ++i) {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                std::uint64_t offset = width == 0 ? 0 : width == 64 ? seed : seed >> (64 - width);
+                values.emplace_back(base + offset);
+            }
+        }
+        for (std::uint64_t i = 0; i < 50; ++i) values.emplace_back(i * i);
+
+        art::packed_int_vector packed(values);
+        REQUIRE(packed.size() == values.size());
+        REQUIRE(packed.block_count() == 65);
+        REQUIRE(packed.block_width(0) == 0);
+        REQUIRE(packed.block_width(64) == 64);
+        REQUIRE(packed.block_width(20) <= 20);
+        for (std::size_t i = 0; i < values.size(); ++i) REQUIRE(packed[i] == values[i]);
+        REQUIRE(packed.to_vector() == values);
+
+        std::size_t index = 0;
+        bool same = true;
+        packed.for_each([&](std::uint64_t value) { same = same && value == values[index++]; });
+        REQUIRE(same);
+        REQUIRE(index == values.size());
+        REQUIRE(std::equal(packed.begin(), packed.end(), values.begin()));
+        REQUIRE_THROWS_AS(packed.at(values.size()), std::out_of_range);
+    }
+
+    SECTION("push_back and pop_back across block boundaries") {
+        art::packed_int_vector packed;
+        std::vector<std::uint64_t> expected;
+        for (std::uint64_t i = 0; i < 1000; ++i) {
+            packed.push_back(1000000 + i % 300);
+            expected.push_back(1000000 + i % 300);
+        }
+        REQUIRE(packed.block_count() == 7);
+        REQUIRE(packed.block_width(0) == 7);
+        REQUIRE(packed.block_width(2) == 9);
+        REQUIRE(packed.memory_bytes() < expected.size() * sizeof(std::uint64_t) / 4);
+        for (int i = 0; i < 130; ++i) {
+            packed.pop_back();
+            expected.pop_back();
+        }
+        REQUIRE(packed.block_count() == 6);
+        REQUIRE(packed.back() == expected.back());
+        REQUIRE(std::equal(packed.begin(), packed.end(), expected.begin()));
+
+        art::packed_int_vector copy(packed);
+        REQUIRE(copy == packed);
+        copy.push_back(5);
+        REQUIRE(copy != packed);
+        copy.clear();
+        REQUIRE(copy.empty());
+        REQUIRE(art::packed_int_vector{3, 1, 4}.front() == 3);
+    }
+}
+
+TEST_CASE("Delta vector") {
+    std::vector<std::uint32_t> sorted;
+    std::uint32_t value = 5, seed = 31;
+    for (int i = 0; i < 3001; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        std::uint32_t gap = seed >> 24;
+        if (i % 500 == 0) gap = 1u << 26;
+        if (i % 7 == 0) gap = 0;
+        value += gap;
+        sorted.push_back(value);
+    }
+
+    SECTION("encodes, iterates and seeks") {
+        art::delta_vector deltas(sorted.begin(), sorted.end());
+        REQUIRE(deltas.size() == sorted.size());
+        REQUIRE(std::equal(deltas.begin(), deltas.end(), sorted.begin()));
+        REQUIRE(deltas.front() == sorted.front());
+        REQUIRE(deltas.back() == sorted.back());
+        REQUIRE(deltas.at(1234) == sorted[1234]);
+        REQUIRE_THROWS_AS(deltas.at(sorted.size()), std::out_of_range);
+        REQUIRE(deltas.memory_bytes() < sorted.size() * sizeof(std::uint32_t) / 2);
+
+        for (std::uint32_t probe = 0; probe < sorted.back() + 10; probe += 9973) {
+            auto it = deltas.lower_bound(probe);
+            std::size_t expected = std::size_t(std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin());
+            REQUIRE(it.index() == expected);
+            if (expected < sorted.size()) REQUIRE(*it == sorted[expected]);
+            REQUIRE(deltas.contains(probe) == std::binary_search(sorted.begin(), sorted.end(), probe));
+        }
+        REQUIRE(deltas.contains(sorted[2999]));
+        REQUIRE(deltas.lower_bound(sorted.back() + 1) == deltas.end());
+
+        auto it = deltas.begin();
+        it.seek(sorted[700]).seek(sorted[650]);
+        REQUIRE(*it == sorted[700]);
+
+        art::delta_vector copy(deltas.to_vector());
+        REQUIRE(copy == deltas);
+        REQUIRE_THROWS_AS(copy.push_back(0), std::invalid_argument);
+        copy.clear();
+        REQUIRE(copy.empty());
+        copy.push_back(1);
+        REQUIRE(copy != deltas);
+        REQUIRE(std::vector<std::uint32_t>(copy.begin(), copy.end()) == std::vector<std::uint32_t>{1});
+    }
+
+    SECTION("intersection and union on the encoded form") {
+        std::vector<std::uint32_t> sparse;
+        for (std::size_t i = 0; i < sorted.size(); i += 97) sparse.push_back(sorted[i] + (i % 2));
+        art::delta_vector a(sorted.begin(), sorted.end());
+        art::delta_vector b(sparse.begin(), sparse.end());
+
+        std::vector<std::uint32_t> expected;
+        std::set_intersection(sorted.begin(), sorted.end(), sparse.begin(), sparse.end(), std::back_inserter(expected));
+        art::delta_vector both = art::set_intersection(a, b);
+        REQUIRE(std::vector<std::uint32_t>(both.begin(), both.end()) == expected);
+        REQUIRE(art::set_intersection(b, a) == both);
+
+        expected.clear();
+        std::set_union(sorted.begin(), sorted.end(), sparse.begin(), sparse.end(), std::back_inserter(expected));
+        art::delta_vector either = art::set_union(a, b);
+        REQUIRE(std::vector<std::uint32_t>(either.begin(), either.end()) == expected);
+        REQUIRE(art::set_union(a, art::delta_vector()) == a);
+    }
+
+    SECTION("runs of duplicates across skip entries") {
+        std::vector<std::uint32_t> runs{1};
+        for (std::uint32_t run = 0; run < 6; ++run) runs.insert(runs.end(), 100 + 90 * run, 5 + run);
+        runs.push_back(100);
+        art::delta_vector deltas(runs.begin(), runs.end());
+        for (std::uint32_t probe = 0; probe <= 101; ++probe) {
+            std::size_t expected = std::size_t(std::lower_bound(runs.begin(), runs.end(), probe) - runs.begin());
+            REQUIRE(deltas.lower_bound(probe).index() == expected);
+        }
+        auto it = deltas.begin();
+        ++it;
+        REQUIRE(it.seek(8).index() == std::size_t(std::lower_bound(runs.begin(), runs.end(), 8u) - runs.begin()));
+
+        std::vector<std::uint32_t> fives(300, 5), tens(400, 10);
+        fives.insert(fives.end(), tens.begin(), tens.end());
+        art::delta_vector other(fives.begin(), fives.end());
+        std::vector<std::uint32_t> expected;
+        std::set_intersection(runs.begin(), runs.end(), fives.begin(), fives.end(), std::back_inserter(expected));
+        REQUIRE(expected.size() == 100 + 400);
+        art::delta_vector both = art::set_intersection(deltas, other);
+        REQUIRE(std::vector<std::uint32_t>(both.begin(), both.end()) == expected);
+        REQUIRE(art::set_intersection(other, deltas) == both);
+    }
+}
+
+TEST_CASE("Dictionary vector") {
+    const std::vector<std::string> countries{"de", "fr", "us", "jp", "br"};
+    std::vector<std::string> plain;
+    for (std::size_t i = 0; i < 1000; ++i) plain.push_back(countries[(i * 7 + i / 13) % countries.size()]);
+    art::dict_vector<std::string> dict(plain.begin(), plain.end());
+
+    SECTION("decodes through the dictionary") {
+        REQUIRE(dict.size() == plain.size());
+        REQUIRE(dict.dictionary().size() == countries.size());
+        REQUIRE(dict.code_width() == 1);
+        REQUIRE(std::equal(dict.begin(), dict.end(), plain.begin()));
+        REQUIRE(dict.front() == plain.front());
+        REQUIRE(dict.back() == plain.back());
+        REQUIRE(dict.at(500) == plain[500]);
+        REQUIRE_THROWS_AS(dict.at(plain.size()), std::out_of_range);
+        REQUIRE(dict.dictionary()[dict.code(42)] == plain[42]);
+        REQUIRE(dict.find_code("xx") == art::dict_vector<std::string>::npos);
+        REQUIRE(dict.memory_bytes() < plain.size() * sizeof(std::string) / 8);
+    }
+
+    SECTION("filters and group counts run on the codes") {
+        auto mask = dict.equal_mask("us");
+        REQUIRE(mask.size() == plain.size());
+        REQUIRE(mask.count() == std::size_t(std::count(plain.begin(), plain.end(), "us")));
+        for (std::size_t i = 0; i < plain.size(); ++i) REQUIRE(mask[i] == (plain[i] == "us"));
+        REQUIRE(dict.count("us") == mask.count());
+        REQUIRE(dict.count("xx") == 0);
+        REQUIRE(dict.equal_mask("xx").count() == 0);
+
+        auto european = dict.filter([](const std::string& code) {return code == "de" || code == "fr";});
+        for (std::size_t i = 0; i < plain.size(); ++i) REQUIRE(european[i] == (plain[i] == "de" || plain[i] == "fr"));
+
+        auto counts = dict.group_counts();
+        REQUIRE(counts.size() == countries.size());
+        for (std::size_t code = 0; code < counts.size(); ++code) {
+            REQUIRE(counts[code] == std::size_t(std::count(plain.begin(), plain.end(), dict.dictionary()[code])));
+        }
+    }
+
+    SECTION("codes widen as the dictionary grows") {
+        art::dict_vector<std::uint32_t> ids;
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < 70000; ++i) {
+            std::uint32_t value = i < 1000 ? i % 3 : i;
+            ids.push_back(value);
+            expected.push_back(value);
+            if (i == 200) REQUIRE(ids.code_width() == 1);
+            if (i == 1300) REQUIRE(ids.code_width() == 2);
+        }
+        REQUIRE(ids.code_width() == 4);
+        REQUIRE(std::equal(ids.begin(), ids.end(), expected.begin()));
+        REQUIRE(ids.count(1) == 333);
+
+        ids.set(5, 69999);
+        REQUIRE(ids[5] == 69999);
+        REQUIRE(ids.count(69999) == 2);
+        ids.pop_back();
+        REQUIRE(ids.size() == 69999);
+        REQUIRE(ids.count(69999) == 1);
+        REQUIRE_THROWS_AS(ids.set(ids.size(), 1), std::out_of_range);
+
+        art::dict_vector<std::uint32_t> other{1, 2, 1};
+        REQUIRE(other != ids);
+        other.swap(ids);
+        REQUIRE(ids.size() == 3);
+        ids.clear();
+        REQUIRE(ids.empty());
+        REQUIRE(ids.dictionary().empty());
+        REQUIRE(ids.code_width() == 1);
+    }
+
+    SECTION("a failed copy adds no code") {
+        struct key{
+            static int& copies_left() {static int count = -1; return count;}
+            int value;
+            explicit key(int v) : value(v) {}
+            key(const key& other) : value(other.value) {
+                if (copies_left() == 0) throw std::runtime_error("copy failed");
+                if (copies_left() > 0) --copies_left();
+            }
+            bool operator==(const key& other) const {return value == other.value;}
+        };
+        struct key_hash{
+            std::size_t operator()(const key& k) const {return std::hash<int>()(k.value);}
+        };
+        art::dict_vector<key, key_hash> keys;
+        keys.push_back(key(1));
+        //the dictionary copy fails, then the index copy
+        for (int budget = 0; budget < 2; ++budget) {
+            key::copies_left() = budget;
+            REQUIRE_THROWS_AS(keys.push_back(key(2)), std::runtime_error);
+            REQUIRE(keys.size() == 1);
+            REQUIRE(keys.dictionary().size() == 1);
+            REQUIRE(keys.find_code(key(2)) == art::dict_vector<key, key_hash>::npos);
+        }
+        key::copies_left() = -1;
+        keys.push_back(key(2));
+        keys.push_back(key(2));
+        REQUIRE(keys.dictionary().size() == 2);
+        REQUIRE(keys[2].value == 2);
+        REQUIRE(keys.count(key(2)) == 2);
+    }
+}
+
+TEST_CASE("Run length encoded vector") {
+    art::vector<int> plain;
+    for (int run = 0; run < 300; ++run) {
+        for (int i = 0; i < 1 + run % 70; ++i) plain.emplace_back(run % 5);
+    }
+    art::rle_vector<int> rle(plain);
+
+    SECTION("runs from the vectorized detector") {
+        REQUIRE(rle.size() == plain.size());
+        REQUIRE(rle.run_count() == 300);
+        REQUIRE(rle.to_vector() == plain);
+        REQUIRE(std::equal(rle.begin(), rle.end(), plain.begin()));
+        REQUIRE(art::rle_vector<int>(plain.begin(), plain.end()) == rle);
+        REQUIRE(rle.memory_bytes() < plain.size() * sizeof(int));
+
+        std::size_t expected_first = 0;
+        for (auto run : rle.runs()) {
+            REQUIRE(run.first == expected_first);
+            for (std::size_t i = run.first; i < run.last; ++i) REQUIRE(plain[i] == run.value);
+            expected_first = run.last;
+        }
+        REQUIRE(expected_first == plain.size());
+        REQUIRE(rle.runs().size() == rle.run_count());
+    }
+
+    SECTION("random access and iterators") {
+        for (std::size_t i = 0; i < plain.size(); i += 7) {
+            REQUIRE(rle[i] == plain[i]);
+            REQUIRE(rle.run(rle.run_of(i)).first <= i);
+        }
+        REQUIRE(rle.at(plain.size() - 1) == plain.back());
+        REQUIRE_THROWS_AS(rle.at(plain.size()), std::out_of_range);
+        REQUIRE(rle.front() == plain.front());
+        REQUIRE(rle.back() == plain.back());
+
+        auto it = rle.begin() + 1000;
+        REQUIRE(*it == plain[1000]);
+        REQUIRE(it.run() == rle.run_of(1000));
+        for (std::size_t i = 1000; i > 900; --i, --it) REQUIRE(*it == plain[i]);
+        REQUIRE(it[50] == plain[950]);
+        REQUIRE(rle.end() - it == std::ptrdiff_t(plain.size() - 900));
+        std::vector<int> reversed(plain.rbegin(), plain.rend());
+        REQUIRE(std::equal(reversed.begin(), reversed.end(), std::reverse_iterator<art::rle_vector<int>::const_iterator>(rle.end())));
+    }
+
+    SECTION("appends extend the last run") {
+        art::rle_vector<std::string> names{"a", "a", "b"};
+        REQUIRE(names.run_count() == 2);
+        names.push_back("b");
+        names.append_run("b", 3);
+        REQUIRE(names.run_count() == 2);
+        REQUIRE(names.size() == 7);
+        names.append_run("c", 0);
+        REQUIRE(names.run_count() == 2);
+        names.push_back(std::string("c"));
+        REQUIRE(names.run_count() == 3);
+        REQUIRE(names[6] == "b");
+        REQUIRE(names[7] == "c");
+
+        names.pop_back();
+        REQUIRE(names.run_count() == 2);
+        for (int i = 0; i < 5; ++i) names.pop_back();
+        REQUIRE(names.size() == 2);
+        REQUIRE(names.run_count() == 1);
+        REQUIRE(names != art::rle_vector<std::string>{"a", "b"});
+        REQUIRE(names == art::rle_vector<std::string>{"a", "a"});
+
+        art::rle_vector<std::string> other;
+        other.swap(names);
+        REQUIRE(names.empty());
+        REQUIRE(other.size() == 2);
+        other.clear();
+        REQUIRE(other.empty());
+        REQUIRE(other.run_count() == 0);
+    }
+}
+
+TEST_CASE("Compressed vector") {
+    struct sample{
+        std::uint64_t time;
+        std::int32_t value;
+        std::uint32_t flags;
+    };
+    auto make = [](std::size_t i) {return sample{1000000 + i * 10, std::int32_t(i / 100 % 7) - 3, std::uint32_t(i % 3 == 0)};};
+
+    SECTION("codec round trip") {
+        std::vector<std::uint8_t> inputs[4];
+        for (std::size_t i = 0; i < 5000; ++i) inputs[0].push_back(std::uint8_t(i % 17 < 9 ? 'a' : i % 251));
+        std::uint32_t seed = 1;
+        for (std::size_t i = 0; i < 3000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            inputs[1].push_back(std::uint8_t(seed >> 24));
+        }
+        inputs[2].assign(70000, 7);
+        inputs[3].assign(11, 3);
+        for (auto& input : inputs) {
+            std::vector<std::uint8_t> packed(art::detail::lz_bound(input.size()));
+            std::size_t size = art::detail::lz_compress(input.data(), input.size(), packed.data());
+            REQUIRE(size <= packed.size());
+            std::vector<std::uint8_t> unpacked(input.size());
+            art::detail::lz_decompress(packed.data(), size, unpacked.data(), unpacked.size());
+            REQUIRE(unpacked == input);
+            if (input.size() > 1000) REQUIRE_THROWS_AS(art::detail::lz_decompress(packed.data(), size / 2, unpacked.data(), unpacked.size()), std::runtime_error);
+        }
+        std::vector<std::uint8_t> packed(art::detail::lz_bound(inputs[2].size()));
+        REQUIRE(art::detail::lz_compress(inputs[2].data(), inputs[2].size(), packed.data()) < inputs[2].size() / 100);
+    }
+
+    SECTION("cold chunks read back through the cache") {
+        art::compressed_vector<sample, 256> history(1, 2);
+        const std::size_t count = 256 * 20 + 17;
+        for (std::size_t i = 0; i < count; ++i) history.push_back(make(i));
+        history.flush();
+
+        REQUIRE(history.size() == count);
+        REQUIRE(history.chunk_count() == 20);
+        REQUIRE(history.compressed_chunks() == 19);
+        REQUIRE(history.memory_bytes() < count * sizeof(sample) / 2);
+
+        for (std::size_t i = 0; i < count; i += 37) {
+            REQUIRE(history[i].time == make(i).time);
+            REQUIRE(history[i].value == make(i).value);
+        }
+        REQUIRE(history.front().time == make(0).time);
+        REQUIRE(history.back().time == make(count - 1).time);
+        REQUIRE_THROWS_AS(history.at(count), std::out_of_range);
+
+        std::size_t index = 0;
+        for (sample s : history) {
+            REQUIRE(s.time == make(index).time);
+            REQUIRE(s.flags == make(index).flags);
+            ++index;
+        }
+        REQUIRE(index == count);
+        REQUIRE((*(history.end() - 1)).time == make(count - 1).time);
+
+        std::size_t seen = 0;
+        history.for_each_chunk([&](art::span<const sample> chunk) {
+            for (const sample& s : chunk) REQUIRE(s.value == make(seen++).value);
+        });
+        REQUIRE(seen == count);
+    }
+
+    SECTION("incompressible chunks stay plain") {
+        art::compressed_vector<std::uint32_t, 1024> noise(0, 1);
+        std::uint32_t seed = 7;
+        for (std::size_t i = 0; i < 4096; ++i) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            noise.push_back(seed);
+        }
+        noise.push_back(0);
+        noise.flush();
+        REQUIRE(noise.chunk_count() == 4);
+        REQUIRE(noise.compressed_chunks() == 0);
+        REQUIRE(noise[4096] == 0);
+    }
+
+    SECTION("move, swap and clear") {
+        art::compressed_vector<std::uint64_t, 64> a(0, 1);
+        for (std::uint64_t i = 0; i < 1000; ++i) a.emplace_back(i * i);
+        art::compressed_vector<std::uint64_t, 64> b(std::move(a));
+        REQUIRE(a.empty());
+        REQUIRE(b.size() == 1000);
+        REQUIRE(b[999] == 999u * 999u);
+
+        a = std::move(b);
+        REQUIRE(a.size() == 1000);
+        a.flush();
+        REQUIRE(a.compressed_chunks() == a.chunk_count());
+        REQUIRE(a[500] == 500u * 500u);
+
+        a.swap(b);
+        REQUIRE(a.empty());
+        b.clear();
+        REQUIRE(b.empty());
+        REQUIRE(b.chunk_count() == 0);
+        for (std::uint64_t i = 0; i < 200; ++i) b.push_back(i);
+        b.flush();
+        REQUIRE(b[3] == 3);
+        REQUIRE(b[150] == 150);
+    }
+}
+
+TEST_CASE("String vector") {
+    std::vector<std::string> words;
+    std::uint32_t seed = 21;
+    for (std::size_t i = 0; i < 3000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        std::string word = i % 4 == 0 ? "prefix__" : "";
+        for (std::size_t c = 0; c < (seed >> 28) % 13; ++c) word.push_back(char('a' + (seed >> (c % 24)) % 5));
+        words.push_back(word);
+    }
+    words.push_back(std::string("ab\0", 3));
+    words.push_back("ab");
+    words.push_back(std::string("\xff\x01", 2));
+    art::string_vector strings(words.begin(), words.end());
+
+    SECTION("strings live in one arena") {
+        REQUIRE(strings.size() == words.size());
+        std::size_t chars = 0;
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            REQUIRE(strings[i] == art::string_ref(words[i]));
+            REQUIRE(strings[i].str() == words[i]);
+            chars += words[i].size();
+        }
+        REQUIRE(strings.char_count() == chars);
+        REQUIRE(strings.at(1).size() == words[1].size());
+        REQUIRE_THROWS_AS(strings.at(words.size()), std::out_of_range);
+        REQUIRE(strings.back() == "\xff\x01");
+        REQUIRE(std::equal(strings.begin(), strings.end(), words.begin(),
+                           [](art::string_ref a, const std::string& b) {return a == art::string_ref(b);}));
+
+        strings.push_back(strings[0]);
+        strings.push_back(strings[strings.size() - 1]);
+        REQUIRE(strings[strings.size() - 1] == art::string_ref(words[0]));
+        strings.pop_back();
+        strings.pop_back();
+        REQUIRE(strings.char_count() == chars);
+        REQUIRE(art::string_vector(words.begin(), words.end()) == strings);
+
+        art::string_ref text("hello world");
+        REQUIRE(text.substr(6) == "world");
+        REQUIRE(text.substr(0, 5) < text);
+        REQUIRE(art::string_ref("b") > art::string_ref("abc"));
+        REQUIRE_THROWS_AS(text.substr(12), std::out_of_range);
+    }
+
+    SECTION("prefix comparisons order like std::string") {
+        for (std::size_t i = 0; i + 1 < words.size(); ++i) {
+            int expected = words[i].compare(words[i + 1]);
+            int actual = strings.compare(i, i + 1);
+            REQUIRE((expected < 0) == (actual < 0));
+            REQUIRE((expected == 0) == (actual == 0));
+        }
+
+        auto order = strings.sort_permutation();
+        std::vector<std::size_t> expected(words.size());
+        std::iota(expected.begin(), expected.end(), std::size_t(0));
+        std::stable_sort(expected.begin(), expected.end(), [&](std::size_t a, std::size_t b) {return words[a] < words[b];});
+        REQUIRE(std::vector<std::size_t>(order.begin(), order.end()) == expected);
+
+        strings.sort();
+        std::sort(words.begin(), words.end());
+        for (std::size_t i = 0; i < words.size(); ++i) REQUIRE(strings[i] == art::string_ref(words[i]));
+
+        art::string_vector small{"b", "a"};
+        REQUIRE_THROWS_AS(small.permute(art::string_vector::permutation_type(3)), std::invalid_argument);
+        small.clear();
+        REQUIRE(small.empty());
+        REQUIRE(small.char_count() == 0);
+        small.push_back("");
+        REQUIRE(small.size() == 1);
+        REQUIRE(small[0].empty());
+    }
+
+    SECTION("long duplicate strings") {
+        std::string big(1 << 20, 'x');
+        std::vector<std::string> longs{big, "a", big, big + "a", big.substr(0, 400000) + "y", big + '\0', big};
+        longs[6][1 << 19] = 'w';
+        art::string_vector strings_long;
+        for (const auto& s : longs) strings_long.push_back(s);
+        auto order = strings_long.sort_permutation();
+        std::vector<std::size_t> expected(longs.size());
+        std::iota(expected.begin(), expected.end(), std::size_t(0));
+        std::stable_sort(expected.begin(), expected.end(), [&](std::size_t a, std::size_t b) {return longs[a] < longs[b];});
+        REQUIRE(std::vector<std::size_t>(order.begin(), order.end()) == expected);
+        strings_long.sort();
+        std::sort(longs.begin(), longs.end());
+        for (std::size_t i = 0; i < longs.size(); ++i) REQUIRE(strings_long[i] == art::string_ref(longs[i]));
+    }
+}
+
+TEST_CASE("Jagged vector") {
+    SECTION("rows are spans into one array") {
+        art::jagged_vector<int> rows{{1, 2, 3}, {}, {4}, {5, 6}};
+        REQUIRE(rows.size() == 4);
+        REQUIRE(rows.value_count() == 6);
+        REQUIRE(rows.row_size(0) == 3);
+        REQUIRE(rows[1].empty());
+        REQUIRE(rows[3][1] == 6);
+        REQUIRE(rows.front().size() == 3);
+        REQUIRE(rows.back().back() == 6);
+        REQUIRE(rows[2].data() == rows.values().data() + 3);
+        REQUIRE_THROWS_AS(rows.at(4), std::out_of_range);
+
+        for (int& value : rows[0]) value *= 10;
+        REQUIRE(rows.values()[2] == 30);
+
+        int total = 0;
+        for (art::span<const int> row : static_cast<const art::jagged_vector<int>&>(rows)) {
+            for (int value : row) total += value;
+        }
+        REQUIRE(total == 60 + 4 + 5 + 6);
+        art::jagged_vector<int>::const_iterator it = rows.begin();
+        REQUIRE((*(it + 3)).size() == 2);
+
+        std::vector<int> extra{7, 8, 9, 10};
+        rows.append_row(extra.begin(), extra.end());
+        rows.append_row({11});
+        REQUIRE(rows.size() == 6);
+        REQUIRE(rows[4][3] == 10);
+        REQUIRE(rows.offsets().back() == rows.value_count());
+        rows.pop_row();
+        rows.pop_row();
+        REQUIRE(rows.size() == 4);
+        REQUIRE(rows.value_count() == 6);
+        REQUIRE(rows != art::jagged_vector<int>{{1, 2, 3}, {}, {4}, {5, 6}});
+        REQUIRE(rows == art::jagged_vector<int>{{10, 20, 30}, {}, {4}, {5, 6}});
+
+        art::jagged_vector<int> other;
+        other.swap(rows);
+        REQUIRE(rows.empty());
+        other.clear();
+        REQUIRE(other.empty());
+        REQUIRE(other.value_count() == 0);
+    }
+
+    SECTION("builders") {
+        std::vector<std::size_t> sizes{2, 0, 3};
+        art::jagged_vector<double> zeros(art::span<const std::size_t>(sizes.data(), sizes.size()));
+        REQUIRE(zeros.size() == 3);
+        REQUIRE(zeros.value_count() == 5);
+        REQUIRE(zeros[2].size() == 3);
+        REQUIRE(zeros[2][2] == 0.0);
+
+        const std::size_t rows = 1000;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+        std::uint32_t seed = 5;
+        for (std::uint32_t i = 0; i < 300000; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            edges.emplace_back((seed >> 8) % rows, i);
+        }
+        std::vector<std::vector<std::uint32_t>> expected(rows);
+        for (const auto& edge : edges) expected[edge.first].push_back(edge.second);
+
+        art::thread_pool pool(3);
+        for (art::thread_pool* p : {&pool, &art::thread_pool::instance()}) {
+            auto graph = art::jagged_vector<std::uint32_t>::from_pairs(rows, edges.begin(), edges.end(), *p);
+            REQUIRE(graph.size() == rows);
+            REQUIRE(graph.value_count() == edges.size());
+            for (std::size_t row = 0; row < rows; ++row) {
+                REQUIRE(std::equal(graph[row].begin(), graph[row].end(), expected[row].begin(), expected[row].end()));
+            }
+        }
+
+        //fewer rows than parts leaves some parts without a row range
+        for (auto& edge : edges) edge.first %= 3;
+        auto narrow = art::jagged_vector<std::uint32_t>::from_pairs(3, edges.begin(), edges.end(), pool);
+        for (std::uint32_t row = 0; row < 3; ++row) {
+            std::vector<std::uint32_t> wanted;
+            for (const auto& edge : edges) if (edge.first == row) wanted.push_back(edge.second);
+            REQUIRE(std::equal(narrow[row].begin(), narrow[row].end(), wanted.begin(), wanted.end()));
+        }
+
+        REQUIRE(art::jagged_vector<std::uint32_t>::from_pairs(0, edges.begin(), edges.begin()).empty());
+        REQUIRE_THROWS_AS(art::jagged_vector<std::uint32_t>::from_pairs(2, edges.begin(), edges.end(), pool), std::out_of_range);
+        REQUIRE_THROWS_AS(art::jagged_vector<std::uint32_t>::from_pairs(2, edges.begin(), edges.begin() + 1000), std::out_of_range);
+    }
+}
+
+TEST_CASE("Sparse vector") {
+    typedef art::sparse_vector<int, 64> sparse_t;
+
+    SECTION("unset elements read as default") {
+        art::sparse_vector<double> v(std::size_t(1) << 30);
+        REQUIRE(v.size() == (std::size_t(1) << 30));
+        v.set(5, 1.5);
+        v.set(999999999, -2.0);
+        REQUIRE(v[5] == 1.5);
+        REQUIRE(v[999999999] == -2.0);
+        REQUIRE(v[6] == 0.0);
+        REQUIRE(v.nonzero_count() == 2);
+        REQUIRE(v.chunk_count() == 2);
+        REQUIRE(v.memory_bytes() < 1024);
+        REQUIRE_THROWS_AS(v.set(std::size_t(1) << 30, 1.0), std::out_of_range);
+        REQUIRE_THROWS_AS(v.at(std::size_t(1) << 30), std::out_of_range);
+        v.set(5, 0.0);
+        REQUIRE_FALSE(v.contains(5));
+        REQUIRE(v.chunk_count() == 1);
+    }
+
+    SECTION("random updates match a map") {
+        sparse_t v(1000);
+        std::map<std::size_t, int> reference;
+        std::uint32_t seed = 7;
+        for (int step = 0; step < 20000; ++step) {
+            seed = seed * 1664525u + 1013904223u;
+            //indices concentrate on the first chunks so they cross both fill thresholds
+            std::size_t pos = (seed >> 8) % (step % 3 ? 200 : 1000);
+            int value = int(seed >> 28) % 4;
+            v.set(pos, value);
+            if (value) reference[pos] = value;
+            else reference.erase(pos);
+        }
+        REQUIRE(v.nonzero_count() == reference.size());
+        REQUIRE(v.dense_chunks() > 0);
+        auto expected = reference.begin();
+        for (auto it = v.begin(); it != v.end(); ++it, ++expected) {
+            REQUIRE((*it).index == expected->first);
+            REQUIRE((*it).value == expected->second);
+        }
+        REQUIRE(expected == reference.end());
+        std::size_t visited = 0;
+        v.for_each([&](std::size_t index, int value) {
+            REQUIRE(reference.at(index) == value);
+            ++visited;
+        });
+        REQUIRE(visited == reference.size());
+
+        //emptying a dense chunk goes back through the sparse form and drops it
+        for (std::size_t i = 0; i < 64; ++i) v.erase(i);
+        REQUIRE(v[3] == 0);
+        for (std::size_t i = 0; i < 1000; ++i) v.erase(i);
+        REQUIRE(v.chunk_count() == 0);
+        REQUIRE(v.begin() == v.end());
+    }
+
+    SECTION("dot products and merges") {
+        const std::size_t n = 640;
+        std::vector<int> a(n), b(n);
+        std::uint32_t seed = 3;
+        for (std::size_t i = 0; i < n; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            //chunk 0 dense in both, chunk 1 dense in a only, the rest sparse or empty
+            std::size_t chunk = i / 64;
+            bool fill_a = chunk == 0 || chunk == 1 || (chunk < 6 && seed % 16 == 0);
+            bool fill_b = chunk == 0 || ((chunk == 1 || chunk == 4 || chunk == 5) && (seed >> 8) % 8 == 0);
+            if (fill_a) a[i] = int(seed % 7) - 3;
+            if (fill_b) b[i] = int((seed >> 12) % 5) - 2;
+        }
+        sparse_t sa(art::span<const int>(a.data(), n)), sb(art::span<const int>(b.data(), n));
+        REQUIRE(sa.dense_chunks() >= 2);
+        long expected = 0;
+        for (std::size_t i = 0; i < n; ++i) expected += long(a[i]) * b[i];
+        REQUIRE(sa.dot(sb) == expected);
+        REQUIRE(sb.dot(sa) == expected);
+        REQUIRE(sa.dot(art::span<const int>(b.data(), n)) == expected);
+
+        sparse_t sum = sa.merge(sb, [](int x, int y) {return x + y;});
+        sparse_t difference = sa.merge(sa, [](int x, int y) {return x - y;});
+        for (std::size_t i = 0; i < n; ++i) REQUIRE(sum[i] == a[i] + b[i]);
+        REQUIRE(difference.nonzero_count() == 0);
+        REQUIRE(difference.chunk_count() == 0);
+        REQUIRE(sa.merge(sparse_t(n), [](int x, int y) {return x + y;}) == sa);
+        REQUIRE_THROWS_AS(sa.dot(sparse_t(n + 1)), std::invalid_argument);
+    }
+
+    SECTION("copy, move and resize") {
+        sparse_t v(300);
+        for (std::size_t i = 0; i < 300; i += 2) v.set(i, int(i));
+        sparse_t copy(v);
+        REQUIRE(copy == v);
+        copy.set(4, 1);
+        REQUIRE(copy != v);
+        sparse_t moved(std::move(copy));
+        REQUIRE(moved[4] == 1);
+        v.resize(100);
+        REQUIRE(v.size() == 100);
+        REQUIRE(v.nonzero_count() == 49);
+        REQUIRE(v[98] == 98);
+        v.resize(300);
+        REQUIRE(v[200] == 0);
+        v.resize(64);
+        REQUIRE(v.chunk_count() == 1);
+    }
+}
@@ -0,0 +1,563 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "segmented_vector.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //LZ77 codec in the spirit of LZ4: a stream of sequences, each a token byte holding the literal
+        //length and match length - 4 in its two nibbles (15 means more length bytes follow, 255 each
+        //while they continue), the literals, then a 2 byte little endian match offset. The last
+        //sequence has literals only.
+        const std::size_t LZ_MIN_MATCH = 4;
+        const std::size_t LZ_HASH_BITS = 12;
+        //matches start at least this far from the end and the last bytes are always literals
+        const std::size_t LZ_MATCH_LIMIT = 12;
+        const std::size_t LZ_LAST_LITERALS = 5;
+
+        //worst case compressed size of size bytes
+        inline std::size_t lz_bound(std::size_t size) noexcept {
+            return size + size / 255 + 16;
+        }
+
+        inline std::uint32_t lz_read32(const std::uint8_t* p) noexcept {
+            std::uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        inline std::uint8_t* lz_write_length(std::uint8_t* out, std::size_t length) noexcept {
+            for (; length >= 255; length -= 255) *out++ = 255;
+            *out++ = std::uint8_t(length);
+            return out;
+        }
+
+        inline std::uint8_t* lz_write_sequence(std::uint8_t* out, const std::uint8_t* literals, std::size_t literal_count,
+                                               std::size_t offset, std::size_t match_length) noexcept {
+            std::uint8_t* token = out++;
+            std::size_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+            *token = std::uint8_t((std::min<std::size_t>(literal_count, 15) << 4) | std::min<std::size_t>(match_code, 15));
+            if (literal_count >= 15) out = lz_write_length(out, literal_count - 15);
+            std::memcpy(out, literals, literal_count);
+            out += literal_count;
+            if (!match_length) return out;
+            *out++ = std::uint8_t(offset);
+            *out++ = std::uint8_t(offset >> 8);
+            if (match_code >= 15) out = lz_write_length(out, match_code - 15);
+            return out;
+        }
+
+        //compresses [in, in + size) into out, which holds lz_bound(size) bytes; returns the bytes written
+        inline std::size_t lz_compress(const std::uint8_t* in, std::size_t size, std::uint8_t* out) {
+            std::unique_ptr<std::uint32_t[]> table(new std::uint32_t[std::size_t(1) << LZ_HASH_BITS]());
+            std::uint8_t* first = out;
+            std::size_t anchor = 0, pos = 0;
+            std::size_t limit = size > LZ_MATCH_LIMIT ? size - LZ_MATCH_LIMIT : 0;
+            while (pos < limit) {
+                std::uint32_t sequence = lz_read32(in + pos);
+                std::uint32_t& slot = table[(sequence * 2654435761u) >> (32 - LZ_HASH_BITS)];
+                std::size_t candidate = slot;
+                slot = std::uint32_t(pos);
+                if (candidate < pos && pos - candidate <= 0xffff && lz_read32(in + candidate) == sequence) {
+                    std::size_t length = LZ_MIN_MATCH;
+                    while (pos + length < size - LZ_LAST_LITERALS && in[candidate + length] == in[pos + length]) ++length;
+                    out = lz_write_sequence(out, in + anchor, pos - anchor, pos - candidate, length);
+                    pos += length;
+                    anchor = pos;
+                } else {
+                    //step faster through data that keeps missing
+                    pos += 1 + ((pos - anchor) >> 6);
+                }
+            }
+            out = lz_write_sequence(out, in + anchor, size - anchor, 0, 0);
+            return std::size_t(out - first);
+        }
+
+        inline std::size_t lz_read_length(const std::uint8_t*& in, const std::uint8_t* end) {
+            std::size_t length = 0;
+            std::uint8_t byte;
+            do {
+                if (in == end) throw std::runtime_error("Corrupt compressed data");
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return length;
+        }
+
+        //decompresses [in, in + size) into exactly out_size bytes at out
+        inline void lz_decompress(const std::uint8_t* in, std::size_t size, std::uint8_t* out, std::size_t out_size) {
+            const std::uint8_t* in_end = in + size;
+            std::uint8_t* first = out;
+            std::uint8_t* out_end = out + out_size;
+            while (in < in_end) {
+                std::uint8_t token = *in++;
+                std::size_t literal_count = token >> 4;
+                if (literal_count == 15) literal_count += lz_read_length(in, in_end);
+                if (std::size_t(in_end - in) < literal_count || std::size_t(out_end - out) < literal_count) {
+                    throw std::runtime_error("Corrupt compressed data");
+                }
+                std::memcpy(out, in, literal_count);
+                in += literal_count;
+                out += literal_count;
+                if (in == in_end) break;
+
+                if (in_end - in < 2) throw std::runtime_error("Corrupt compressed data");
+                std::size_t offset = std::size_t(in[0]) | (std::size_t(in[1]) << 8);
+                in += 2;
+                std::size_t length = (token & 15) + LZ_MIN_MATCH;
+                if ((token & 15) == 15) length += lz_read_length(in, in_end);
+                if (offset == 0 || offset > std::size_t(out - first) || std::size_t(out_end - out) < length) {
+                    throw std::runtime_error("Corrupt compressed data");
+                }
+                //an overlapping match repeats the last offset bytes; any multiple of offset back holds the
+                //same bytes, so the copy distance doubles until the rest fits in one copy
+                for (std::size_t distance = offset; length;) {
+                    std::size_t step = std::min(distance, length);
+                    std::memcpy(out, out - distance, step);
+                    out += step;
+                    length -= step;
+                    distance *= 2;
+                }
+            }
+            if (out != out_end) throw std::runtime_error("Corrupt compressed data");
+        }
+
+        //groups byte b of every Width byte element together, so the constant high bytes of numbers form
+        //long runs; the constant width lets the compiler unroll the inner loop
+        template <std::size_t Width>
+        void byte_shuffle(const std::uint8_t* in, std::size_t count, std::uint8_t* out) noexcept {
+            for (std::size_t b = 0; b < Width; ++b) {
+                for (std::size_t i = 0; i < count; ++i) out[b * count + i] = in[i * Width + b];
+            }
+        }
+
+        template <std::size_t Width>
+        void byte_unshuffle(const std::uint8_t* in, std::size_t count, std::uint8_t* out) noexcept {
+            for (std::size_t i = 0; i < count; ++i) {
+                for (std::size_t b = 0; b < Width; ++b) out[i * Width + b] = in[b * count + i];
+            }
+        }
+
+        //elements per chunk of compressed_vector: 64 KB worth, rounded down to a power of two
+        template <typename Type>
+        struct compressed_chunk_size{
+            static constexpr std::size_t value = floor_power_of_two(65536 / sizeof(Type));
+        };
+    }
+
+    //Append only vector for long histories. Elements are appended to a plain tail; every full tail is
+    //sealed into a chunk of ChunkSize elements, and once a chunk is older than the newest hot_chunks
+    //it is compressed on the thread pool (bytes shuffled by significance, then LZ compressed) and its
+    //plain copy is released. Reading a cold chunk decompresses it into a small LRU cache of
+    //cached_chunks chunks. Elements are returned by value, since a cached copy can be evicted by any
+    //later read. Reads touch the cache, so even const access is not safe from several threads.
+    template <typename Type, std::size_t ChunkSize = detail::compressed_chunk_size<Type>::value,
+              typename Allocator = std::allocator<Type>>
+    class compressed_vector{
+        static_assert(std::is_trivially_copyable<Type>::value, "compressed_vector stores elements as bytes");
+        static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    public:
+        typedef Type                                                                            value_type;
+        typedef Allocator                                                                       allocator_type;
+        typedef value_type                                                                      const_reference;
+        typedef value_type                                                                      reference;
+        typedef std::size_t                                                                     size_type;
+        typedef std::ptrdiff_t                                                                  difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t>  byte_allocator;
+
+        static constexpr size_type CHUNK_SIZE = ChunkSize;
+        static constexpr size_type DEFAULT_HOT_CHUNKS = 2;
+        static constexpr size_type DEFAULT_CACHED_CHUNKS = 4;
+
+        typedef detail::index_iterator<const compressed_vector, Type> const_iterator;
+        typedef const_iterator                                        iterator;
+
+        // construct/copy/destroy
+        explicit compressed_vector(const Allocator& alloc = Allocator());
+        compressed_vector(size_type hot_chunks, size_type cached_chunks, const Allocator& alloc = Allocator());
+        compressed_vector(const compressed_vector&) = delete;
+        compressed_vector(compressed_vector&& other);
+        //waits for the compression still running
+        ~compressed_vector();
+
+        compressed_vector& operator=(const compressed_vector&) = delete;
+        compressed_vector& operator=(compressed_vector&& other);
+
+        allocator_type get_allocator() const;
+
+        const_reference operator[](size_type pos) const;
+        const_reference at(size_type pos) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        //calls fn(span<const Type>) for every chunk and then the tail, in order; cold chunks are
+        //decompressed into a scratch buffer and do not disturb the cache
+        template <typename Function>
+        void for_each_chunk(Function fn) const;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        //sealed chunks, not counting the tail
+        size_type chunk_count() const noexcept;
+        //chunks whose plain copy has been released
+        size_type compressed_chunks() const noexcept;
+        //bytes held by chunks, tail and cache
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        void push_back(const Type& value);
+        template< class... Args >
+        void emplace_back(Args&&... args);
+        //waits for background compression, releases the plain copies it replaced and rethrows the
+        //first error it hit
+        void flush();
+        void clear();
+        void swap(compressed_vector& other) noexcept;
+
+    private:
+        enum _m_state : int {_m_hot, _m_compressing, _m_compressed};
+
+        struct _m_chunk{
+            //elements until compressed, released afterwards
+            vector<Type, Allocator> plain;
+            vector<std::uint8_t, byte_allocator> packed;
+            std::atomic<int> state;
+
+            explicit _m_chunk(const Allocator& alloc) : plain(alloc), packed(byte_allocator(alloc)), state(_m_hot) {}
+        };
+
+        struct _m_cache_slot{
+            const _m_chunk* chunk;
+            std::uint64_t used;
+            vector<Type, Allocator> values;
+
+            explicit _m_cache_slot(const Allocator& alloc) : chunk(nullptr), used(0), values(alloc) {}
+        };
+
+        vector<_m_chunk*> _m_chunks;
+        vector<Type, Allocator> _m_tail;
+        size_type _m_hot_chunks;
+        size_type _m_cached_chunks;
+        //chunks before this one are compressed with their plain copy released, or left plain for good
+        size_type _m_collected = 0;
+        mutable vector<_m_cache_slot> _m_cache;
+        mutable std::uint64_t _m_clock = 0;
+        mutable vector<std::uint8_t, byte_allocator> _m_scratch;
+        std::unique_ptr<task_group> _m_tasks;
+
+        void _m_seal();
+        //releases plain copies of chunks compressed in the background
+        void _m_collect() noexcept;
+        void _m_release_chunks() noexcept;
+        static void _m_compress(_m_chunk& chunk);
+        void _m_decompress(const _m_chunk& chunk, Type* out) const;
+        //elements of a sealed chunk, from its plain copy or the cache
+        const Type* _m_chunk_data(size_type index) const;
+    };
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::CHUNK_SIZE;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::DEFAULT_HOT_CHUNKS;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::DEFAULT_CACHED_CHUNKS;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    compressed_vector<Type, ChunkSize, Allocator>::compressed_vector(const Allocator& alloc)
+        : compressed_vector(DEFAULT_HOT_CHUNKS, DEFAULT_CACHED_CHUNKS, alloc) {}
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    compressed_vector<Type, ChunkSize, Allocator>::compressed_vector(size_type hot_chunks, size_type cached_chunks, const Allocator& alloc)
+        : _m_tail(alloc), _m_hot_chunks(hot_chunks), _m_cached_chunks(std::max<size_type>(cached_chunks, 1)),
+          _m_scratch(byte_allocator(alloc)), _m_tasks(new task_group()) {
+        //slots are never moved, cached pointers into them stay valid until evicted
+        _m_cache.reserve(_m_cached_chunks);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    compressed_vector<Type, ChunkSize, Allocator>::compressed_vector(compressed_vector&& other)
+        : compressed_vector(other._m_hot_chunks, other._m_cached_chunks, other.get_allocator()) {
+        swap(other);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    compressed_vector<Type, ChunkSize, Allocator>::~compressed_vector() {
+        _m_release_chunks();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    compressed_vector<Type, ChunkSize, Allocator>& compressed_vector<Type, ChunkSize, Allocator>::operator=(compressed_vector&& other) {
+        compressed_vector moved(std::move(other));
+        swap(moved);
+        return *this;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::_m_release_chunks() noexcept {
+        //destroying the group waits for its tasks without rethrowing
+        _m_tasks.reset();
+        for (_m_chunk* chunk : _m_chunks) delete chunk;
+        _m_chunks.erase(_m_chunks.begin(), _m_chunks.end());
+        _m_collected = 0;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::allocator_type compressed_vector<Type, ChunkSize, Allocator>::get_allocator() const {
+        return _m_tail.get_allocator();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::_m_compress(_m_chunk& chunk) {
+        size_type bytes = chunk.plain.size() * sizeof(Type);
+        size_type packed;
+        try {
+            vector<std::uint8_t, byte_allocator> shuffled(byte_allocator(chunk.plain.get_allocator()));
+            shuffled.resize(bytes);
+            detail::byte_shuffle<sizeof(Type)>(reinterpret_cast<const std::uint8_t*>(chunk.plain.data()), chunk.plain.size(), shuffled.data());
+            chunk.packed.resize(detail::lz_bound(bytes));
+            packed = detail::lz_compress(shuffled.data(), bytes, chunk.packed.data());
+        } catch (...) {
+            //the chunk stays plain, flush() reports the error
+            chunk.packed.clear();
+            chunk.state.store(_m_hot, std::memory_order_release);
+            throw;
+        }
+        if (packed >= bytes) {
+            //incompressible, the chunk stays plain
+            chunk.packed.clear();
+            chunk.state.store(_m_hot, std::memory_order_release);
+            return;
+        }
+        chunk.packed.erase(chunk.packed.begin() + packed, chunk.packed.end());
+        chunk.packed.shrink_to_fit();
+        chunk.state.store(_m_compressed, std::memory_order_release);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::_m_decompress(const _m_chunk& chunk, Type* out) const {
+        size_type bytes = ChunkSize * sizeof(Type);
+        _m_scratch.resize(bytes);
+        detail::lz_decompress(chunk.packed.data(), chunk.packed.size(), _m_scratch.data(), bytes);
+        detail::byte_unshuffle<sizeof(Type)>(_m_scratch.data(), ChunkSize, reinterpret_cast<std::uint8_t*>(out));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::_m_seal() {
+        _m_collect();
+        _m_chunk* chunk = new _m_chunk(_m_tail.get_allocator());
+        chunk->plain.swap(_m_tail);
+        try {
+            _m_chunks.emplace_back(chunk);
+        } catch (...) {
+            chunk->plain.swap(_m_tail);
+            delete chunk;
+            throw;
+        }
+        _m_tail.reserve(ChunkSize);
+        if (_m_chunks.size() > _m_hot_chunks) {
+            _m_chunk* cold = _m_chunks[_m_chunks.size() - _m_hot_chunks - 1];
+            cold->state.store(_m_compressing, std::memory_order_relaxed);
+            //without workers nothing would run the task before the next flush()
+            if (_m_tasks->pool().size() == 0) _m_compress(*cold);
+            else _m_tasks->run([cold] { _m_compress(*cold); });
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::_m_collect() noexcept {
+        for (; _m_collected < _m_chunks.size(); ++_m_collected) {
+            _m_chunk* chunk = _m_chunks[_m_collected];
+            int state = chunk->state.load(std::memory_order_acquire);
+            if (state == _m_compressing) return;
+            if (state == _m_hot) {
+                //still inside the hot window, or incompressible
+                if (_m_collected + _m_hot_chunks >= _m_chunks.size()) return;
+                continue;
+            }
+            //the task no longer reads the plain copy once it published the packed one
+            vector<Type, Allocator>(chunk->plain.get_allocator()).swap(chunk->plain);
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    const Type* compressed_vector<Type, ChunkSize, Allocator>::_m_chunk_data(size_type index) const {
+        const _m_chunk* chunk = _m_chunks[index];
+        //the plain copy is only released by _m_collect, never while a const read runs
+        if (!chunk->plain.empty()) return chunk->plain.data();
+
+        _m_cache_slot* victim = nullptr;
+        ++_m_clock;
+        for (_m_cache_slot& slot : _m_cache) {
+            if (slot.chunk == chunk) {
+                slot.used = _m_clock;
+                return slot.values.data();
+            }
+            if (!victim || slot.used < victim->used) victim = &slot;
+        }
+        if (_m_cache.size() < _m_cached_chunks) {
+            _m_cache.emplace_back(_m_tail.get_allocator());
+            victim = &_m_cache.back();
+            victim->values.resize(ChunkSize);
+        }
+        victim->chunk = nullptr;
+        _m_decompress(*chunk, victim->values.data());
+        victim->chunk = chunk;
+        victim->used = _m_clock;
+        return victim->values.data();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_reference compressed_vector<Type, ChunkSize, Allocator>::operator[](size_type pos) const {
+        size_type index = pos / ChunkSize;
+        if (index == _m_chunks.size()) return _m_tail[pos % ChunkSize];
+        return _m_chunk_data(index)[pos % ChunkSize];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_reference compressed_vector<Type, ChunkSize, Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_reference compressed_vector<Type, ChunkSize, Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_reference compressed_vector<Type, ChunkSize, Allocator>::back() const {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_iterator compressed_vector<Type, ChunkSize, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_iterator compressed_vector<Type, ChunkSize, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_iterator compressed_vector<Type, ChunkSize, Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::const_iterator compressed_vector<Type, ChunkSize, Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<typename Function>
+    void compressed_vector<Type, ChunkSize, Allocator>::for_each_chunk(Function fn) const {
+        vector<Type, Allocator> buffer(_m_tail.get_allocator());
+        for (const _m_chunk* chunk : _m_chunks) {
+            if (!chunk->plain.empty()) {
+                fn(span<const Type>(chunk->plain.data(), ChunkSize));
+                continue;
+            }
+            buffer.resize(ChunkSize);
+            _m_decompress(*chunk, buffer.data());
+            fn(span<const Type>(buffer.data(), ChunkSize));
+        }
+        if (!_m_tail.empty()) fn(span<const Type>(_m_tail.data(), _m_tail.size()));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    bool compressed_vector<Type, ChunkSize, Allocator>::empty() const noexcept {
+        return _m_chunks.empty() && _m_tail.empty();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::size() const noexcept {
+        return _m_chunks.size() * ChunkSize + _m_tail.size();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::chunk_count() const noexcept {
+        return _m_chunks.size();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::compressed_chunks() const noexcept {
+        size_type count = 0;
+        for (const _m_chunk* chunk : _m_chunks) count += chunk->plain.empty();
+        return count;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename compressed_vector<Type, ChunkSize, Allocator>::size_type compressed_vector<Type, ChunkSize, Allocator>::memory_bytes() const noexcept {
+        size_type bytes = _m_chunks.capacity() * sizeof(_m_chunk*) + _m_tail.capacity() * sizeof(Type);
+        for (const _m_chunk* chunk : _m_chunks) {
+            bytes += sizeof(_m_chunk) + chunk->plain.capacity() * sizeof(Type);
+            //the packed copy may still be growing on a worker until it is published
+            if (chunk->state.load(std::memory_order_acquire) == _m_compressed) bytes += chunk->packed.capacity();
+        }
+        for (const _m_cache_slot& slot : _m_cache) bytes += slot.values.capacity() * sizeof(Type);
+        return bytes;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::push_back(const Type& value) {
+        if (_m_tail.size() == ChunkSize) _m_seal();
+        _m_tail.emplace_back(value);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<class... Args>
+    void compressed_vector<Type, ChunkSize, Allocator>::emplace_back(Args&&... args) {
+        push_back(Type(std::forward<Args>(args)...));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::flush() {
+        _m_tasks->wait();
+        _m_collect();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::clear() {
+        _m_release_chunks();
+        _m_tasks.reset(new task_group());
+        _m_tail.erase(_m_tail.begin(), _m_tail.end());
+        _m_cache.erase(_m_cache.begin(), _m_cache.end());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void compressed_vector<Type, ChunkSize, Allocator>::swap(compressed_vector& other) noexcept {
+        _m_chunks.swap(other._m_chunks);
+        _m_tail.swap(other._m_tail);
+        std::swap(_m_hot_chunks, other._m_hot_chunks);
+        std::swap(_m_cached_chunks, other._m_cached_chunks);
+        std::swap(_m_collected, other._m_collected);
+        _m_cache.swap(other._m_cache);
+        std::swap(_m_clock, other._m_clock);
+        _m_scratch.swap(other._m_scratch);
+        _m_tasks.swap(other._m_tasks);
+    }
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    //Append-only vector for many concurrent writers and readers. push_back claims a slot with one
+    //atomic fetch_add; storage is a table of segments doubling in size, so growth never moves an
+    //element and references stay valid. Every slot has a ready flag; size() is the longest prefix of
+    //ready slots, advanced by whichever writer completes it, so writers never wait on each other and
+    //readers may iterate [0, size()) while writers append.
+    //An element constructor that throws terminates the program, its slot could never become ready.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class concurrent_vector{
+    public:
+        typedef Type                                                     value_type;
+        typedef Allocator                                                allocator_type;
+        typedef value_type&                                              reference;
+        typedef const value_type&                                        const_reference;
+        typedef std::ptrdiff_t                                           difference_type;
+        typedef std::size_t                                              size_type;
+        typedef typename std::allocator_traits<Allocator>::pointer       pointer;
+        typedef typename std::allocator_traits<Allocator>::const_pointer const_pointer;
+
+        typedef detail::index_iterator<concurrent_vector, Type&>             iterator;
+        typedef detail::index_iterator<const concurrent_vector, const Type&> const_iterator;
+
+        explicit concurrent_vector(const Allocator& alloc = Allocator());
+        ~concurrent_vector();
+
+        concurrent_vector(const concurrent_vector&) = delete;
+        concurrent_vector& operator=(const concurrent_vector&) = delete;
+
+        //thread safe appends, return the index of the new element
+        size_type push_back(const Type& value);
+        size_type push_back(Type&& value);
+        template< class... Args >
+        size_type emplace_back(Args&&... args);
+
+        //allocates segments for size elements up front, thread safe
+        void reserve(size_type size);
+
+        //published elements, thread safe
+        size_type size() const noexcept;
+        bool empty() const noexcept;
+        size_type capacity() const noexcept;
+
+        reference       operator[](size_type pos);
+        const_reference operator[](size_type pos) const;
+        reference       at(size_type pos);
+        const_reference at(size_type pos) const;
+
+        //iterators cover the elements published when end() was called
+        iterator        begin() noexcept;
+        const_iterator  begin() const noexcept;
+        iterator        end() noexcept;
+        const_iterator  end() const noexcept;
+
+        //contiguous copy of the published elements
+        vector<Type, Allocator> to_vector() const;
+
+        allocator_type get_allocator() const;
+
+        //not thread safe
+        void clear();
+
+    private:
+        static const unsigned _m_FIRST_SEGMENT_BITS = 5;
+        static const unsigned _m_SEGMENT_COUNT = 64 - _m_FIRST_SEGMENT_BITS + 1;
+        Allocator _m_allocator;
+        std::atomic<pointer> _m_segments[_m_SEGMENT_COUNT];
+        std::atomic<std::atomic<bool>*> _m_ready[_m_SEGMENT_COUNT];
+        std::atomic<size_type> _m_claimed;
+        std::atomic<size_type> _m_published;
+
+        static unsigned _m_segment_of(size_type index) noexcept;
+        static size_type _m_segment_base(unsigned segment) noexcept;
+        static size_type _m_segment_size(unsigned segment) noexcept;
+
+        pointer _m_segment(unsigned segment);
+        std::atomic<bool>* _m_ready_flags(unsigned segment);
+        pointer _m_slot(size_type index) const noexcept;
+        bool _m_is_ready(size_type index) const noexcept;
+        void _m_advance_published() noexcept;
+
+        template< class... Args >
+        void _m_construct_and_publish(size_type index, Args&&... args) noexcept;
+    };
+
+    template<typename Type, typename Allocator>
+    concurrent_vector<Type, Allocator>::concurrent_vector(const Allocator& alloc)
+        : _m_allocator(alloc), _m_claimed(0), _m_published(0) {
+        for (unsigned i = 0; i < _m_SEGMENT_COUNT; ++i) {
+            _m_segments[i].store(nullptr, std::memory_order_relaxed);
+            _m_ready[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    concurrent_vector<Type, Allocator>::~concurrent_vector() {
+        clear();
+    }
+
+    template<typename Type, typename Allocator>
+    unsigned concurrent_vector<Type, Allocator>::_m_segment_of(size_type index) noexcept {
+        if (index < (size_type(1) << _m_FIRST_SEGMENT_BITS)) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        unsigned log2 = 63 - __builtin_clzll((unsigned long long) index);
+#else
+        unsigned log2 = 0;
+        while (index >> (log2 + 1)) ++log2;
+#endif
+        return log2 - _m_FIRST_SEGMENT_BITS + 1;
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type
+    concurrent_vector<Type, Allocator>::_m_segment_base(unsigned segment) noexcept {
+        return segment == 0 ? 0 : size_type(1) << (_m_FIRST_SEGMENT_BITS + segment - 1);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type
+    concurrent_vector<Type, Allocator>::_m_segment_size(unsigned segment) noexcept {
+        return segment == 0 ? size_type(1) << _m_FIRST_SEGMENT_BITS : _m_segment_base(segment);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::pointer concurrent_vector<Type, Allocator>::_m_segment(unsigned segment) {
+        pointer current = _m_segments[segment].load(std::memory_order_acquire);
+        if (current) return current;
+        //racing threads all allocate, the losers of the exchange give their block back
+        pointer fresh = std::allocator_traits<Allocator>::allocate(_m_allocator, _m_segment_size(segment));
+        if (_m_segments[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) return fresh;
+        std::allocator_traits<Allocator>::deallocate(_m_allocator, fresh, _m_segment_size(segment));
+        return current;
+    }
+
+    template<typename Type, typename Allocator>
+    std::atomic<bool>* concurrent_vector<Type, Allocator>::_m_ready_flags(unsigned segment) {
+        std::atomic<bool>* current = _m_ready[segment].load(std::memory_order_acquire);
+        if (current) return current;
+        std::atomic<bool>* fresh = new std::atomic<bool>[_m_segment_size(segment)]();
+        if (_m_ready[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) return fresh;
+        delete[] fresh;
+        return current;
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::pointer concurrent_vector<Type, Allocator>::_m_slot(size_type index) const noexcept {
+        unsigned segment = _m_segment_of(index);
+        return _m_segments[segment].load(std::memory_order_acquire) + (index - _m_segment_base(segment));
+    }
+
+    template<typename Type, typename Allocator>
+    bool concurrent_vector<Type, Allocator>::_m_is_ready(size_type index) const noexcept {
+        unsigned segment = _m_segment_of(index);
+        std::atomic<bool>* flags = _m_ready[segment].load(std::memory_order_acquire);
+        return flags && flags[index - _m_segment_base(segment)].load();
+    }
+
+    //moves the published size over every ready slot following it; the flag store and the size
+    //exchange are sequentially consistent, so of two writers finishing neighbouring slots at least
+    //one sees the other's slot ready
+    template<typename Type, typename Allocator>
+    void concurrent_vector<Type, Allocator>::_m_advance_published() noexcept {
+        size_type published = _m_published.load();
+        for (;;) {
+            size_type ready = published;
+            while (_m_is_ready(ready)) ++ready;
+            if (ready == published) return;
+            if (_m_published.compare_exchange_weak(published, ready)) published = ready;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    void concurrent_vector<Type, Allocator>::_m_construct_and_publish(size_type index, Args&&... args) noexcept {
+        unsigned segment = _m_segment_of(index);
+        size_type offset = index - _m_segment_base(segment);
+        std::atomic<bool>* flags = _m_ready_flags(segment);
+        std::allocator_traits<Allocator>::construct(_m_allocator, _m_segment(segment) + offset, std::forward<Args>(args)...);
+        flags[offset].store(true);
+        _m_advance_published();
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type concurrent_vector<Type, Allocator>::push_back(const Type& value) {
+        return emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type concurrent_vector<Type, Allocator>::push_back(Type&& value) {
+        return emplace_back(std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename concurrent_vector<Type, Allocator>::size_type concurrent_vector<Type, Allocator>::emplace_back(Args&&... args) {
+        size_type index = _m_claimed.fetch_add(1, std::memory_order_relaxed);
+        _m_construct_and_publish(index, std::forward<Args>(args)...);
+        return index;
+    }
+
+    template<typename Type, typename Allocator>
+    void concurrent_vector<Type, Allocator>::reserve(size_type size) {
+        if (size == 0) return;
+        for (unsigned segment = 0; segment <= _m_segment_of(size - 1); ++segment) _m_segment(segment);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type concurrent_vector<Type, Allocator>::size() const noexcept {
+        return _m_published.load(std::memory_order_acquire);
+    }
+
+    template<typename Type, typename Allocator>
+    bool concurrent_vector<Type, Allocator>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::size_type concurrent_vector<Type, Allocator>::capacity() const noexcept {
+        size_type total = 0;
+        for (unsigned segment = 0; segment < _m_SEGMENT_COUNT; ++segment) {
+            if (!_m_segments[segment].load(std::memory_order_acquire)) break;
+            total += _m_segment_size(segment);
+        }
+        return total;
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::reference concurrent_vector<Type, Allocator>::operator[](size_type pos) {
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::const_reference concurrent_vector<Type, Allocator>::operator[](size_type pos) const {
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::reference concurrent_vector<Type, Allocator>::at(size_type pos) {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::const_reference concurrent_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::iterator concurrent_vector<Type, Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::const_iterator concurrent_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::iterator concurrent_vector<Type, Allocator>::end() noexcept {
+        return iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::const_iterator concurrent_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator> concurrent_vector<Type, Allocator>::to_vector() const {
+        size_type count = size();
+        vector<Type, Allocator> result(_m_allocator);
+        result.reserve(count);
+        //copy segment by segment, each one is contiguous
+        for (unsigned segment = 0; _m_segment_base(segment) < count; ++segment) {
+            const_pointer first = _m_segments[segment].load(std::memory_order_acquire);
+            size_type in_segment = std::min(_m_segment_size(segment), count - _m_segment_base(segment));
+            for (size_type i = 0; i < in_segment; ++i) result.emplace_back(first[i]);
+        }
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    typename concurrent_vector<Type, Allocator>::allocator_type concurrent_vector<Type, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template<typename Type, typename Allocator>
+    void concurrent_vector<Type, Allocator>::clear() {
+        size_type count = _m_published.load(std::memory_order_acquire);
+        for (size_type i = 0; i < count; ++i) std::allocator_traits<Allocator>::destroy(_m_allocator, _m_slot(i));
+        for (unsigned segment = 0; segment < _m_SEGMENT_COUNT; ++segment) {
+            pointer first = _m_segments[segment].exchange(nullptr, std::memory_order_acq_rel);
+            if (first) std::allocator_traits<Allocator>::deallocate(_m_allocator, first, _m_segment_size(segment));
+            delete[] _m_ready[segment].exchange(nullptr, std::memory_order_acq_rel);
+        }
+        _m_claimed.store(0, std::memory_order_relaxed);
+        _m_published.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,470 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    //Reference count policies of cow_vector, both start at one owner
+    struct atomic_refcount{
+        std::atomic<std::size_t> owners{1};
+
+        void acquire() noexcept { owners.fetch_add(1, std::memory_order_relaxed); }
+        //true when the last owner let go
+        bool release() noexcept { return owners.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+        std::size_t count() const noexcept { return owners.load(std::memory_order_acquire); }
+    };
+
+    //for vectors whose copies never leave one thread
+    struct local_refcount{
+        std::size_t owners = 1;
+
+        void acquire() noexcept { ++owners; }
+        bool release() noexcept { return --owners == 0; }
+        std::size_t count() const noexcept { return owners; }
+    };
+
+    //Copy-on-write vector: copies share one art::vector through an intrusive reference count, and
+    //the first mutating access of a shared copy clones it. As with Qt containers, the non-const
+    //element accessors and iterators count as mutating, reads go through const access.
+    //Handing out a mutable reference, pointer or iterator marks the elements unshareable, as in
+    //the old libstdc++ COW string: later copies clone them eagerly, so writing through that
+    //reference never shows up in a copy. The mark lasts until clear() or the vector is assigned.
+    template <typename Type, typename Allocator = std::allocator<Type>, typename RefcountPolicy = atomic_refcount>
+    class cow_vector{
+    public:
+        typedef vector<Type, Allocator>                   vector_type;
+        typedef Type                                      value_type;
+        typedef Allocator                                 allocator_type;
+        typedef std::size_t                               size_type;
+        typedef std::ptrdiff_t                            difference_type;
+        typedef value_type&                               reference;
+        typedef const value_type&                         const_reference;
+        typedef typename vector_type::iterator            iterator;
+        typedef typename vector_type::const_iterator      const_iterator;
+
+        explicit cow_vector(const Allocator& alloc = Allocator());
+        explicit cow_vector(size_type size);
+        cow_vector(size_type size, const Type& value, const Allocator& alloc = Allocator());
+        cow_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+        explicit cow_vector(vector_type values);
+
+        //copies share the elements, unless a mutable reference to them was handed out
+        cow_vector(const cow_vector& other);
+        cow_vector(cow_vector&& other) noexcept;
+        ~cow_vector();
+
+        cow_vector& operator=(const cow_vector& other);
+        cow_vector& operator=(cow_vector&& other) noexcept;
+
+        //owners of the elements, 0 for a moved-from vector
+        size_type use_count() const noexcept;
+        bool unique() const noexcept;
+
+        //read access, never clones
+        const vector_type& get() const noexcept;
+        const_reference operator[](size_type pos) const;
+        const_reference at(size_type pos) const;
+        const_reference front() const;
+        const_reference back() const;
+        const Type* data() const noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator cend() const noexcept;
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type capacity() const noexcept;
+
+        //mutating access, clones shared elements first and marks them unshareable
+        vector_type& mutate();
+        reference operator[](size_type pos);
+        reference at(size_type pos);
+        reference front();
+        reference back();
+        Type* data();
+        iterator begin();
+        iterator end();
+
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        template< class... Args >
+        void emplace_back(Args&&... args);
+        void pop_back();
+        iterator insert(const_iterator pos, const Type& value);
+        iterator insert(const_iterator pos, Type&& value);
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+        void resize(size_type count);
+        void reserve(size_type size);
+
+        //drops this copy's reference, other copies keep the elements
+        void clear() noexcept;
+        void swap(cow_vector& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+    private:
+        struct _m_block{
+            template< class... Args >
+            explicit _m_block(Args&&... args) : values(std::forward<Args>(args)...) {}
+
+            RefcountPolicy refs;
+            vector_type values;
+            //a mutable reference escaped, set only while unique
+            bool unshareable = false;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_block> _m_block_allocator;
+        typedef std::allocator_traits<_m_block_allocator> _m_block_traits;
+
+        Allocator _m_allocator;
+        _m_block* _m_shared = nullptr;
+
+        template< class... Args >
+        _m_block* _m_make_block(Args&&... args) const;
+        void _m_release() noexcept;
+        void _m_detach();
+        _m_block* _m_share() const;
+        vector_type& _m_values();
+    };
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    template<class... Args>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::_m_block*
+    cow_vector<Type, Allocator, RefcountPolicy>::_m_make_block(Args&&... args) const {
+        _m_block_allocator block_allocator(_m_allocator);
+        _m_block* block = _m_block_traits::allocate(block_allocator, 1);
+        try {
+            _m_block_traits::construct(block_allocator, block, std::forward<Args>(args)...);
+        } catch (...) {
+            _m_block_traits::deallocate(block_allocator, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::_m_release() noexcept {
+        if (_m_shared && _m_shared->refs.release()) {
+            _m_block_allocator block_allocator(_m_allocator);
+            _m_block_traits::destroy(block_allocator, _m_shared);
+            _m_block_traits::deallocate(block_allocator, _m_shared, 1);
+        }
+        _m_shared = nullptr;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::_m_detach() {
+        if (!_m_shared) _m_shared = _m_make_block(_m_allocator);
+        else if (_m_shared->refs.count() > 1) {
+            _m_block* copy = _m_make_block(_m_shared->values, _m_allocator);
+            _m_release();
+            _m_shared = copy;
+        }
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::_m_block*
+    cow_vector<Type, Allocator, RefcountPolicy>::_m_share() const {
+        if (!_m_shared) return nullptr;
+        if (_m_shared->unshareable) return _m_make_block(_m_shared->values, _m_allocator);
+        _m_shared->refs.acquire();
+        return _m_shared;
+    }
+
+    //internal mutations, they hand nothing out and leave the elements shareable
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::vector_type&
+    cow_vector<Type, Allocator, RefcountPolicy>::_m_values() {
+        _m_detach();
+        return _m_shared->values;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(const Allocator& alloc) : _m_allocator(alloc) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(size_type size) : _m_shared(_m_make_block(size)) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(size_type size, const Type& value, const Allocator& alloc)
+        : _m_allocator(alloc), _m_shared(_m_make_block(size, value, alloc)) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : _m_allocator(alloc), _m_shared(_m_make_block(init, alloc)) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(vector_type values)
+        : _m_allocator(values.get_allocator()), _m_shared(_m_make_block(std::move(values))) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(const cow_vector& other)
+        : _m_allocator(other._m_allocator), _m_shared(other._m_share()) {}
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::cow_vector(cow_vector&& other) noexcept
+        : _m_allocator(other._m_allocator), _m_shared(other._m_shared) {
+        other._m_shared = nullptr;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>::~cow_vector() {
+        _m_release();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>&
+    cow_vector<Type, Allocator, RefcountPolicy>::operator=(const cow_vector& other) {
+        _m_block* shared = other._m_share();
+        _m_release();
+        _m_allocator = other._m_allocator;
+        _m_shared = shared;
+        return *this;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    cow_vector<Type, Allocator, RefcountPolicy>&
+    cow_vector<Type, Allocator, RefcountPolicy>::operator=(cow_vector&& other) noexcept {
+        if (this != &other) {
+            _m_release();
+            _m_allocator = other._m_allocator;
+            _m_shared = other._m_shared;
+            other._m_shared = nullptr;
+        }
+        return *this;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::size_type
+    cow_vector<Type, Allocator, RefcountPolicy>::use_count() const noexcept {
+        return _m_shared ? _m_shared->refs.count() : 0;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    bool cow_vector<Type, Allocator, RefcountPolicy>::unique() const noexcept {
+        return use_count() == 1;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    const typename cow_vector<Type, Allocator, RefcountPolicy>::vector_type&
+    cow_vector<Type, Allocator, RefcountPolicy>::get() const noexcept {
+        static const vector_type empty_values;
+        return _m_shared ? _m_shared->values : empty_values;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_reference
+    cow_vector<Type, Allocator, RefcountPolicy>::operator[](size_type pos) const {
+        return get()[pos];
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_reference
+    cow_vector<Type, Allocator, RefcountPolicy>::at(size_type pos) const {
+        return get().at(pos);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_reference
+    cow_vector<Type, Allocator, RefcountPolicy>::front() const {
+        return get().front();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_reference
+    cow_vector<Type, Allocator, RefcountPolicy>::back() const {
+        return get().back();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    const Type* cow_vector<Type, Allocator, RefcountPolicy>::data() const noexcept {
+        return get().data();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::begin() const noexcept {
+        return get().begin();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::end() const noexcept {
+        return get().end();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::cbegin() const noexcept {
+        return get().cbegin();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::const_iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::cend() const noexcept {
+        return get().cend();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    bool cow_vector<Type, Allocator, RefcountPolicy>::empty() const noexcept {
+        return get().empty();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::size_type
+    cow_vector<Type, Allocator, RefcountPolicy>::size() const noexcept {
+        return get().size();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::size_type
+    cow_vector<Type, Allocator, RefcountPolicy>::capacity() const noexcept {
+        return get().capacity();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::vector_type&
+    cow_vector<Type, Allocator, RefcountPolicy>::mutate() {
+        vector_type& values = _m_values();
+        _m_shared->unshareable = true;
+        return values;
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::reference
+    cow_vector<Type, Allocator, RefcountPolicy>::operator[](size_type pos) {
+        return mutate()[pos];
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::reference
+    cow_vector<Type, Allocator, RefcountPolicy>::at(size_type pos) {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return mutate()[pos];
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::reference
+    cow_vector<Type, Allocator, RefcountPolicy>::front() {
+        return mutate().front();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::reference
+    cow_vector<Type, Allocator, RefcountPolicy>::back() {
+        return mutate().back();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    Type* cow_vector<Type, Allocator, RefcountPolicy>::data() {
+        return mutate().data();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::begin() {
+        return mutate().begin();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::end() {
+        return mutate().end();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::push_back(const Type& value) {
+        _m_values().emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::push_back(Type&& value) {
+        _m_values().push_back(std::move(value));
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    template<class... Args>
+    void cow_vector<Type, Allocator, RefcountPolicy>::emplace_back(Args&&... args) {
+        _m_values().emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::pop_back() {
+        _m_values().pop_back();
+    }
+
+    //positions are taken before cloning, const_iterators may point into the shared elements
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::insert(const_iterator pos, const Type& value) {
+        size_type index = pos - cbegin();
+        vector_type& values = mutate();
+        return values.insert(values.cbegin() + index, value);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::insert(const_iterator pos, Type&& value) {
+        size_type index = pos - cbegin();
+        vector_type& values = mutate();
+        return values.insert(values.cbegin() + index, std::move(value));
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::iterator
+    cow_vector<Type, Allocator, RefcountPolicy>::erase(const_iterator first, const_iterator last) {
+        size_type from = first - cbegin(), to = last - cbegin();
+        vector_type& values = mutate();
+        return values.erase(values.cbegin() + from, values.cbegin() + to);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::resize(size_type count) {
+        _m_values().resize(count);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::reserve(size_type size) {
+        _m_values().reserve(size);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::clear() noexcept {
+        _m_release();
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    void cow_vector<Type, Allocator, RefcountPolicy>::swap(cow_vector& other) noexcept {
+        std::swap(_m_allocator, other._m_allocator);
+        std::swap(_m_shared, other._m_shared);
+    }
+
+    template<typename Type, typename Allocator, typename RefcountPolicy>
+    typename cow_vector<Type, Allocator, RefcountPolicy>::allocator_type
+    cow_vector<Type, Allocator, RefcountPolicy>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template <class Type, class Allocator, class RefcountPolicy>
+    bool operator==(const cow_vector<Type, Allocator, RefcountPolicy>& lhs, const cow_vector<Type, Allocator, RefcountPolicy>& rhs) {
+        return lhs.data() == rhs.data() ? lhs.size() == rhs.size() : lhs.get() == rhs.get();
+    }
+
+    template <class Type, class Allocator, class RefcountPolicy>
+    bool operator!=(const cow_vector<Type, Allocator, RefcountPolicy>& lhs, const cow_vector<Type, Allocator, RefcountPolicy>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,462 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //bytes group varint needs for value, 1 to 4
+        inline unsigned varint_length32(std::uint32_t value) noexcept {
+            return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+        }
+
+#if defined(__SSSE3__)
+        //pshufb masks spreading the data bytes of a group with a given tag into four 32 bit lanes
+        struct group_varint_shuffles{
+            alignas(16) std::uint8_t masks[256][16];
+
+            group_varint_shuffles() noexcept {
+                for (unsigned tag = 0; tag < 256; ++tag) {
+                    unsigned source = 0;
+                    for (unsigned lane = 0; lane < 4; ++lane) {
+                        unsigned length = ((tag >> (2 * lane)) & 3) + 1;
+                        for (unsigned byte = 0; byte < 4; ++byte) {
+                            masks[tag][lane * 4 + byte] = byte < length ? std::uint8_t(source + byte) : 0x80;
+                        }
+                        source += length;
+                    }
+                }
+            }
+        };
+
+        inline const group_varint_shuffles& group_varint_table() noexcept {
+            static const group_varint_shuffles table;
+            return table;
+        }
+#endif
+
+        //decodes the group at in, writes previous plus the running sum of its deltas to out and
+        //returns the end of the group; 16 bytes past in + 1 must be readable
+        inline const std::uint8_t* decode_delta_group(const std::uint8_t* in, std::uint32_t previous, std::uint32_t* out) noexcept {
+            unsigned tag = in[0];
+            unsigned length = 4 + (tag & 3) + ((tag >> 2) & 3) + ((tag >> 4) & 3) + ((tag >> 6) & 3);
+#if defined(__SSSE3__)
+            __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 1));
+            __m128i deltas = _mm_shuffle_epi8(data, _mm_load_si128(reinterpret_cast<const __m128i*>(group_varint_table().masks[tag])));
+            deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 4));
+            deltas = _mm_add_epi32(deltas, _mm_slli_si128(deltas, 8));
+            deltas = _mm_add_epi32(deltas, _mm_set1_epi32(int(previous)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), deltas);
+#else
+            const std::uint8_t* data = in + 1;
+            for (unsigned lane = 0; lane < 4; ++lane) {
+                unsigned bytes = ((tag >> (2 * lane)) & 3) + 1;
+                std::uint32_t delta = 0;
+                for (unsigned byte = 0; byte < bytes; ++byte) delta |= std::uint32_t(data[byte]) << (8 * byte);
+                data += bytes;
+                previous += delta;
+                out[lane] = previous;
+            }
+#endif
+            return in + 1 + length;
+        }
+    }
+
+    //Sorted uint32 sequence stored as group varint deltas: four deltas share a tag byte holding
+    //their byte lengths, so a group decodes with one table driven shuffle and a prefix sum (SSSE3,
+    //with a scalar fallback). Every SKIP_INTERVAL values a skip entry records the absolute value and
+    //byte offset where a fresh delta chain starts, which lets lower_bound and iterator seek jump over
+    //whole runs without decoding them. Intersection and union walk the encoded forms with seeking
+    //iterators and never decompress the inputs.
+    template <typename Allocator = std::allocator<std::uint32_t>>
+    class basic_delta_vector{
+    public:
+        typedef std::uint32_t                                                                 value_type;
+        typedef Allocator                                                                     allocator_type;
+        typedef std::size_t                                                                   size_type;
+        typedef std::ptrdiff_t                                                                difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>  value_allocator;
+        typedef vector<value_type, value_allocator>                                           unpacked_type;
+
+        static const size_type GROUP_SIZE = 4;
+        static const size_type SKIP_INTERVAL = 128;
+
+        //forward iterator decoding one group at a time
+        class const_iterator : public std::iterator<std::forward_iterator_tag, value_type, difference_type, const value_type*, value_type> {
+        public:
+            typedef value_type reference;
+
+            const_iterator() noexcept : _m_owner(nullptr), _m_index(0), _m_next(nullptr) {}
+
+            value_type operator*() const noexcept {return _m_group[_m_index % GROUP_SIZE];}
+            const_iterator& operator++() noexcept;
+            const_iterator operator++(int) noexcept {const_iterator tmp(*this); ++*this; return tmp;}
+            //advances to the first value not less than target, jumping through skip entries
+            const_iterator& seek(value_type target) noexcept;
+            size_type index() const noexcept {return _m_index;}
+
+            friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) noexcept {return lhs._m_index == rhs._m_index;}
+            friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) noexcept {return lhs._m_index != rhs._m_index;}
+
+        private:
+            friend class basic_delta_vector;
+            const_iterator(const basic_delta_vector* owner, size_type index) noexcept;
+
+            //decodes the group starting at _m_index
+            void _m_load() noexcept;
+
+            const basic_delta_vector* _m_owner;
+            size_type _m_index;
+            const std::uint8_t* _m_next;
+            value_type _m_group[GROUP_SIZE];
+        };
+        typedef const_iterator iterator;
+
+        // construct/copy/destroy
+        explicit basic_delta_vector(const Allocator& alloc = Allocator());
+        //the values must be sorted
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        basic_delta_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        basic_delta_vector(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+        explicit basic_delta_vector(const unpacked_type& sorted);
+
+        allocator_type get_allocator() const;
+
+        //decodes up to SKIP_INTERVAL values
+        value_type at(size_type pos) const;
+        value_type front() const;
+        value_type back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        //first value not less than value
+        const_iterator lower_bound(value_type value) const noexcept;
+        bool contains(value_type value) const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        //encoded bytes plus skip entries and the unencoded last group
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        void clear() noexcept;
+        //value must not be less than back()
+        void push_back(value_type value);
+        void swap(basic_delta_vector& other) noexcept;
+
+        unpacked_type to_vector() const;
+
+        template <class A>
+        friend bool operator==(const basic_delta_vector<A>& lhs, const basic_delta_vector<A>& rhs);
+
+    private:
+        struct _m_skip{
+            value_type first;
+            std::uint32_t offset;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t> _m_byte_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_skip> _m_skip_allocator;
+
+        //zero bytes kept after the encoded groups so a group decode may load 16 bytes
+        static const size_type _m_PADDING = 16;
+
+        //encoded groups followed by _m_PADDING zero bytes
+        vector<std::uint8_t, _m_byte_allocator> _m_bytes;
+        vector<_m_skip, _m_skip_allocator> _m_skips;
+        //the last, incomplete group as absolute values
+        value_type _m_pending[GROUP_SIZE];
+        size_type _m_size = 0;
+        value_type _m_last = 0;
+        //last value of the last encoded group
+        value_type _m_previous_group_last = 0;
+
+        size_type _m_encoded() const noexcept {return _m_size / GROUP_SIZE * GROUP_SIZE;}
+        size_type _m_used() const noexcept {return _m_bytes.size() - _m_PADDING;}
+        void _m_encode_group(value_type previous);
+    };
+
+    typedef basic_delta_vector<> delta_vector;
+
+    template <typename Allocator> const typename basic_delta_vector<Allocator>::size_type basic_delta_vector<Allocator>::GROUP_SIZE;
+    template <typename Allocator> const typename basic_delta_vector<Allocator>::size_type basic_delta_vector<Allocator>::SKIP_INTERVAL;
+    template <typename Allocator> const typename basic_delta_vector<Allocator>::size_type basic_delta_vector<Allocator>::_m_PADDING;
+
+    template<typename Allocator>
+    basic_delta_vector<Allocator>::const_iterator::const_iterator(const basic_delta_vector* owner, size_type index) noexcept
+        : _m_owner(owner), _m_index(index), _m_next(nullptr) {
+        if (_m_index < _m_owner->_m_size) _m_load();
+    }
+
+    //a group at a skip boundary restarts its delta chain from the skip entry's value
+    template<typename Allocator>
+    void basic_delta_vector<Allocator>::const_iterator::_m_load() noexcept {
+        const basic_delta_vector& owner = *_m_owner;
+        if (_m_index >= owner._m_encoded()) {
+            std::copy(owner._m_pending, owner._m_pending + GROUP_SIZE, _m_group);
+            return;
+        }
+        value_type previous = _m_group[GROUP_SIZE - 1];
+        if (_m_index % SKIP_INTERVAL == 0) {
+            const _m_skip& skip = owner._m_skips[_m_index / SKIP_INTERVAL];
+            _m_next = owner._m_bytes.data() + skip.offset;
+            previous = skip.first;
+        }
+        _m_next = detail::decode_delta_group(_m_next, previous, _m_group);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator& basic_delta_vector<Allocator>::const_iterator::operator++() noexcept {
+        ++_m_index;
+        if (_m_index % GROUP_SIZE == 0 && _m_index < _m_owner->_m_size) _m_load();
+        return *this;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator& basic_delta_vector<Allocator>::const_iterator::seek(value_type target) noexcept {
+        const basic_delta_vector& owner = *_m_owner;
+        if (_m_index >= owner._m_size || **this >= target) return *this;
+        //last skip entry starting below target; one starting at target may follow equal values at the
+        //end of the chunk before it. It is never behind the current chunk, whose first value is below target
+        auto skip = std::lower_bound(owner._m_skips.begin() + _m_index / SKIP_INTERVAL, owner._m_skips.end(), target,
+                                     [](const _m_skip& entry, value_type value) { return entry.first < value; }) - 1;
+        size_type chunk = size_type(skip - owner._m_skips.begin());
+        if (chunk > _m_index / SKIP_INTERVAL) {
+            _m_index = chunk * SKIP_INTERVAL;
+            _m_load();
+        }
+        //whole groups below target are skipped by their last value
+        while (_m_index < owner._m_size) {
+            size_type group_end = std::min(_m_index / GROUP_SIZE * GROUP_SIZE + GROUP_SIZE, owner._m_size);
+            if (_m_group[(group_end - 1) % GROUP_SIZE] < target) {
+                _m_index = group_end;
+                if (_m_index < owner._m_size) _m_load();
+                continue;
+            }
+            while (**this < target) ++_m_index;
+            break;
+        }
+        return *this;
+    }
+
+    template<typename Allocator>
+    void basic_delta_vector<Allocator>::_m_encode_group(value_type previous) {
+        size_type used = _m_used();
+        _m_bytes.resize(used + 1 + 4 * GROUP_SIZE + _m_PADDING);
+        std::uint8_t* out = _m_bytes.data() + used;
+        std::uint8_t* data = out + 1;
+        unsigned tag = 0;
+        for (size_type lane = 0; lane < GROUP_SIZE; ++lane) {
+            value_type delta = _m_pending[lane] - previous;
+            previous = _m_pending[lane];
+            unsigned length = detail::varint_length32(delta);
+            tag |= (length - 1) << (2 * lane);
+            for (unsigned byte = 0; byte < length; ++byte) *data++ = std::uint8_t(delta >> (8 * byte));
+        }
+        *out = std::uint8_t(tag);
+        size_type new_used = size_type(data - _m_bytes.data());
+        std::fill(_m_bytes.data() + new_used, _m_bytes.data() + _m_bytes.size(), std::uint8_t(0));
+        _m_bytes.erase(_m_bytes.begin() + new_used + _m_PADDING, _m_bytes.end());
+    }
+
+    template<typename Allocator>
+    basic_delta_vector<Allocator>::basic_delta_vector(const Allocator& alloc)
+        : _m_bytes(_m_PADDING, std::uint8_t(0), _m_byte_allocator(alloc)), _m_skips(_m_skip_allocator(alloc)) {}
+
+    template<typename Allocator>
+    template<class InputIt, class>
+    basic_delta_vector<Allocator>::basic_delta_vector(InputIt first, InputIt last, const Allocator& alloc)
+        : basic_delta_vector(alloc) {
+        for (; first != last; ++first) push_back(value_type(*first));
+    }
+
+    template<typename Allocator>
+    basic_delta_vector<Allocator>::basic_delta_vector(std::initializer_list<value_type> init, const Allocator& alloc)
+        : basic_delta_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Allocator>
+    basic_delta_vector<Allocator>::basic_delta_vector(const unpacked_type& sorted)
+        : basic_delta_vector(sorted.begin(), sorted.end(), allocator_type(sorted.get_allocator())) {}
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::allocator_type basic_delta_vector<Allocator>::get_allocator() const {
+        return allocator_type(_m_bytes.get_allocator());
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::value_type basic_delta_vector<Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        const_iterator it(this, pos / SKIP_INTERVAL * SKIP_INTERVAL);
+        while (it.index() != pos) ++it;
+        return *it;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::value_type basic_delta_vector<Allocator>::front() const {
+        return _m_skips[0].first;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::value_type basic_delta_vector<Allocator>::back() const {
+        return _m_last;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator basic_delta_vector<Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator basic_delta_vector<Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator basic_delta_vector<Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator basic_delta_vector<Allocator>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::const_iterator basic_delta_vector<Allocator>::lower_bound(value_type value) const noexcept {
+        return begin().seek(value);
+    }
+
+    template<typename Allocator>
+    bool basic_delta_vector<Allocator>::contains(value_type value) const noexcept {
+        const_iterator it = lower_bound(value);
+        return it != end() && *it == value;
+    }
+
+    template<typename Allocator>
+    bool basic_delta_vector<Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::size_type basic_delta_vector<Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::size_type basic_delta_vector<Allocator>::memory_bytes() const noexcept {
+        return _m_bytes.size() + _m_skips.size() * sizeof(_m_skip) + sizeof(_m_pending);
+    }
+
+    template<typename Allocator>
+    void basic_delta_vector<Allocator>::clear() noexcept {
+        _m_bytes.erase(_m_bytes.begin() + _m_PADDING, _m_bytes.end());
+        std::fill(_m_bytes.begin(), _m_bytes.end(), std::uint8_t(0));
+        _m_skips.erase(_m_skips.begin(), _m_skips.end());
+        _m_size = 0;
+        _m_last = 0;
+        _m_previous_group_last = 0;
+    }
+
+    template<typename Allocator>
+    void basic_delta_vector<Allocator>::push_back(value_type value) {
+        if (_m_size && value < _m_last) throw std::invalid_argument("delta_vector values must be sorted");
+        if (_m_size % SKIP_INTERVAL == 0) {
+            if (_m_used() > std::numeric_limits<std::uint32_t>::max()) throw std::length_error("delta_vector too large");
+            _m_skips.emplace_back(_m_skip{value, std::uint32_t(_m_used())});
+        }
+        _m_pending[_m_size % GROUP_SIZE] = value;
+        ++_m_size;
+        _m_last = value;
+        if (_m_size % GROUP_SIZE == 0) {
+            size_type first = _m_size - GROUP_SIZE;
+            //the first group of a chunk is relative to the skip value, which it starts with
+            value_type previous = first % SKIP_INTERVAL == 0 ? _m_pending[0] : _m_previous_group_last;
+            _m_encode_group(previous);
+            _m_previous_group_last = value;
+        }
+    }
+
+    template<typename Allocator>
+    void basic_delta_vector<Allocator>::swap(basic_delta_vector& other) noexcept {
+        _m_bytes.swap(other._m_bytes);
+        _m_skips.swap(other._m_skips);
+        std::swap(_m_pending, other._m_pending);
+        std::swap(_m_size, other._m_size);
+        std::swap(_m_last, other._m_last);
+        std::swap(_m_previous_group_last, other._m_previous_group_last);
+    }
+
+    template<typename Allocator>
+    typename basic_delta_vector<Allocator>::unpacked_type basic_delta_vector<Allocator>::to_vector() const {
+        unpacked_type values(value_allocator(_m_bytes.get_allocator()));
+        values.reserve(_m_size);
+        for (value_type value : *this) values.emplace_back(value);
+        return values;
+    }
+
+    template <class Allocator>
+    bool operator==(const basic_delta_vector<Allocator>& lhs, const basic_delta_vector<Allocator>& rhs) {
+        return lhs._m_size == rhs._m_size && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Allocator>
+    bool operator!=(const basic_delta_vector<Allocator>& lhs, const basic_delta_vector<Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    //values present in both, each kept as often as it occurs in both like std::set_intersection;
+    //whichever side is behind seeks to the other, so long gaps on either side are skipped undecoded
+    template <class Allocator>
+    basic_delta_vector<Allocator> set_intersection(const basic_delta_vector<Allocator>& lhs, const basic_delta_vector<Allocator>& rhs) {
+        basic_delta_vector<Allocator> result(lhs.get_allocator());
+        auto a = lhs.begin(), a_end = lhs.end();
+        auto b = rhs.begin(), b_end = rhs.end();
+        while (a != a_end && b != b_end) {
+            if (*a < *b) a.seek(*b);
+            else if (*b < *a) b.seek(*a);
+            else {
+                result.push_back(*a);
+                ++a;
+                ++b;
+            }
+        }
+        return result;
+    }
+
+    //values present in either, like std::set_union
+    template <class Allocator>
+    basic_delta_vector<Allocator> set_union(const basic_delta_vector<Allocator>& lhs, const basic_delta_vector<Allocator>& rhs) {
+        basic_delta_vector<Allocator> result(lhs.get_allocator());
+        auto a = lhs.begin(), a_end = lhs.end();
+        auto b = rhs.begin(), b_end = rhs.end();
+        while (a != a_end && b != b_end) {
+            if (*a < *b) result.push_back(*a++);
+            else if (*b < *a) result.push_back(*b++);
+            else {
+                result.push_back(*a);
+                ++a;
+                ++b;
+            }
+        }
+        for (; a != a_end; ++a) result.push_back(*a);
+        for (; b != b_end; ++b) result.push_back(*b);
+        return result;
+    }
+}
@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "bit_vector.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Dictionary encoded vector for columns with few distinct values: each distinct value is stored
+    //once and every element is a code indexing it. Codes are 1 byte wide while the dictionary fits,
+    //and widen to 2 and then 4 bytes as it grows. Element access decodes through the dictionary;
+    //filters and group counts evaluate the predicate once per distinct value and then scan only the
+    //narrow codes, a loop specialized for each code width.
+    template <typename Type, typename Hash = std::hash<Type>, typename Allocator = std::allocator<Type>>
+    class dict_vector{
+    public:
+        typedef Type                                                                             value_type;
+        typedef Allocator                                                                        allocator_type;
+        typedef const value_type&                                                                const_reference;
+        typedef const value_type&                                                                reference;
+        typedef std::size_t                                                                      size_type;
+        typedef std::ptrdiff_t                                                                   difference_type;
+        typedef std::uint32_t                                                                    code_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t>  mask_allocator;
+        typedef basic_bit_vector<mask_allocator>                                                 mask_type;
+
+        static const code_type npos = code_type(-1);
+
+        typedef detail::index_iterator<const dict_vector, const Type&> const_iterator;
+        typedef const_iterator                                         iterator;
+
+        // construct/copy/destroy
+        explicit dict_vector(const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        dict_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        dict_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+
+        allocator_type get_allocator() const;
+
+        const_reference operator[](size_type pos) const;
+        const_reference at(size_type pos) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        void reserve(size_type count);
+        //bytes per code, 1, 2 or 4
+        unsigned code_width() const noexcept;
+        //code array plus dictionary values, not counting memory the values own
+        size_type memory_bytes() const noexcept;
+
+        // dictionary
+        //distinct values, indexed by code in order of first appearance
+        const vector<Type, Allocator>& dictionary() const noexcept;
+        code_type code(size_type pos) const;
+        //code of value, npos if it does not occur
+        code_type find_code(const Type& value) const;
+
+        // modifiers
+        void clear() noexcept;
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        void pop_back();
+        //replaces element pos, the old value stays in the dictionary
+        void set(size_type pos, const Type& value);
+        void swap(dict_vector& other) noexcept;
+
+        // code scans
+        //bit i is set when element i equals value
+        mask_type equal_mask(const Type& value) const;
+        //bit i is set when pred(element i); pred runs once per distinct value
+        template <typename Predicate>
+        mask_type filter(Predicate pred) const;
+        size_type count(const Type& value) const;
+        //occurrences of each dictionary entry, indexed by code
+        vector<size_type> group_counts() const;
+        //calls fn(pos, code) for every element, in order
+        template <typename Function>
+        void for_each_code(Function fn) const;
+
+    private:
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint8_t> _m_byte_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::pair<const Type, code_type>> _m_index_allocator;
+
+        vector<Type, Allocator> _m_dictionary;
+        std::unordered_map<Type, code_type, Hash, std::equal_to<Type>, _m_index_allocator> _m_index;
+        //size() codes of _m_width bytes each
+        vector<std::uint8_t, _m_byte_allocator> _m_codes;
+        unsigned _m_width = 1;
+        size_type _m_size = 0;
+
+        //code of value, added to the dictionary if new
+        code_type _m_intern(const Type& value);
+        code_type _m_intern(Type&& value);
+        //indexes the value just appended to the dictionary, removes it again on failure
+        code_type _m_index_last();
+        //re-encodes the codes once the dictionary outgrows their width
+        void _m_widen();
+        void _m_store(size_type pos, code_type code) noexcept;
+
+        //calls fn(codes) with the code array typed for the current width
+        template <typename Function>
+        void _m_visit(Function fn) const;
+        //sets bit i of words when test(i), one word per 64 elements
+        template <typename Test>
+        void _m_build_mask(std::uint64_t* words, Test test) const;
+    };
+
+    template <typename Type, typename Hash, typename Allocator>
+    const typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::npos;
+
+    template<typename Type, typename Hash, typename Allocator>
+    template<typename Function>
+    void dict_vector<Type, Hash, Allocator>::_m_visit(Function fn) const {
+        const std::uint8_t* codes = _m_codes.data();
+        switch (_m_width) {
+            case 1: fn(codes); break;
+            case 2: fn(reinterpret_cast<const std::uint16_t*>(codes)); break;
+            default: fn(reinterpret_cast<const std::uint32_t*>(codes)); break;
+        }
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    template<typename Test>
+    void dict_vector<Type, Hash, Allocator>::_m_build_mask(std::uint64_t* words, Test test) const {
+        //a fixed trip count lets the compiler turn full words into vector compares
+        size_type full = _m_size / 64;
+        for (size_type w = 0; w < full; ++w) {
+            std::uint64_t word = 0;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 64
+#endif
+            for (unsigned i = 0; i < 64; ++i) word |= std::uint64_t(test(w * 64 + i)) << i;
+            words[w] = word;
+        }
+        std::uint64_t word = 0;
+        for (size_type i = full * 64; i < _m_size; ++i) word |= std::uint64_t(test(i)) << (i % 64);
+        if (_m_size % 64) words[full] = word;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::_m_store(size_type pos, code_type code) noexcept {
+        std::uint8_t* codes = _m_codes.data();
+        switch (_m_width) {
+            case 1: codes[pos] = std::uint8_t(code); break;
+            case 2: reinterpret_cast<std::uint16_t*>(codes)[pos] = std::uint16_t(code); break;
+            default: reinterpret_cast<std::uint32_t*>(codes)[pos] = code; break;
+        }
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::_m_widen() {
+        size_type distinct = _m_dictionary.size();
+        unsigned width = distinct <= (size_type(1) << 8) ? 1 : distinct <= (size_type(1) << 16) ? 2 : 4;
+        if (width <= _m_width) return;
+        vector<std::uint8_t, _m_byte_allocator> codes(_m_codes.get_allocator());
+        codes.reserve(std::max(_m_codes.capacity() / _m_width, _m_size + 1) * width);
+        codes.resize(_m_size * width);
+        std::uint8_t* out = codes.data();
+        _m_visit([&](const auto* in) {
+            for (size_type i = 0; i < _m_size; ++i) {
+                if (width == 2) reinterpret_cast<std::uint16_t*>(out)[i] = std::uint16_t(in[i]);
+                else reinterpret_cast<std::uint32_t*>(out)[i] = std::uint32_t(in[i]);
+            }
+        });
+        _m_codes.swap(codes);
+        _m_width = width;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::_m_intern(const Type& value) {
+        auto found = _m_index.find(value);
+        if (found != _m_index.end()) return found->second;
+        _m_dictionary.emplace_back(value);
+        return _m_index_last();
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::_m_intern(Type&& value) {
+        auto found = _m_index.find(value);
+        if (found != _m_index.end()) return found->second;
+        _m_dictionary.emplace_back(std::move(value));
+        return _m_index_last();
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::_m_index_last() {
+        code_type code = code_type(_m_dictionary.size() - 1);
+        try {
+            auto added = _m_index.emplace(_m_dictionary.back(), code).first;
+            try {
+                _m_widen();
+            } catch (...) {
+                _m_index.erase(added);
+                throw;
+            }
+        } catch (...) {
+            _m_dictionary.pop_back();
+            throw;
+        }
+        return code;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    dict_vector<Type, Hash, Allocator>::dict_vector(const Allocator& alloc)
+        : _m_dictionary(alloc), _m_index(0, Hash(), std::equal_to<Type>(), _m_index_allocator(alloc)), _m_codes(_m_byte_allocator(alloc)) {}
+
+    template<typename Type, typename Hash, typename Allocator>
+    template<class InputIt, class>
+    dict_vector<Type, Hash, Allocator>::dict_vector(InputIt first, InputIt last, const Allocator& alloc) : dict_vector(alloc) {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    dict_vector<Type, Hash, Allocator>::dict_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : dict_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::allocator_type dict_vector<Type, Hash, Allocator>::get_allocator() const {
+        return _m_dictionary.get_allocator();
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_reference dict_vector<Type, Hash, Allocator>::operator[](size_type pos) const {
+        return _m_dictionary[code(pos)];
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_reference dict_vector<Type, Hash, Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_reference dict_vector<Type, Hash, Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_reference dict_vector<Type, Hash, Allocator>::back() const {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_iterator dict_vector<Type, Hash, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_iterator dict_vector<Type, Hash, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_iterator dict_vector<Type, Hash, Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::const_iterator dict_vector<Type, Hash, Allocator>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    bool dict_vector<Type, Hash, Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::size_type dict_vector<Type, Hash, Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::reserve(size_type count) {
+        _m_codes.reserve(count * _m_width);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    unsigned dict_vector<Type, Hash, Allocator>::code_width() const noexcept {
+        return _m_width;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::size_type dict_vector<Type, Hash, Allocator>::memory_bytes() const noexcept {
+        return _m_codes.size() + _m_dictionary.size() * sizeof(Type);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    const vector<Type, Allocator>& dict_vector<Type, Hash, Allocator>::dictionary() const noexcept {
+        return _m_dictionary;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::code(size_type pos) const {
+        const std::uint8_t* codes = _m_codes.data();
+        switch (_m_width) {
+            case 1: return codes[pos];
+            case 2: return reinterpret_cast<const std::uint16_t*>(codes)[pos];
+            default: return reinterpret_cast<const std::uint32_t*>(codes)[pos];
+        }
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::code_type dict_vector<Type, Hash, Allocator>::find_code(const Type& value) const {
+        auto found = _m_index.find(value);
+        return found == _m_index.end() ? npos : found->second;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::clear() noexcept {
+        _m_dictionary.clear();
+        _m_index.clear();
+        _m_codes.clear();
+        _m_width = 1;
+        _m_size = 0;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::push_back(const Type& value) {
+        code_type code = _m_intern(value);
+        _m_codes.resize((_m_size + 1) * _m_width);
+        _m_store(_m_size++, code);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::push_back(Type&& value) {
+        code_type code = _m_intern(std::move(value));
+        _m_codes.resize((_m_size + 1) * _m_width);
+        _m_store(_m_size++, code);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::pop_back() {
+        --_m_size;
+        _m_codes.erase(_m_codes.begin() + _m_size * _m_width, _m_codes.end());
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::set(size_type pos, const Type& value) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        code_type code = _m_intern(value);
+        _m_store(pos, code);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    void dict_vector<Type, Hash, Allocator>::swap(dict_vector& other) noexcept {
+        _m_dictionary.swap(other._m_dictionary);
+        _m_index.swap(other._m_index);
+        _m_codes.swap(other._m_codes);
+        std::swap(_m_width, other._m_width);
+        std::swap(_m_size, other._m_size);
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::mask_type dict_vector<Type, Hash, Allocator>::equal_mask(const Type& value) const {
+        code_type wanted = find_code(value);
+        mask_type mask(_m_size, false, mask_allocator(_m_dictionary.get_allocator()));
+        if (wanted == npos) return mask;
+        std::uint64_t* words = mask.words().data();
+        _m_visit([&](const auto* codes) {
+            _m_build_mask(words, [&](size_type i) {return codes[i] == wanted;});
+        });
+        return mask;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    template<typename Predicate>
+    typename dict_vector<Type, Hash, Allocator>::mask_type dict_vector<Type, Hash, Allocator>::filter(Predicate pred) const {
+        vector<std::uint8_t> accepted(_m_dictionary.size(), std::uint8_t(0));
+        for (size_type code = 0; code < _m_dictionary.size(); ++code) accepted[code] = pred(_m_dictionary[code]) ? 1 : 0;
+        mask_type mask(_m_size, false, mask_allocator(_m_dictionary.get_allocator()));
+        std::uint64_t* words = mask.words().data();
+        const std::uint8_t* table = accepted.data();
+        _m_visit([&](const auto* codes) {
+            _m_build_mask(words, [&](size_type i) {return table[codes[i]] != 0;});
+        });
+        return mask;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    typename dict_vector<Type, Hash, Allocator>::size_type dict_vector<Type, Hash, Allocator>::count(const Type& value) const {
+        code_type wanted = find_code(value);
+        if (wanted == npos) return 0;
+        size_type matches = 0;
+        _m_visit([&](const auto* codes) {
+            for (size_type i = 0; i < _m_size; ++i) matches += codes[i] == wanted;
+        });
+        return matches;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    vector<typename dict_vector<Type, Hash, Allocator>::size_type> dict_vector<Type, Hash, Allocator>::group_counts() const {
+        vector<size_type> counts(_m_dictionary.size(), size_type(0));
+        size_type* out = counts.data();
+        _m_visit([&](const auto* codes) {
+            for (size_type i = 0; i < _m_size; ++i) ++out[codes[i]];
+        });
+        return counts;
+    }
+
+    template<typename Type, typename Hash, typename Allocator>
+    template<typename Function>
+    void dict_vector<Type, Hash, Allocator>::for_each_code(Function fn) const {
+        _m_visit([&](const auto* codes) {
+            for (size_type i = 0; i < _m_size; ++i) fn(i, code_type(codes[i]));
+        });
+    }
+
+    template <class Type, class Hash, class Allocator>
+    bool operator==(const dict_vector<Type, Hash, Allocator>& lhs, const dict_vector<Type, Hash, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Type, class Hash, class Allocator>
+    bool operator!=(const dict_vector<Type, Hash, Allocator>& lhs, const dict_vector<Type, Hash, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
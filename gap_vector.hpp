@@ -0,0 +1,570 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth_policy.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Gap buffer: one allocation holding [elements before the gap][gap][elements after the gap]. The
+    //gap stays where the last edit happened, so inserting or erasing next to it is O(1) amortized and
+    //an edit k positions away moves only k elements. Capacity grows through growth_policy exactly as
+    //art::vector does. Iteration skips the gap; data() is contiguous only after compact().
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class gap_vector{
+    public:
+        typedef Type                                                     value_type;
+        typedef Allocator                                                allocator_type;
+        typedef value_type&                                              reference;
+        typedef const value_type&                                        const_reference;
+        typedef std::ptrdiff_t                                           difference_type;
+        typedef std::size_t                                              size_type;
+        typedef typename std::allocator_traits<Allocator>::pointer       pointer;
+        typedef typename std::allocator_traits<Allocator>::const_pointer const_pointer;
+
+        typedef detail::index_iterator<gap_vector, Type&>             iterator;
+        typedef detail::index_iterator<const gap_vector, const Type&> const_iterator;
+        typedef typename std::reverse_iterator<iterator>              reverse_iterator;
+        typedef typename std::reverse_iterator<const_iterator>        const_reverse_iterator;
+
+        // construct/copy/destroy
+        explicit gap_vector(const Allocator& alloc = Allocator());
+        explicit gap_vector(size_type size, const Allocator& alloc = Allocator());
+        gap_vector(size_type size, const Type& value, const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        gap_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        gap_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+        gap_vector(const gap_vector& other);
+        gap_vector(gap_vector&& other) noexcept;
+        ~gap_vector();
+
+        gap_vector& operator=(const gap_vector& other);
+        gap_vector& operator=(gap_vector&& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+        reference       at(size_type pos);
+        const_reference at(size_type pos) const;
+        reference       operator[](size_type pos);
+        const_reference operator[](size_type pos) const;
+        reference       front();
+        const_reference front() const;
+        reference       back();
+        const_reference back() const;
+
+        //moves the gap to the end and returns the now contiguous elements
+        pointer compact();
+        //contiguous only while is_compact()
+        pointer data() noexcept;
+        const_pointer data() const noexcept;
+        bool is_compact() const noexcept;
+        //index of the first element after the gap, where the next cheap insert goes
+        size_type gap_position() const noexcept;
+
+        iterator                begin() noexcept;
+        const_iterator          begin() const noexcept;
+        const_iterator          cbegin() const noexcept;
+        iterator                end() noexcept;
+        const_iterator          end() const noexcept;
+        const_iterator          cend() const noexcept;
+        reverse_iterator        rbegin() noexcept;
+        const_reverse_iterator  rbegin() const noexcept;
+        reverse_iterator        rend() noexcept;
+        const_reverse_iterator  rend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+        void reserve(size_type new_cap);
+        size_type capacity() const noexcept;
+        void shrink_to_fit();
+
+        // modifiers
+        void clear() noexcept;
+
+        iterator insert(const_iterator pos, const Type& value);
+        iterator insert(const_iterator pos, Type&& value);
+        iterator insert(const_iterator pos, size_type count, const Type& value);
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        iterator insert(const_iterator pos, InputIt first, InputIt last);
+        template< class... Args >
+        iterator emplace(const_iterator pos, Args&&... args);
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        template< class... Args >
+        reference emplace_back(Args&&... args);
+        void pop_back();
+
+        void resize(size_type count);
+        void resize(size_type count, const value_type& value);
+
+        void swap(gap_vector& other) noexcept;
+
+    private:
+        Allocator _m_allocator;
+        pointer _m_first = nullptr;
+        pointer _m_gap_begin = nullptr;
+        pointer _m_gap_end = nullptr;
+        pointer _m_end_of_capacity = nullptr;
+
+        size_type _m_gap() const noexcept {return size_type(_m_gap_end - _m_gap_begin);}
+        //moves the gap so that it starts at index pos
+        void _m_move_gap(size_type pos);
+        //reallocates to new_capacity keeping the gap at the same index
+        void _m_reallocate(size_type new_capacity);
+        void _m_grow(size_type need_size);
+        void _m_destroy_all() noexcept;
+
+        //move n elements from source to destination, which may overlap
+        static void _m_relocate(Allocator& alloc, pointer destination, pointer source, size_type n, std::true_type);
+        static void _m_relocate(Allocator& alloc, pointer destination, pointer source, size_type n, std::false_type);
+    };
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_relocate(Allocator&, pointer destination, pointer source, size_type n, std::true_type) {
+        if (n) std::memmove(static_cast<void*>(destination), static_cast<const void*>(source), n * sizeof(Type));
+    }
+
+    //destination slots are unconstructed or were moved from earlier in the same loop
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_relocate(Allocator& alloc, pointer destination, pointer source, size_type n, std::false_type) {
+        if (destination < source) {
+            for (size_type i = 0; i < n; ++i) {
+                std::allocator_traits<Allocator>::construct(alloc, destination + i, std::move(source[i]));
+                std::allocator_traits<Allocator>::destroy(alloc, source + i);
+            }
+        } else {
+            for (size_type i = n; i-- > 0;) {
+                std::allocator_traits<Allocator>::construct(alloc, destination + i, std::move(source[i]));
+                std::allocator_traits<Allocator>::destroy(alloc, source + i);
+            }
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_move_gap(size_type pos) {
+        size_type gap_index = size_type(_m_gap_begin - _m_first);
+        size_type gap = _m_gap();
+        if (pos == gap_index) return;
+        if (gap == 0) {
+            _m_gap_begin = _m_gap_end = _m_first + pos;
+            return;
+        }
+        if (pos < gap_index) {
+            size_type n = gap_index - pos;
+            _m_relocate(_m_allocator, _m_gap_end - n, _m_first + pos, n, std::is_trivially_copyable<Type>());
+        } else {
+            size_type n = pos - gap_index;
+            _m_relocate(_m_allocator, _m_gap_begin, _m_gap_end, n, std::is_trivially_copyable<Type>());
+        }
+        _m_gap_begin = _m_first + pos;
+        _m_gap_end = _m_gap_begin + gap;
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_reallocate(size_type new_capacity) {
+        size_type before = size_type(_m_gap_begin - _m_first);
+        size_type after = size_type(_m_end_of_capacity - _m_gap_end);
+        pointer new_first = new_capacity ? std::allocator_traits<Allocator>::allocate(_m_allocator, new_capacity) : nullptr;
+        pointer new_end = new_first + new_capacity;
+        _m_relocate(_m_allocator, new_first, _m_first, before, std::is_trivially_copyable<Type>());
+        _m_relocate(_m_allocator, new_end - after, _m_gap_end, after, std::is_trivially_copyable<Type>());
+        if (_m_first) std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_first, capacity());
+        _m_first = new_first;
+        _m_gap_begin = new_first + before;
+        _m_gap_end = new_end - after;
+        _m_end_of_capacity = new_end;
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_grow(size_type need_size) {
+        if (need_size > capacity()) _m_reallocate(growth_policy<Type>::next_capacity(capacity(), need_size));
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::_m_destroy_all() noexcept {
+        for (pointer p = _m_first; p != _m_gap_begin; ++p) std::allocator_traits<Allocator>::destroy(_m_allocator, p);
+        for (pointer p = _m_gap_end; p != _m_end_of_capacity; ++p) std::allocator_traits<Allocator>::destroy(_m_allocator, p);
+        _m_gap_begin = _m_first;
+        _m_gap_end = _m_end_of_capacity;
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(const Allocator& alloc) : _m_allocator(alloc) {}
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(size_type size, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size);
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(size_type size, const Type& value, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size, value);
+    }
+
+    template<typename Type, typename Allocator>
+    template<class InputIt, class>
+    gap_vector<Type, Allocator>::gap_vector(InputIt first, InputIt last, const Allocator& alloc) : _m_allocator(alloc) {
+        try {
+            for (; first != last; ++first) emplace_back(*first);
+        } catch (...) {
+            _m_destroy_all();
+            if (_m_first) std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_first, capacity());
+            throw;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : gap_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(const gap_vector& other)
+        : _m_allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other._m_allocator)) {
+        reserve(other.size());
+        for (const Type& value : other) emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::gap_vector(gap_vector&& other) noexcept
+        : _m_allocator(other._m_allocator), _m_first(other._m_first), _m_gap_begin(other._m_gap_begin),
+          _m_gap_end(other._m_gap_end), _m_end_of_capacity(other._m_end_of_capacity) {
+        other._m_first = other._m_gap_begin = other._m_gap_end = other._m_end_of_capacity = nullptr;
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>::~gap_vector() {
+        _m_destroy_all();
+        if (_m_first) std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_first, capacity());
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>& gap_vector<Type, Allocator>::operator=(const gap_vector& other) {
+        if (this != &other) {
+            gap_vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    template<typename Type, typename Allocator>
+    gap_vector<Type, Allocator>& gap_vector<Type, Allocator>::operator=(gap_vector&& other) noexcept {
+        if (this != &other) {
+            gap_vector moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::allocator_type gap_vector<Type, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reference gap_vector<Type, Allocator>::at(size_type pos) {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reference gap_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reference gap_vector<Type, Allocator>::operator[](size_type pos) {
+        pointer p = _m_first + pos;
+        return p < _m_gap_begin ? *p : p[_m_gap()];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reference gap_vector<Type, Allocator>::operator[](size_type pos) const {
+        pointer p = _m_first + pos;
+        return p < _m_gap_begin ? *p : p[_m_gap()];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reference gap_vector<Type, Allocator>::front() {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reference gap_vector<Type, Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reference gap_vector<Type, Allocator>::back() {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reference gap_vector<Type, Allocator>::back() const {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::pointer gap_vector<Type, Allocator>::compact() {
+        _m_move_gap(size());
+        return _m_first;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::pointer gap_vector<Type, Allocator>::data() noexcept {
+        return _m_first;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_pointer gap_vector<Type, Allocator>::data() const noexcept {
+        return _m_first;
+    }
+
+    template<typename Type, typename Allocator>
+    bool gap_vector<Type, Allocator>::is_compact() const noexcept {
+        return _m_gap_end == _m_end_of_capacity;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::size_type gap_vector<Type, Allocator>::gap_position() const noexcept {
+        return size_type(_m_gap_begin - _m_first);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_iterator gap_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_iterator gap_vector<Type, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::end() noexcept {
+        return iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_iterator gap_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_iterator gap_vector<Type, Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reverse_iterator gap_vector<Type, Allocator>::rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reverse_iterator gap_vector<Type, Allocator>::rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::reverse_iterator gap_vector<Type, Allocator>::rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::const_reverse_iterator gap_vector<Type, Allocator>::rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    template<typename Type, typename Allocator>
+    bool gap_vector<Type, Allocator>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::size_type gap_vector<Type, Allocator>::size() const noexcept {
+        return capacity() - _m_gap();
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::size_type gap_vector<Type, Allocator>::max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(Type);
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::reserve(size_type new_cap) {
+        if (new_cap > capacity()) _m_reallocate(new_cap);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::size_type gap_vector<Type, Allocator>::capacity() const noexcept {
+        return size_type(_m_end_of_capacity - _m_first);
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::shrink_to_fit() {
+        if (_m_gap()) _m_reallocate(size());
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::clear() noexcept {
+        _m_destroy_all();
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::insert(const_iterator pos, const Type& value) {
+        return emplace(pos, value);
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::insert(const_iterator pos, Type&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::insert(const_iterator pos, size_type count, const Type& value) {
+        size_type index = pos.index();
+        Type copy(value);
+        _m_grow(size() + count);
+        _m_move_gap(index);
+        for (size_type i = 0; i < count; ++i) {
+            std::allocator_traits<Allocator>::construct(_m_allocator, _m_gap_begin, copy);
+            ++_m_gap_begin;
+        }
+        return begin() + index;
+    }
+
+    template<typename Type, typename Allocator>
+    template<class InputIt, class>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::insert(const_iterator pos, InputIt first, InputIt last) {
+        size_type index = pos.index();
+        for (size_type i = index; first != last; ++first, ++i) emplace(cbegin() + i, *first);
+        return begin() + index;
+    }
+
+    //args may refer to an element of this vector, so the value is built before the gap moves
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::emplace(const_iterator pos, Args&&... args) {
+        size_type index = pos.index();
+        Type value(std::forward<Args>(args)...);
+        _m_grow(size() + 1);
+        _m_move_gap(index);
+        std::allocator_traits<Allocator>::construct(_m_allocator, _m_gap_begin, std::move(value));
+        ++_m_gap_begin;
+        return begin() + index;
+    }
+
+    //erasing right before the gap shrinks it from the front, anywhere else from the back
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::erase(const_iterator pos) {
+        size_type index = pos.index();
+        if (index < gap_position()) {
+            _m_move_gap(index + 1);
+            --_m_gap_begin;
+            std::allocator_traits<Allocator>::destroy(_m_allocator, _m_gap_begin);
+        } else {
+            _m_move_gap(index);
+            std::allocator_traits<Allocator>::destroy(_m_allocator, _m_gap_end);
+            ++_m_gap_end;
+        }
+        return begin() + index;
+    }
+
+    template<typename Type, typename Allocator>
+    typename gap_vector<Type, Allocator>::iterator gap_vector<Type, Allocator>::erase(const_iterator first, const_iterator last) {
+        size_type index = first.index(), count = last.index() - first.index();
+        if (count == 0) return begin() + index;
+        _m_move_gap(index);
+        for (size_type i = 0; i < count; ++i) {
+            std::allocator_traits<Allocator>::destroy(_m_allocator, _m_gap_end);
+            ++_m_gap_end;
+        }
+        return begin() + index;
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::push_back(const Type& value) {
+        emplace(cend(), value);
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::push_back(Type&& value) {
+        emplace(cend(), std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename gap_vector<Type, Allocator>::reference gap_vector<Type, Allocator>::emplace_back(Args&&... args) {
+        emplace(cend(), std::forward<Args>(args)...);
+        return back();
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::pop_back() {
+        erase(cend() - 1);
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::resize(size_type count) {
+        if (count < size()) {
+            erase(cbegin() + count, cend());
+            return;
+        }
+        _m_grow(count);
+        _m_move_gap(size());
+        while (size() < count) {
+            std::allocator_traits<Allocator>::construct(_m_allocator, _m_gap_begin);
+            ++_m_gap_begin;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::resize(size_type count, const value_type& value) {
+        if (count < size()) erase(cbegin() + count, cend());
+        else insert(cend(), count - size(), value);
+    }
+
+    template<typename Type, typename Allocator>
+    void gap_vector<Type, Allocator>::swap(gap_vector& other) noexcept {
+        std::swap(_m_allocator, other._m_allocator);
+        std::swap(_m_first, other._m_first);
+        std::swap(_m_gap_begin, other._m_gap_begin);
+        std::swap(_m_gap_end, other._m_gap_end);
+        std::swap(_m_end_of_capacity, other._m_end_of_capacity);
+    }
+
+    template <class Type, class Allocator>
+    bool operator==(const gap_vector<Type, Allocator>& lhs, const gap_vector<Type, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Type, class Allocator>
+    bool operator!=(const gap_vector<Type, Allocator>& lhs, const gap_vector<Type, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class Type, class Allocator>
+    bool operator<(const gap_vector<Type, Allocator>& lhs, const gap_vector<Type, Allocator>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+}
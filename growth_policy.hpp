@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+namespace art{
+
+    //Capacity growth used by art::vector. The constants are picked from sizeof(Type) at compile time:
+    //small vectors start with FIRST_ALLOCATION_BYTES worth of elements and double, vectors past
+    //LARGE_ALLOCATION_BYTES grow by 1.5 and are rounded up to whole pages.
+    //Specialize for a type to override its policy.
+    template <typename Type>
+    struct growth_policy{
+        static constexpr std::size_t ELEMENT_SIZE = sizeof(Type);
+        static constexpr std::size_t FIRST_ALLOCATION_BYTES = 64;
+        static constexpr std::size_t LARGE_ALLOCATION_BYTES = std::size_t(1) << 20;
+        static constexpr std::size_t PAGE_BYTES = 4096;
+
+        static constexpr std::size_t FIRST_CAPACITY =
+                FIRST_ALLOCATION_BYTES / ELEMENT_SIZE > 0 ? FIRST_ALLOCATION_BYTES / ELEMENT_SIZE : 1;
+        static constexpr std::size_t LARGE_CAPACITY =
+                LARGE_ALLOCATION_BYTES / ELEMENT_SIZE > 0 ? LARGE_ALLOCATION_BYTES / ELEMENT_SIZE : 1;
+
+        //capacity to allocate when capacity is too small for need_size elements
+        static std::size_t next_capacity(std::size_t capacity, std::size_t need_size) noexcept;
+    };
+
+    template <typename Type>
+    std::size_t growth_policy<Type>::next_capacity(std::size_t capacity, std::size_t need_size) noexcept {
+        std::size_t grown;
+        if (capacity == 0) grown = FIRST_CAPACITY;
+        else if (capacity < LARGE_CAPACITY) grown = capacity * 2;
+        else grown = capacity + capacity / 2;
+
+        if (grown < need_size) grown = need_size;
+        if (grown >= LARGE_CAPACITY) {
+            std::size_t bytes = (grown * ELEMENT_SIZE + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+            grown = bytes / ELEMENT_SIZE;
+        }
+        return grown;
+    }
+
+    template <typename Type> constexpr std::size_t growth_policy<Type>::ELEMENT_SIZE;
+    template <typename Type> constexpr std::size_t growth_policy<Type>::FIRST_ALLOCATION_BYTES;
+    template <typename Type> constexpr std::size_t growth_policy<Type>::LARGE_ALLOCATION_BYTES;
+    template <typename Type> constexpr std::size_t growth_policy<Type>::PAGE_BYTES;
+    template <typename Type> constexpr std::size_t growth_policy<Type>::FIRST_CAPACITY;
+    template <typename Type> constexpr std::size_t growth_policy<Type>::LARGE_CAPACITY;
+}
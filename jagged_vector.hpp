@@ -0,0 +1,391 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "span.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Rows of varying length stored in compressed sparse row form: the elements of all rows back to back
+    //in one vector, plus the offset where every row starts. A row is a span into that vector, found in
+    //O(1) without any per row header or allocation. Rows are appended at the end; the counts and pairs
+    //builders lay out every row at once, the latter with a counting sort split over the thread pool.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class jagged_vector{
+    public:
+        typedef span<Type>                                                                       value_type;
+        typedef span<Type>                                                                       reference;
+        typedef span<const Type>                                                                 const_reference;
+        typedef Allocator                                                                        allocator_type;
+        typedef std::size_t                                                                      size_type;
+        typedef std::ptrdiff_t                                                                   difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>      size_allocator;
+
+        //below this many pairs per thread from_pairs counts and scatters serially
+        static constexpr size_type PARALLEL_PAIRS_PER_THREAD = 1 << 16;
+
+        typedef detail::index_iterator<jagged_vector, span<Type>>             iterator;
+        typedef detail::index_iterator<const jagged_vector, span<const Type>> const_iterator;
+
+        // construct/copy/destroy
+        explicit jagged_vector(const Allocator& alloc = Allocator());
+        //row i holds row_sizes[i] value initialized elements
+        explicit jagged_vector(span<const size_type> row_sizes, const Allocator& alloc = Allocator());
+        jagged_vector(std::initializer_list<std::initializer_list<Type>> init, const Allocator& alloc = Allocator());
+
+        //rows rows from (row, value) pairs in any order, each row keeping the order of its pairs;
+        //every pair.first must be below rows
+        template <typename RandomIt>
+        static jagged_vector from_pairs(size_type rows, RandomIt first, RandomIt last,
+                                        thread_pool& pool = thread_pool::instance(), const Allocator& alloc = Allocator());
+
+        allocator_type get_allocator() const;
+
+        reference operator[](size_type pos) noexcept;
+        const_reference operator[](size_type pos) const noexcept;
+        reference at(size_type pos);
+        const_reference at(size_type pos) const;
+        reference front() noexcept;
+        const_reference front() const noexcept;
+        reference back() noexcept;
+        const_reference back() const noexcept;
+
+        iterator begin() noexcept;
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        iterator end() noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        //elements of all rows, row after row
+        span<Type> values() noexcept;
+        span<const Type> values() const noexcept;
+        //size() + 1 entries, row i is values()[offsets()[i], offsets()[i + 1])
+        span<const size_type> offsets() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        //number of rows
+        size_type size() const noexcept;
+        size_type row_size(size_type pos) const noexcept;
+        //elements of all rows together
+        size_type value_count() const noexcept;
+        void reserve(size_type rows, size_type values);
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        //appends a row with the elements of [first, last), which must not point into this vector
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        void append_row(InputIt first, InputIt last);
+        void append_row(std::initializer_list<Type> init);
+        void pop_row();
+        void clear() noexcept;
+        void swap(jagged_vector& other) noexcept;
+
+    private:
+        vector<Type, Allocator> _m_values;
+        vector<size_type, size_allocator> _m_offsets;
+    };
+
+    template<typename Type, typename Allocator>
+    constexpr typename jagged_vector<Type, Allocator>::size_type jagged_vector<Type, Allocator>::PARALLEL_PAIRS_PER_THREAD;
+
+    template<typename Type, typename Allocator>
+    jagged_vector<Type, Allocator>::jagged_vector(const Allocator& alloc) : _m_values(alloc), _m_offsets(size_allocator(alloc)) {
+        _m_offsets.emplace_back(0);
+    }
+
+    template<typename Type, typename Allocator>
+    jagged_vector<Type, Allocator>::jagged_vector(span<const size_type> row_sizes, const Allocator& alloc) : jagged_vector(alloc) {
+        _m_offsets.reserve(row_sizes.size() + 1);
+        size_type total = 0;
+        for (size_type count : row_sizes) _m_offsets.emplace_back(total += count);
+        _m_values.resize(total);
+    }
+
+    template<typename Type, typename Allocator>
+    jagged_vector<Type, Allocator>::jagged_vector(std::initializer_list<std::initializer_list<Type>> init, const Allocator& alloc)
+        : jagged_vector(alloc) {
+        for (const std::initializer_list<Type>& row : init) append_row(row.begin(), row.end());
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename RandomIt>
+    jagged_vector<Type, Allocator> jagged_vector<Type, Allocator>::from_pairs(size_type rows, RandomIt first, RandomIt last,
+                                                                              thread_pool& pool, const Allocator& alloc) {
+        size_type count = size_type(last - first);
+        size_type parts = std::max<size_type>(1, std::min(pool.size() + 1, count / PARALLEL_PAIRS_PER_THREAD));
+        auto bound = [count, parts](size_type part) {
+            return count / parts * part + std::min(part, count % parts);
+        };
+        auto for_each_part = [&](const auto& fn) {
+            if (parts == 1) {
+                fn(size_type(0));
+                return;
+            }
+            task_group group(pool);
+            for (size_type part = 1; part < parts; ++part) group.run([&fn, part] { fn(part); });
+            try {
+                fn(size_type(0));
+            } catch (...) {
+                group.wait();
+                throw;
+            }
+            group.wait();
+        };
+
+        jagged_vector result(alloc);
+        result._m_offsets.resize(rows + 1);
+        result._m_values.resize(count);
+        size_type* offsets = result._m_offsets.data();
+        Type* values = result._m_values.data();
+
+        //rows are split into ranges of width rows, one per part; every range lays out its own rows
+        //with a counting sort that keeps its counters in the offsets, so nothing scales with parts * rows
+        size_type width = std::max<size_type>(1, (rows + parts - 1) / parts);
+        size_type ranges = std::max<size_type>(1, (rows + width - 1) / width);
+        auto place = [&](size_type range, size_type from, size_type to, const auto& row_at, const auto& value_at) {
+            size_type row_first = range * width, row_last = std::min(rows, row_first + width);
+            //offsets[row + 1] counts the row, then becomes its write cursor and ends as its end offset
+            for (size_type i = from; i < to; ++i) {
+                size_type row = row_at(i);
+                if (row - row_first >= row_last - row_first) throw std::out_of_range("Row out of range");
+                ++offsets[row + 1];
+            }
+            size_type running = from;
+            for (size_type row = row_first; row < row_last; ++row) {
+                size_type counted = offsets[row + 1];
+                offsets[row + 1] = running;
+                running += counted;
+            }
+            for (size_type i = from; i < to; ++i) values[offsets[row_at(i) + 1]++] = value_at(i);
+        };
+        if (parts == 1) {
+            place(0, 0, count, [&](size_type i) {return size_type(first[i].first);}, [&](size_type i) {return first[i].second;});
+            return result;
+        }
+
+        //group the pairs by range first: per part range counts, then a range major prefix so every
+        //range is contiguous and keeps the input order of its pairs
+        vector<size_type, size_allocator> cursors(parts * ranges, size_type(0), size_allocator(alloc));
+        for_each_part([&](size_type part) {
+            vector<size_type, size_allocator> counts(ranges, size_type(0), size_allocator(alloc));
+            for (size_type i = bound(part), end = bound(part + 1); i < end; ++i) {
+                size_type row = size_type(first[i].first);
+                if (row >= rows) throw std::out_of_range("Row out of range");
+                ++counts[row / width];
+            }
+            std::copy(counts.begin(), counts.end(), cursors.begin() + part * ranges);
+        });
+        vector<size_type, size_allocator> range_start(ranges + 1, size_type(0), size_allocator(alloc));
+        size_type total = 0;
+        for (size_type range = 0; range < ranges; ++range) {
+            range_start[range] = total;
+            for (size_type part = 0; part < parts; ++part) {
+                size_type counted = cursors[part * ranges + range];
+                cursors[part * ranges + range] = total;
+                total += counted;
+            }
+        }
+        range_start[ranges] = total;
+
+        vector<size_type, size_allocator> staged_rows(count, size_type(0), size_allocator(alloc));
+        vector<Type, Allocator> staged_values(count, Type(), alloc);
+        for_each_part([&](size_type part) {
+            vector<size_type, size_allocator> next(cursors.begin() + part * ranges, cursors.begin() + (part + 1) * ranges, size_allocator(alloc));
+            for (size_type i = bound(part), end = bound(part + 1); i < end; ++i) {
+                size_type row = size_type(first[i].first);
+                size_type at = next[row / width]++;
+                staged_rows[at] = row;
+                staged_values[at] = first[i].second;
+            }
+        });
+        for_each_part([&](size_type range) {
+            if (range >= ranges) return;
+            place(range, range_start[range], range_start[range + 1], [&](size_type i) {return staged_rows[i];},
+                  [&](size_type i) -> Type&& {return std::move(staged_values[i]);});
+        });
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::allocator_type jagged_vector<Type, Allocator>::get_allocator() const {
+        return _m_values.get_allocator();
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::reference jagged_vector<Type, Allocator>::operator[](size_type pos) noexcept {
+        return reference(_m_values.data() + _m_offsets[pos], _m_values.data() + _m_offsets[pos + 1]);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_reference jagged_vector<Type, Allocator>::operator[](size_type pos) const noexcept {
+        return const_reference(_m_values.data() + _m_offsets[pos], _m_values.data() + _m_offsets[pos + 1]);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::reference jagged_vector<Type, Allocator>::at(size_type pos) {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_reference jagged_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::reference jagged_vector<Type, Allocator>::front() noexcept {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_reference jagged_vector<Type, Allocator>::front() const noexcept {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::reference jagged_vector<Type, Allocator>::back() noexcept {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_reference jagged_vector<Type, Allocator>::back() const noexcept {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::iterator jagged_vector<Type, Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_iterator jagged_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_iterator jagged_vector<Type, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::iterator jagged_vector<Type, Allocator>::end() noexcept {
+        return iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_iterator jagged_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::const_iterator jagged_vector<Type, Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    span<Type> jagged_vector<Type, Allocator>::values() noexcept {
+        return span<Type>(_m_values.data(), _m_values.size());
+    }
+
+    template<typename Type, typename Allocator>
+    span<const Type> jagged_vector<Type, Allocator>::values() const noexcept {
+        return span<const Type>(_m_values.data(), _m_values.size());
+    }
+
+    template<typename Type, typename Allocator>
+    span<const typename jagged_vector<Type, Allocator>::size_type> jagged_vector<Type, Allocator>::offsets() const noexcept {
+        return span<const size_type>(_m_offsets.data(), _m_offsets.size());
+    }
+
+    template<typename Type, typename Allocator>
+    bool jagged_vector<Type, Allocator>::empty() const noexcept {
+        return _m_offsets.size() == 1;
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::size_type jagged_vector<Type, Allocator>::size() const noexcept {
+        return _m_offsets.size() - 1;
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::size_type jagged_vector<Type, Allocator>::row_size(size_type pos) const noexcept {
+        return _m_offsets[pos + 1] - _m_offsets[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::size_type jagged_vector<Type, Allocator>::value_count() const noexcept {
+        return _m_values.size();
+    }
+
+    template<typename Type, typename Allocator>
+    void jagged_vector<Type, Allocator>::reserve(size_type rows, size_type values) {
+        _m_offsets.reserve(rows + 1);
+        _m_values.reserve(values);
+    }
+
+    template<typename Type, typename Allocator>
+    typename jagged_vector<Type, Allocator>::size_type jagged_vector<Type, Allocator>::memory_bytes() const noexcept {
+        return _m_values.capacity() * sizeof(Type) + _m_offsets.capacity() * sizeof(size_type);
+    }
+
+    template<typename Type, typename Allocator>
+    template<class InputIt, class>
+    void jagged_vector<Type, Allocator>::append_row(InputIt first, InputIt last) {
+        size_type old_size = _m_values.size();
+        try {
+            for (; first != last; ++first) _m_values.emplace_back(*first);
+            _m_offsets.emplace_back(_m_values.size());
+        } catch (...) {
+            _m_values.erase(_m_values.begin() + old_size, _m_values.end());
+            throw;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    void jagged_vector<Type, Allocator>::append_row(std::initializer_list<Type> init) {
+        append_row(init.begin(), init.end());
+    }
+
+    template<typename Type, typename Allocator>
+    void jagged_vector<Type, Allocator>::pop_row() {
+        _m_offsets.pop_back();
+        _m_values.erase(_m_values.begin() + _m_offsets.back(), _m_values.end());
+    }
+
+    template<typename Type, typename Allocator>
+    void jagged_vector<Type, Allocator>::clear() noexcept {
+        _m_values.clear();
+        _m_offsets.erase(_m_offsets.begin() + 1, _m_offsets.end());
+    }
+
+    template<typename Type, typename Allocator>
+    void jagged_vector<Type, Allocator>::swap(jagged_vector& other) noexcept {
+        _m_values.swap(other._m_values);
+        _m_offsets.swap(other._m_offsets);
+    }
+
+    template <class Type, class Allocator>
+    bool operator==(const jagged_vector<Type, Allocator>& lhs, const jagged_vector<Type, Allocator>& rhs) {
+        span<const std::size_t> a = lhs.offsets(), b = rhs.offsets();
+        span<const Type> x = lhs.values(), y = rhs.values();
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin()) &&
+               x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
+    }
+
+    template <class Type, class Allocator>
+    bool operator!=(const jagged_vector<Type, Allocator>& lhs, const jagged_vector<Type, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
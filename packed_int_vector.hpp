@@ -0,0 +1,347 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //bits needed to store value, 0 for 0
+        inline unsigned bit_width64(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+            return value ? 64 - unsigned(__builtin_clzll(value)) : 0;
+#else
+            unsigned width = 0;
+            for (; value; value >>= 1) ++width;
+            return width;
+#endif
+        }
+    }
+
+    //Frame of reference integer vector: values are grouped in blocks of BLOCK_SIZE, and each block
+    //stores its minimum plus every value's offset from it in the fewest bits that fit the block's
+    //range. A block of width w takes exactly 2 * w words. Random access finds the block and extracts
+    //one offset; whole blocks decode through kernels specialized for each width, whose constant
+    //shifts the compiler unrolls and vectorizes. push_back fills an uncompressed tail that is packed
+    //once it holds a whole block.
+    template <typename Allocator = std::allocator<std::uint64_t>>
+    class basic_packed_int_vector{
+    public:
+        typedef std::uint64_t                                                              value_type;
+        typedef std::uint64_t                                                              word_type;
+        typedef Allocator                                                                  allocator_type;
+        typedef std::size_t                                                                size_type;
+        typedef std::ptrdiff_t                                                             difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<word_type> word_allocator;
+        typedef vector<value_type, word_allocator>                                         unpacked_type;
+
+        static const size_type BLOCK_SIZE = 128;
+
+        typedef detail::index_iterator<const basic_packed_int_vector, value_type> const_iterator;
+        typedef const_iterator                                                    iterator;
+
+        // construct/copy/destroy
+        explicit basic_packed_int_vector(const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        basic_packed_int_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        basic_packed_int_vector(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+        explicit basic_packed_int_vector(const unpacked_type& values);
+
+        allocator_type get_allocator() const;
+
+        value_type operator[](size_type pos) const;
+        value_type at(size_type pos) const;
+        value_type front() const;
+        value_type back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        //packed blocks, the tail is not counted
+        size_type block_count() const noexcept;
+        //bit width of a packed block
+        unsigned block_width(size_type block) const;
+        //bytes held by blocks, headers and the tail
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        void clear() noexcept;
+        void push_back(value_type value);
+        void pop_back();
+        void swap(basic_packed_int_vector& other) noexcept;
+
+        //writes the BLOCK_SIZE values of a packed block to out
+        void decode_block(size_type block, value_type* out) const;
+        //calls fn(value) for every value in order, a block at a time
+        template <typename Function>
+        void for_each(Function fn) const;
+        unpacked_type to_vector() const;
+
+    private:
+        struct _m_block{
+            value_type base;
+            size_type offset;
+            unsigned width;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_block> _m_block_allocator;
+        typedef void (*_m_unpack_function)(const word_type* in, value_type base, value_type* out);
+
+        vector<word_type, word_allocator> _m_words;
+        vector<_m_block, _m_block_allocator> _m_blocks;
+        unpacked_type _m_tail;
+
+        //packs BLOCK_SIZE values from in as a new block
+        void _m_seal(const value_type* in);
+
+        static word_type _m_mask(unsigned width) noexcept {return width == 64 ? ~word_type(0) : (word_type(1) << width) - 1;}
+
+        template <unsigned Width>
+        static void _m_unpack(const word_type* in, value_type base, value_type* out);
+        template <std::size_t... Width>
+        static const _m_unpack_function* _m_unpack_table(std::index_sequence<Width...>);
+    };
+
+    typedef basic_packed_int_vector<> packed_int_vector;
+
+    template <typename Allocator> const typename basic_packed_int_vector<Allocator>::size_type basic_packed_int_vector<Allocator>::BLOCK_SIZE;
+
+    template<typename Allocator>
+    template<unsigned Width>
+    void basic_packed_int_vector<Allocator>::_m_unpack(const word_type* in, value_type base, value_type* out) {
+        if (Width == 0) {
+            std::fill(out, out + BLOCK_SIZE, base);
+            return;
+        }
+        const word_type mask = _m_mask(Width);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 64
+#endif
+        for (size_type i = 0; i < BLOCK_SIZE; ++i) {
+            size_type bit = i * Width;
+            size_type shift = bit % 64;
+            word_type value = in[bit / 64] >> shift;
+            if (shift + Width > 64) value |= in[bit / 64 + 1] << ((64 - shift) % 64);
+            out[i] = base + (value & mask);
+        }
+    }
+
+    template<typename Allocator>
+    template<std::size_t... Width>
+    const typename basic_packed_int_vector<Allocator>::_m_unpack_function*
+    basic_packed_int_vector<Allocator>::_m_unpack_table(std::index_sequence<Width...>) {
+        static const _m_unpack_function table[] = {&basic_packed_int_vector::_m_unpack<unsigned(Width)>...};
+        return table;
+    }
+
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::_m_seal(const value_type* in) {
+        value_type low = *std::min_element(in, in + BLOCK_SIZE);
+        value_type high = *std::max_element(in, in + BLOCK_SIZE);
+        unsigned width = detail::bit_width64(high - low);
+        size_type offset = _m_words.size();
+        _m_blocks.emplace_back(_m_block{low, offset, width});
+        if (width == 0) return;
+
+        _m_words.resize(offset + 2 * width);
+        word_type* out = _m_words.data() + offset;
+        std::fill(out, out + 2 * width, word_type(0));
+        for (size_type i = 0; i < BLOCK_SIZE; ++i) {
+            word_type value = in[i] - low;
+            size_type bit = i * width;
+            size_type shift = bit % 64;
+            out[bit / 64] |= value << shift;
+            if (shift + width > 64) out[bit / 64 + 1] |= value >> (64 - shift);
+        }
+    }
+
+    template<typename Allocator>
+    basic_packed_int_vector<Allocator>::basic_packed_int_vector(const Allocator& alloc)
+        : _m_words(word_allocator(alloc)), _m_blocks(_m_block_allocator(alloc)), _m_tail(word_allocator(alloc)) {}
+
+    template<typename Allocator>
+    template<class InputIt, class>
+    basic_packed_int_vector<Allocator>::basic_packed_int_vector(InputIt first, InputIt last, const Allocator& alloc)
+        : basic_packed_int_vector(alloc) {
+        for (; first != last; ++first) push_back(value_type(*first));
+    }
+
+    template<typename Allocator>
+    basic_packed_int_vector<Allocator>::basic_packed_int_vector(std::initializer_list<value_type> init, const Allocator& alloc)
+        : basic_packed_int_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Allocator>
+    basic_packed_int_vector<Allocator>::basic_packed_int_vector(const unpacked_type& values)
+        : basic_packed_int_vector(allocator_type(values.get_allocator())) {
+        size_type whole = values.size() / BLOCK_SIZE * BLOCK_SIZE;
+        _m_blocks.reserve(whole / BLOCK_SIZE);
+        for (size_type i = 0; i < whole; i += BLOCK_SIZE) _m_seal(values.data() + i);
+        for (size_type i = whole; i < values.size(); ++i) _m_tail.emplace_back(values[i]);
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::allocator_type basic_packed_int_vector<Allocator>::get_allocator() const {
+        return allocator_type(_m_words.get_allocator());
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::value_type basic_packed_int_vector<Allocator>::operator[](size_type pos) const {
+        size_type block_index = pos / BLOCK_SIZE;
+        if (block_index >= _m_blocks.size()) return _m_tail[pos - _m_blocks.size() * BLOCK_SIZE];
+        const _m_block& block = _m_blocks[block_index];
+        if (block.width == 0) return block.base;
+        size_type bit = (pos % BLOCK_SIZE) * block.width;
+        size_type shift = bit % 64;
+        const word_type* in = _m_words.data() + block.offset + bit / 64;
+        word_type value = in[0] >> shift;
+        if (shift + block.width > 64) value |= in[1] << (64 - shift);
+        return block.base + (value & _m_mask(block.width));
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::value_type basic_packed_int_vector<Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::value_type basic_packed_int_vector<Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::value_type basic_packed_int_vector<Allocator>::back() const {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::const_iterator basic_packed_int_vector<Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::const_iterator basic_packed_int_vector<Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::const_iterator basic_packed_int_vector<Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::const_iterator basic_packed_int_vector<Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Allocator>
+    bool basic_packed_int_vector<Allocator>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::size_type basic_packed_int_vector<Allocator>::size() const noexcept {
+        return _m_blocks.size() * BLOCK_SIZE + _m_tail.size();
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::size_type basic_packed_int_vector<Allocator>::block_count() const noexcept {
+        return _m_blocks.size();
+    }
+
+    template<typename Allocator>
+    unsigned basic_packed_int_vector<Allocator>::block_width(size_type block) const {
+        return _m_blocks.at(block).width;
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::size_type basic_packed_int_vector<Allocator>::memory_bytes() const noexcept {
+        return (_m_words.size() + _m_tail.size()) * sizeof(word_type) + _m_blocks.size() * sizeof(_m_block);
+    }
+
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::clear() noexcept {
+        _m_words.clear();
+        _m_blocks.clear();
+        _m_tail.clear();
+    }
+
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::push_back(value_type value) {
+        _m_tail.emplace_back(value);
+        if (_m_tail.size() == BLOCK_SIZE) {
+            _m_seal(_m_tail.data());
+            _m_tail.erase(_m_tail.begin(), _m_tail.end());
+        }
+    }
+
+    //an empty tail unpacks the last block back into it
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::pop_back() {
+        if (_m_tail.empty()) {
+            _m_tail.resize(BLOCK_SIZE);
+            decode_block(_m_blocks.size() - 1, _m_tail.data());
+            _m_words.resize(_m_blocks[_m_blocks.size() - 1].offset);
+            _m_blocks.erase(_m_blocks.end() - 1, _m_blocks.end());
+        }
+        _m_tail.erase(_m_tail.end() - 1, _m_tail.end());
+    }
+
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::swap(basic_packed_int_vector& other) noexcept {
+        _m_words.swap(other._m_words);
+        _m_blocks.swap(other._m_blocks);
+        _m_tail.swap(other._m_tail);
+    }
+
+    template<typename Allocator>
+    void basic_packed_int_vector<Allocator>::decode_block(size_type block, value_type* out) const {
+        static const _m_unpack_function* unpack = _m_unpack_table(std::make_index_sequence<65>());
+        const _m_block& header = _m_blocks[block];
+        unpack[header.width](_m_words.data() + header.offset, header.base, out);
+    }
+
+    template<typename Allocator>
+    template<typename Function>
+    void basic_packed_int_vector<Allocator>::for_each(Function fn) const {
+        value_type buffer[BLOCK_SIZE];
+        for (size_type b = 0; b < _m_blocks.size(); ++b) {
+            decode_block(b, buffer);
+            for (size_type i = 0; i < BLOCK_SIZE; ++i) fn(buffer[i]);
+        }
+        for (size_type i = 0; i < _m_tail.size(); ++i) fn(_m_tail[i]);
+    }
+
+    template<typename Allocator>
+    typename basic_packed_int_vector<Allocator>::unpacked_type basic_packed_int_vector<Allocator>::to_vector() const {
+        unpacked_type values(_m_tail.get_allocator());
+        values.reserve(size());
+        values.resize(size());
+        for (size_type b = 0; b < _m_blocks.size(); ++b) decode_block(b, values.data() + b * BLOCK_SIZE);
+        std::copy(_m_tail.begin(), _m_tail.end(), values.data() + _m_blocks.size() * BLOCK_SIZE);
+        return values;
+    }
+
+    template <class Allocator>
+    bool operator==(const basic_packed_int_vector<Allocator>& lhs, const basic_packed_int_vector<Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Allocator>
+    bool operator!=(const basic_packed_int_vector<Allocator>& lhs, const basic_packed_int_vector<Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
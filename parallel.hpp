@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+namespace art{ namespace parallel{
+
+    struct options{
+        //elements per task, 0 derives it from the measured cost of the first elements
+        std::size_t grain = 0;
+        //chunking depends on the element count only, so parallel_reduce combines the same
+        //partial results in the same order on every run and every machine
+        bool deterministic = false;
+        //nullptr means thread_pool::instance()
+        thread_pool* pool = nullptr;
+    };
+
+    //fn(element) for every element of [first, last)
+    template <typename RandomIt, typename Function>
+    void parallel_for_each(RandomIt first, RandomIt last, Function fn, const options& opts = options());
+
+    //*(d_first + i) = op(*(first + i)), returns the end of the written range
+    template <typename RandomIt, typename OutputIt, typename UnaryOperation>
+    OutputIt parallel_transform(RandomIt first, RandomIt last, OutputIt d_first, UnaryOperation op,
+                                const options& opts = options());
+
+    //init combined with every element by an associative op; partial results of chunks are
+    //always combined left to right, so the only source of variation is the chunking itself
+    template <typename RandomIt, typename Type, typename BinaryOperation>
+    Type parallel_reduce(RandomIt first, RandomIt last, Type init, BinaryOperation op,
+                         const options& opts = options());
+
+    namespace detail{
+        //tasks are sized to take about this long
+        const std::size_t TASK_NANOSECONDS = 50000;
+        //serial warm-up used to measure element cost
+        const std::size_t PROBE_NANOSECONDS = 10000;
+        //never fewer tasks than this times the number of threads, for load balance
+        const std::size_t TASKS_PER_THREAD = 4;
+
+        struct chunk_plan{
+            std::size_t prefix;   //elements already processed by the probe
+            std::size_t grain;
+            std::size_t chunks;   //chunks of grain covering [prefix, count)
+        };
+
+        inline std::size_t deterministic_grain(std::size_t count) noexcept {
+            return std::max<std::size_t>(2048, (count + 4095) / 4096);
+        }
+
+        inline thread_pool& pool_of(const options& opts) {
+            return opts.pool ? *opts.pool : thread_pool::instance();
+        }
+
+        //decides the grain, running body(first, last) serially on a prefix when it has to measure
+        template <typename Body>
+        chunk_plan plan_chunks(std::size_t count, const options& opts, Body& body) {
+            chunk_plan plan{0, count, count ? std::size_t(1) : std::size_t(0)};
+            std::size_t threads = pool_of(opts).size() + 1;
+            if (opts.deterministic) plan.grain = opts.grain ? opts.grain : deterministic_grain(count);
+            else if (opts.grain) plan.grain = opts.grain;
+            else if (threads > 1) {
+                std::size_t balance_cap = std::max<std::size_t>(1, count / (threads * TASKS_PER_THREAD));
+                std::size_t batch = 1;
+                auto start = std::chrono::steady_clock::now();
+                std::chrono::nanoseconds spent(0);
+                while (plan.prefix + batch <= balance_cap && spent.count() < (long long) PROBE_NANOSECONDS) {
+                    body(plan.prefix, plan.prefix + batch);
+                    plan.prefix += batch;
+                    batch *= 2;
+                    spent = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                }
+                double per_element = plan.prefix ? double(spent.count()) / plan.prefix : 0.0;
+                std::size_t wanted = per_element > 0 ? std::size_t(TASK_NANOSECONDS / per_element) : balance_cap;
+                plan.grain = std::min(std::max<std::size_t>(1, wanted), balance_cap);
+            }
+            if (plan.grain == 0) plan.grain = 1;
+            plan.chunks = (count - plan.prefix + plan.grain - 1) / plan.grain;
+            return plan;
+        }
+
+        template <typename Leaf>
+        void split_chunks(task_group& group, std::size_t first_chunk, std::size_t last_chunk, const Leaf& leaf) {
+            while (last_chunk - first_chunk > 1) {
+                std::size_t middle = first_chunk + (last_chunk - first_chunk) / 2;
+                group.run([&group, middle, last_chunk, &leaf] { split_chunks(group, middle, last_chunk, leaf); });
+                last_chunk = middle;
+            }
+            leaf(first_chunk);
+        }
+
+        //runs body(chunk, first, last) for every chunk of the plan, recursively halving the chunk range
+        //so thieves take big halves and owners work through the small ones
+        template <typename Body>
+        void run_chunks(std::size_t count, const chunk_plan& plan, const options& opts, Body& body) {
+            if (plan.chunks == 0) return;
+            auto leaf = [&](std::size_t chunk) {
+                std::size_t from = plan.prefix + chunk * plan.grain;
+                body(chunk, from, std::min(count, from + plan.grain));
+            };
+            if (plan.chunks == 1) {
+                leaf(0);
+                return;
+            }
+            task_group group(pool_of(opts));
+            try {
+                split_chunks(group, 0, plan.chunks, leaf);
+            } catch (...) {
+                group.wait();
+                throw;
+            }
+            group.wait();
+        }
+
+        //uninitialized slots for per-chunk partial results
+        template <typename Type>
+        class partials{
+        public:
+            explicit partials(std::size_t count)
+                : _m_storage(new storage[count]), _m_constructed(new bool[count]()), _m_count(count) {}
+            ~partials() {
+                for (std::size_t i = 0; i < _m_count; ++i) if (_m_constructed[i]) get(i).~Type();
+            }
+            template <typename Value>
+            void set(std::size_t i, Value&& value) {
+                ::new (&_m_storage[i]) Type(std::forward<Value>(value));
+                _m_constructed[i] = true;
+            }
+            Type& get(std::size_t i) { return *reinterpret_cast<Type*>(&_m_storage[i]); }
+        private:
+            typedef typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+            std::unique_ptr<storage[]> _m_storage;
+            std::unique_ptr<bool[]> _m_constructed;
+            std::size_t _m_count;
+        };
+    }
+
+    template <typename RandomIt, typename Function>
+    void parallel_for_each(RandomIt first, RandomIt last, Function fn, const options& opts) {
+        std::size_t count = last - first;
+        auto body = [&](std::size_t from, std::size_t to) {
+            for (RandomIt it = first + from, end = first + to; it != end; ++it) fn(*it);
+        };
+        auto plan = detail::plan_chunks(count, opts, body);
+        auto chunk_body = [&](std::size_t, std::size_t from, std::size_t to) { body(from, to); };
+        detail::run_chunks(count, plan, opts, chunk_body);
+    }
+
+    template <typename RandomIt, typename OutputIt, typename UnaryOperation>
+    OutputIt parallel_transform(RandomIt first, RandomIt last, OutputIt d_first, UnaryOperation op, const options& opts) {
+        std::size_t count = last - first;
+        auto body = [&](std::size_t from, std::size_t to) {
+            OutputIt out = d_first + from;
+            for (RandomIt it = first + from, end = first + to; it != end; ++it, ++out) *out = op(*it);
+        };
+        auto plan = detail::plan_chunks(count, opts, body);
+        auto chunk_body = [&](std::size_t, std::size_t from, std::size_t to) { body(from, to); };
+        detail::run_chunks(count, plan, opts, chunk_body);
+        return d_first + count;
+    }
+
+    template <typename RandomIt, typename Type, typename BinaryOperation>
+    Type parallel_reduce(RandomIt first, RandomIt last, Type init, BinaryOperation op, const options& opts) {
+        std::size_t count = last - first;
+        auto reduce_range = [&](std::size_t from, std::size_t to) {
+            Type partial = *(first + from);
+            for (RandomIt it = first + from + 1, end = first + to; it != end; ++it) partial = op(std::move(partial), *it);
+            return partial;
+        };
+        auto probe_body = [&](std::size_t from, std::size_t to) {
+            init = op(std::move(init), reduce_range(from, to));
+        };
+        auto plan = detail::plan_chunks(count, opts, probe_body);
+
+        detail::partials<Type> results(plan.chunks);
+        auto chunk_body = [&](std::size_t chunk, std::size_t from, std::size_t to) {
+            results.set(chunk, reduce_range(from, to));
+        };
+        detail::run_chunks(count, plan, opts, chunk_body);
+        for (std::size_t chunk = 0; chunk < plan.chunks; ++chunk) init = op(std::move(init), std::move(results.get(chunk)));
+        return init;
+    }
+}}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+
+#include "parallel.hpp"
+#include "thread_pool.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //vectors shorter than this are sorted with std::sort / std::stable_sort on the calling thread
+    const std::size_t PARALLEL_SORT_THRESHOLD = std::size_t(1) << 15;
+
+    //sample sort: elements are distributed into buckets bounded by sorted samples, moved through a
+    //scratch buffer obtained from the vector's allocator and the buckets are sorted in parallel
+    template <typename Type, typename Allocator, typename Compare = std::less<Type>>
+    void parallel_sort(vector<Type, Allocator>& values, Compare comp = Compare(),
+                       const parallel::options& opts = parallel::options());
+
+    //as parallel_sort, but keeps the order of equivalent elements
+    template <typename Type, typename Allocator, typename Compare = std::less<Type>>
+    void parallel_stable_sort(vector<Type, Allocator>& values, Compare comp = Compare(),
+                              const parallel::options& opts = parallel::options());
+
+    namespace detail{
+        const std::size_t SORT_OVERSAMPLING = 32;
+        const std::size_t SORT_BUCKETS_PER_THREAD = 8;
+        const std::size_t SORT_MAX_BUCKETS = 1024;
+        const std::size_t SORT_CHUNKS_PER_THREAD = 4;
+
+        template <bool Stable, typename Type, typename Allocator, typename Compare>
+        void sample_sort(vector<Type, Allocator>& values, Compare comp, thread_pool& pool) {
+            typedef std::allocator_traits<Allocator> traits;
+            typedef typename traits::template rebind_alloc<std::uint16_t> bucket_allocator;
+
+            const std::size_t count = values.size();
+            const std::size_t threads = pool.size() + 1;
+            const std::size_t buckets = std::min(SORT_MAX_BUCKETS, threads * SORT_BUCKETS_PER_THREAD);
+            const std::size_t chunks = threads * SORT_CHUNKS_PER_THREAD;
+            Type* data = values.data();
+
+            //splitters from a sorted pseudo-random sample of positions, so elements are never copied
+            vector<std::size_t> sample;
+            sample.reserve(buckets * SORT_OVERSAMPLING);
+            std::uint64_t state = 0x9E3779B97F4A7C15ull;
+            for (std::size_t i = 0; i < buckets * SORT_OVERSAMPLING; ++i) {
+                state ^= state << 13; state ^= state >> 7; state ^= state << 17;
+                sample.emplace_back(std::size_t(state % count));
+            }
+            std::sort(sample.begin(), sample.end(), [data, &comp](std::size_t lhs, std::size_t rhs) { return comp(data[lhs], data[rhs]); });
+            //a key picked as several splitters dominates the input; its elements get an equality
+            //bucket of their own, which is sorted already and skips the bucket sort
+            vector<const Type*> splitters;
+            vector<char> repeated;
+            splitters.reserve(buckets - 1);
+            repeated.reserve(buckets - 1);
+            for (std::size_t b = 1; b < buckets; ++b) {
+                const Type* candidate = data + sample[b * SORT_OVERSAMPLING];
+                if (!splitters.empty() && !comp(*splitters.back(), *candidate)) repeated.back() = 1;
+                else {
+                    splitters.emplace_back(candidate);
+                    repeated.emplace_back(char(0));
+                }
+            }
+            //bucket 2 * b holds the elements between splitters b - 1 and b, bucket 2 * b - 1 the
+            //elements equal to a repeated splitter b - 1
+            const std::size_t bucket_count = 2 * splitters.size() + 1;
+
+            //bucket of every element, and per chunk bucket sizes
+            vector<std::uint16_t, bucket_allocator> bucket_of(count);
+            vector<std::size_t> offsets(chunks * bucket_count);
+            auto chunk_bound = [count, chunks](std::size_t chunk) {
+                return count / chunks * chunk + std::min(chunk, count % chunks);
+            };
+            {
+                task_group group(pool);
+                for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                    group.run([&, chunk] {
+                        std::size_t* counts = offsets.data() + chunk * bucket_count;
+                        const Type* const* split_first = splitters.data();
+                        const Type* const* split_last = split_first + splitters.size();
+                        auto below = [&comp](const Type& value, const Type* splitter) { return comp(value, *splitter); };
+                        for (std::size_t i = chunk_bound(chunk), end = chunk_bound(chunk + 1); i < end; ++i) {
+                            std::size_t above = std::upper_bound(split_first, split_last, data[i], below) - split_first;
+                            std::size_t bucket = 2 * above;
+                            if (above && repeated[above - 1] && !comp(*split_first[above - 1], data[i])) --bucket;
+                            bucket_of[i] = (std::uint16_t) bucket;
+                            ++counts[bucket];
+                        }
+                    });
+                }
+                group.wait();
+            }
+
+            //bucket major exclusive prefix sum, so chunk order is kept inside every bucket
+            vector<std::size_t> bucket_start(bucket_count + 1);
+            std::size_t running = 0;
+            for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                bucket_start[bucket] = running;
+                for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                    std::size_t size = offsets[chunk * bucket_count + bucket];
+                    offsets[chunk * bucket_count + bucket] = running;
+                    running += size;
+                }
+            }
+            bucket_start[bucket_count] = running;
+
+            Allocator allocator = values.get_allocator();
+            Type* scratch = traits::allocate(allocator, count);
+            {
+                task_group group(pool);
+                for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+                    group.run([&, chunk] {
+                        std::size_t* next = offsets.data() + chunk * bucket_count;
+                        for (std::size_t i = chunk_bound(chunk), end = chunk_bound(chunk + 1); i < end; ++i) {
+                            traits::construct(allocator, scratch + next[bucket_of[i]]++, std::move(data[i]));
+                        }
+                    });
+                }
+                group.wait();
+            }
+
+            //sort every bucket in scratch and move it back into place; equality buckets kept the
+            //input order while scattering, so they are sorted and stable as they are
+            {
+                task_group group(pool);
+                for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+                    if (bucket_start[bucket] == bucket_start[bucket + 1]) continue;
+                    group.run([&, bucket] {
+                        Type* first = scratch + bucket_start[bucket];
+                        Type* last = scratch + bucket_start[bucket + 1];
+                        if (bucket % 2 == 0) {
+                            if (Stable) std::stable_sort(first, last, comp);
+                            else std::sort(first, last, comp);
+                        }
+                        std::move(first, last, data + bucket_start[bucket]);
+                        for (Type* it = first; it != last; ++it) traits::destroy(allocator, it);
+                    });
+                }
+                group.wait();
+            }
+            traits::deallocate(allocator, scratch, count);
+        }
+    }
+
+    template <typename Type, typename Allocator, typename Compare>
+    void parallel_sort(vector<Type, Allocator>& values, Compare comp, const parallel::options& opts) {
+        thread_pool& pool = parallel::detail::pool_of(opts);
+        if (values.size() < PARALLEL_SORT_THRESHOLD || pool.size() == 0) std::sort(values.begin(), values.end(), comp);
+        else detail::sample_sort<false>(values, comp, pool);
+    }
+
+    template <typename Type, typename Allocator, typename Compare>
+    void parallel_stable_sort(vector<Type, Allocator>& values, Compare comp, const parallel::options& opts) {
+        thread_pool& pool = parallel::detail::pool_of(opts);
+        if (values.size() < PARALLEL_SORT_THRESHOLD || pool.size() == 0) std::stable_sort(values.begin(), values.end(), comp);
+        else detail::sample_sort<true>(values, comp, pool);
+    }
+}
@@ -0,0 +1,618 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    //Immutable vector where every update returns a new version sharing all untouched nodes with the
+    //old one. The tree is a relaxed radix balanced tree of 32-way nodes: inner nodes keep cumulative
+    //child sizes, so slices and concatenations may leave partially filled nodes anywhere while lookup
+    //stays a radix guess followed by a short forward scan. push_back, set, slice and concat copy
+    //O(log32 n) nodes. A transient_vector edits the nodes it created in place for bulk builds.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class persistent_vector{
+    private:
+        struct _m_node;
+        typedef std::shared_ptr<_m_node> _m_node_ptr;
+
+    public:
+        typedef Type                     value_type;
+        typedef Allocator                allocator_type;
+        typedef std::size_t              size_type;
+        typedef std::ptrdiff_t           difference_type;
+        typedef const value_type&        const_reference;
+
+        static const unsigned BITS = 5;
+        static const size_type BRANCHING = size_type(1) << BITS;
+
+    private:
+        //leaf holding the last element read, so a scan descends the tree once per leaf
+        struct _m_leaf_cache{
+            mutable const Type* leaf = nullptr;
+            mutable size_type first = 0;
+            mutable size_type size = 0;
+
+            const Type& operator()(const persistent_vector& tree, size_type index) const {
+                if (index - first >= size) {
+                    const _m_node* node = tree._m_leaf(index, first);
+                    leaf = node->values.data();
+                    size = node->values.size();
+                }
+                return leaf[index - first];
+            }
+        };
+
+    public:
+        typedef detail::index_iterator<const persistent_vector, const Type&, Type, _m_leaf_cache> const_iterator;
+        typedef const_iterator                                                                   iterator;
+
+        //Batch-mutable copy of a version: edits copy a node once, then change it in place
+        class transient_vector{
+        public:
+            //a copy shares the nodes built so far, so both sides copy them again before editing
+            transient_vector(const transient_vector& other) : _m_tree(other._m_tree), _m_owner(_m_next_owner()) {
+                other._m_owner = _m_next_owner();
+            }
+            transient_vector(transient_vector&& other) = default;
+            transient_vector& operator=(const transient_vector& other) {
+                _m_tree = other._m_tree;
+                _m_owner = _m_next_owner();
+                other._m_owner = _m_next_owner();
+                return *this;
+            }
+            transient_vector& operator=(transient_vector&& other) = default;
+
+            size_type size() const noexcept {return _m_tree.size();}
+            bool empty() const noexcept {return _m_tree.empty();}
+            const_reference operator[](size_type pos) const {return _m_tree[pos];}
+
+            template <typename Value>
+            void push_back(Value&& value) {_m_tree._m_push(std::forward<Value>(value), _m_owner);}
+            template <typename Value>
+            void set(size_type pos, Value&& value) {_m_tree._m_assign(pos, std::forward<Value>(value), _m_owner);}
+
+            //the version built so far; later edits of this transient copy nodes again
+            persistent_vector persistent() {
+                _m_owner = _m_next_owner();
+                return _m_tree;
+            }
+
+        private:
+            friend class persistent_vector;
+            explicit transient_vector(const persistent_vector& tree) : _m_tree(tree), _m_owner(_m_next_owner()) {}
+
+            persistent_vector _m_tree;
+            mutable std::uint64_t _m_owner;
+        };
+
+        explicit persistent_vector(const Allocator& alloc = Allocator());
+        persistent_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+        explicit persistent_vector(const vector<Type, Allocator>& values);
+
+        size_type size() const noexcept;
+        bool empty() const noexcept;
+
+        const_reference operator[](size_type pos) const;
+        const_reference at(size_type pos) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator cend() const noexcept;
+
+        //new versions, *this is unchanged
+        template <typename Value>
+        persistent_vector push_back(Value&& value) const;
+        template <typename Value>
+        persistent_vector set(size_type pos, Value&& value) const;
+        persistent_vector pop_back() const;
+        //elements [from, to)
+        persistent_vector slice(size_type from, size_type to) const;
+        persistent_vector concat(const persistent_vector& other) const;
+
+        transient_vector transient() const;
+        vector<Type, Allocator> to_vector() const;
+
+        allocator_type get_allocator() const;
+
+    private:
+        struct _m_node{
+            explicit _m_node(const Allocator& alloc) : values(alloc) {}
+
+            //transient allowed to edit this node in place, 0 for none
+            std::uint64_t owner = 0;
+            //inner nodes: children and sizes[i], the element count of children[0..i]
+            vector<_m_node_ptr> children;
+            vector<size_type> sizes;
+            //leaves
+            vector<Type, Allocator> values;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_node> _m_node_allocator;
+
+        Allocator _m_allocator;
+        _m_node_ptr _m_root;
+        //shift of the root, the root is a leaf at 0
+        unsigned _m_shift = 0;
+        size_type _m_size = 0;
+
+        static std::uint64_t _m_next_owner() noexcept;
+        static size_type _m_child_index(const _m_node& node, unsigned shift, size_type& index) noexcept;
+        static size_type _m_count(const _m_node& node, unsigned shift) noexcept;
+
+        _m_node_ptr _m_new_node(std::uint64_t owner) const;
+        _m_node_ptr _m_editable(const _m_node_ptr& node, std::uint64_t owner) const;
+        _m_node_ptr _m_inner(const vector<_m_node_ptr>& children, size_type first, size_type last, unsigned shift) const;
+        const _m_node* _m_leaf(size_type index, size_type& leaf_first) const;
+
+        template <typename Value>
+        _m_node_ptr _m_new_path(unsigned shift, Value&& value, std::uint64_t owner) const;
+        template <typename Value>
+        _m_node_ptr _m_push_into(const _m_node_ptr& node, unsigned shift, Value&& value, std::uint64_t owner) const;
+        template <typename Value>
+        void _m_push(Value&& value, std::uint64_t owner);
+        template <typename Value>
+        _m_node_ptr _m_assign_in(const _m_node_ptr& node, unsigned shift, size_type index, Value&& value, std::uint64_t owner) const;
+        template <typename Value>
+        void _m_assign(size_type pos, Value&& value, std::uint64_t owner);
+
+        _m_node_ptr _m_take(const _m_node_ptr& node, unsigned shift, size_type count) const;
+        _m_node_ptr _m_drop(const _m_node_ptr& node, unsigned shift, size_type count) const;
+        std::pair<_m_node_ptr, _m_node_ptr> _m_merge(const _m_node_ptr& left, const _m_node_ptr& right, unsigned shift) const;
+        void _m_collapse();
+        void _m_append_leaves(const _m_node& node, unsigned shift, vector<Type, Allocator>& out) const;
+    };
+
+    template<typename Type, typename Allocator>
+    const unsigned persistent_vector<Type, Allocator>::BITS;
+    template<typename Type, typename Allocator>
+    const typename persistent_vector<Type, Allocator>::size_type persistent_vector<Type, Allocator>::BRANCHING;
+
+    template<typename Type, typename Allocator>
+    std::uint64_t persistent_vector<Type, Allocator>::_m_next_owner() noexcept {
+        static std::atomic<std::uint64_t> next(1);
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //children never hold more than 1 << shift elements, so the child holding index is at or after
+    //index >> shift; index becomes relative to that child
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::size_type
+    persistent_vector<Type, Allocator>::_m_child_index(const _m_node& node, unsigned shift, size_type& index) noexcept {
+        size_type child = index >> shift;
+        while (node.sizes[child] <= index) ++child;
+        if (child) index -= node.sizes[child - 1];
+        return child;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::size_type
+    persistent_vector<Type, Allocator>::_m_count(const _m_node& node, unsigned shift) noexcept {
+        return shift == 0 ? node.values.size() : node.sizes.back();
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_new_node(std::uint64_t owner) const {
+        _m_node_ptr node = std::allocate_shared<_m_node>(_m_node_allocator(_m_allocator), _m_allocator);
+        node->owner = owner;
+        return node;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_editable(const _m_node_ptr& node, std::uint64_t owner) const {
+        if (owner != 0 && node->owner == owner) return node;
+        _m_node_ptr copy = std::allocate_shared<_m_node>(_m_node_allocator(_m_allocator), *node);
+        copy->owner = owner;
+        //a transient will keep appending to its copies
+        if (owner != 0) {
+            copy->children.reserve(BRANCHING);
+            copy->sizes.reserve(BRANCHING);
+            copy->values.reserve(BRANCHING);
+        }
+        return copy;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_inner(const vector<_m_node_ptr>& children, size_type first, size_type last, unsigned shift) const {
+        _m_node_ptr node = _m_new_node(0);
+        node->children.reserve(last - first);
+        node->sizes.reserve(last - first);
+        size_type running = 0;
+        for (size_type i = first; i < last; ++i) {
+            running += _m_count(*children[i], shift - BITS);
+            node->children.emplace_back(children[i]);
+            node->sizes.emplace_back(running);
+        }
+        return node;
+    }
+
+    template<typename Type, typename Allocator>
+    const typename persistent_vector<Type, Allocator>::_m_node*
+    persistent_vector<Type, Allocator>::_m_leaf(size_type index, size_type& leaf_first) const {
+        const _m_node* node = _m_root.get();
+        size_type remaining = index;
+        for (unsigned shift = _m_shift; shift > 0; shift -= BITS) {
+            node = node->children[_m_child_index(*node, shift, remaining)].get();
+        }
+        leaf_first = index - remaining;
+        return node;
+    }
+
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator>::persistent_vector(const Allocator& alloc) : _m_allocator(alloc) {}
+
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator>::persistent_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : persistent_vector(vector<Type, Allocator>(init, alloc)) {}
+
+    //built bottom up from full leaves, so the tree is dense
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator>::persistent_vector(const vector<Type, Allocator>& values)
+        : _m_allocator(values.get_allocator()), _m_size(values.size()) {
+        if (values.empty()) return;
+        vector<_m_node_ptr> level;
+        level.reserve((_m_size + BRANCHING - 1) / BRANCHING);
+        for (size_type first = 0; first < _m_size; first += BRANCHING) {
+            _m_node_ptr leaf = _m_new_node(0);
+            const Type* from = values.data() + first;
+            leaf->values = vector<Type, Allocator>(from, from + std::min(BRANCHING, _m_size - first), _m_allocator);
+            level.emplace_back(std::move(leaf));
+        }
+        while (level.size() > 1) {
+            _m_shift += BITS;
+            vector<_m_node_ptr> parents;
+            parents.reserve((level.size() + BRANCHING - 1) / BRANCHING);
+            for (size_type first = 0; first < level.size(); first += BRANCHING) {
+                parents.emplace_back(_m_inner(level, first, std::min(level.size(), first + BRANCHING), _m_shift));
+            }
+            level = std::move(parents);
+        }
+        _m_root = level[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::size_type persistent_vector<Type, Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Type, typename Allocator>
+    bool persistent_vector<Type, Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_reference
+    persistent_vector<Type, Allocator>::operator[](size_type pos) const {
+        size_type leaf_first;
+        const _m_node* leaf = _m_leaf(pos, leaf_first);
+        return leaf->values[pos - leaf_first];
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_reference
+    persistent_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_reference persistent_vector<Type, Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_reference persistent_vector<Type, Allocator>::back() const {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_iterator persistent_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_iterator persistent_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_iterator persistent_vector<Type, Allocator>::cbegin() const noexcept {
+        return begin();
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::const_iterator persistent_vector<Type, Allocator>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_new_path(unsigned shift, Value&& value, std::uint64_t owner) const {
+        _m_node_ptr node = _m_new_node(owner);
+        if (owner != 0) node->values.reserve(BRANCHING);
+        node->values.emplace_back(std::forward<Value>(value));
+        for (unsigned level = 0; level < shift; level += BITS) {
+            _m_node_ptr parent = _m_new_node(owner);
+            parent->children.emplace_back(std::move(node));
+            parent->sizes.emplace_back(size_type(1));
+            node = std::move(parent);
+        }
+        return node;
+    }
+
+    //the edited node with value appended, or nullptr when the subtree has no room
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_push_into(const _m_node_ptr& node, unsigned shift, Value&& value, std::uint64_t owner) const {
+        if (shift == 0) {
+            if (node->values.size() == BRANCHING) return nullptr;
+            _m_node_ptr edit = _m_editable(node, owner);
+            edit->values.emplace_back(std::forward<Value>(value));
+            return edit;
+        }
+        _m_node_ptr child = _m_push_into(node->children.back(), shift - BITS, std::forward<Value>(value), owner);
+        if (child) {
+            _m_node_ptr edit = _m_editable(node, owner);
+            edit->children.back() = std::move(child);
+            ++edit->sizes.back();
+            return edit;
+        }
+        if (node->children.size() == BRANCHING) return nullptr;
+        _m_node_ptr edit = _m_editable(node, owner);
+        edit->children.emplace_back(_m_new_path(shift - BITS, std::forward<Value>(value), owner));
+        edit->sizes.emplace_back(edit->sizes.back() + 1);
+        return edit;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    void persistent_vector<Type, Allocator>::_m_push(Value&& value, std::uint64_t owner) {
+        if (!_m_root) {
+            _m_root = _m_new_path(0, std::forward<Value>(value), owner);
+            _m_shift = 0;
+        } else if (_m_node_ptr pushed = _m_push_into(_m_root, _m_shift, std::forward<Value>(value), owner)) {
+            _m_root = std::move(pushed);
+        } else {
+            _m_node_ptr root = _m_new_node(owner);
+            root->children.emplace_back(_m_root);
+            root->sizes.emplace_back(size_type(_m_size));
+            root->children.emplace_back(_m_new_path(_m_shift, std::forward<Value>(value), owner));
+            root->sizes.emplace_back(_m_size + 1);
+            _m_root = std::move(root);
+            _m_shift += BITS;
+        }
+        ++_m_size;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_assign_in(const _m_node_ptr& node, unsigned shift, size_type index, Value&& value, std::uint64_t owner) const {
+        if (shift == 0) {
+            _m_node_ptr edit = _m_editable(node, owner);
+            edit->values[index] = std::forward<Value>(value);
+            return edit;
+        }
+        size_type child = _m_child_index(*node, shift, index);
+        _m_node_ptr edited_child = _m_assign_in(node->children[child], shift - BITS, index, std::forward<Value>(value), owner);
+        _m_node_ptr edit = _m_editable(node, owner);
+        edit->children[child] = std::move(edited_child);
+        return edit;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    void persistent_vector<Type, Allocator>::_m_assign(size_type pos, Value&& value, std::uint64_t owner) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        _m_root = _m_assign_in(_m_root, _m_shift, pos, std::forward<Value>(value), owner);
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    persistent_vector<Type, Allocator> persistent_vector<Type, Allocator>::push_back(Value&& value) const {
+        persistent_vector result(*this);
+        result._m_push(std::forward<Value>(value), 0);
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Value>
+    persistent_vector<Type, Allocator> persistent_vector<Type, Allocator>::set(size_type pos, Value&& value) const {
+        persistent_vector result(*this);
+        result._m_assign(pos, std::forward<Value>(value), 0);
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator> persistent_vector<Type, Allocator>::pop_back() const {
+        return slice(0, _m_size ? _m_size - 1 : 0);
+    }
+
+    //first count elements of node, 0 < count
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_take(const _m_node_ptr& node, unsigned shift, size_type count) const {
+        if (count == _m_count(*node, shift)) return node;
+        _m_node_ptr result = _m_new_node(0);
+        if (shift == 0) {
+            const Type* first = node->values.data();
+            result->values = vector<Type, Allocator>(first, first + count, _m_allocator);
+            return result;
+        }
+        size_type last_index = count - 1;
+        size_type child = _m_child_index(*node, shift, last_index);
+        for (size_type i = 0; i < child; ++i) {
+            result->children.emplace_back(node->children[i]);
+            result->sizes.emplace_back(node->sizes[i]);
+        }
+        result->children.emplace_back(_m_take(node->children[child], shift - BITS, last_index + 1));
+        result->sizes.emplace_back(size_type(count));
+        return result;
+    }
+
+    //node without its first count elements, count < size of node
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::_m_node_ptr
+    persistent_vector<Type, Allocator>::_m_drop(const _m_node_ptr& node, unsigned shift, size_type count) const {
+        if (count == 0) return node;
+        _m_node_ptr result = _m_new_node(0);
+        if (shift == 0) {
+            const Type* first = node->values.data();
+            result->values = vector<Type, Allocator>(first + count, first + node->values.size(), _m_allocator);
+            return result;
+        }
+        size_type in_child = count;
+        size_type child = _m_child_index(*node, shift, in_child);
+        result->children.emplace_back(_m_drop(node->children[child], shift - BITS, in_child));
+        for (size_type i = child; i < node->children.size(); ++i) {
+            if (i != child) result->children.emplace_back(node->children[i]);
+            result->sizes.emplace_back(node->sizes[i] - count);
+        }
+        return result;
+    }
+
+    //inner roots with a single child are replaced by it
+    template<typename Type, typename Allocator>
+    void persistent_vector<Type, Allocator>::_m_collapse() {
+        while (_m_shift > 0 && _m_root->children.size() == 1) {
+            _m_node_ptr child = _m_root->children[0];
+            _m_root = std::move(child);
+            _m_shift -= BITS;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator> persistent_vector<Type, Allocator>::slice(size_type from, size_type to) const {
+        if (from > to || to > _m_size) throw std::out_of_range("Out of range");
+        persistent_vector result(_m_allocator);
+        if (from == to) return result;
+        result._m_root = _m_drop(_m_take(_m_root, _m_shift, to), _m_shift, from);
+        result._m_shift = _m_shift;
+        result._m_size = to - from;
+        result._m_collapse();
+        return result;
+    }
+
+    //Joins the right spine of left with the left spine of right, both at shift. The nodes meeting at
+    //every level are merged into one node, or split evenly into two when they do not fit, so repeated
+    //concatenation on either side keeps the seam at least half full like a B-tree; returns the
+    //merged node and the second half, if any.
+    template<typename Type, typename Allocator>
+    std::pair<typename persistent_vector<Type, Allocator>::_m_node_ptr, typename persistent_vector<Type, Allocator>::_m_node_ptr>
+    persistent_vector<Type, Allocator>::_m_merge(const _m_node_ptr& left, const _m_node_ptr& right, unsigned shift) const {
+        if (shift == 0) {
+            size_type left_size = left->values.size(), total = left_size + right->values.size();
+            if (left_size == BRANCHING) return std::make_pair(left, right);
+            size_type first_size = total <= BRANCHING ? total : (total + 1) / 2;
+            _m_node_ptr halves[2] = {_m_new_node(0), total <= BRANCHING ? _m_node_ptr() : _m_new_node(0)};
+            halves[0]->values.reserve(first_size);
+            if (halves[1]) halves[1]->values.reserve(total - first_size);
+            for (size_type i = 0; i < total; ++i) {
+                const Type& value = i < left_size ? left->values[i] : right->values[i - left_size];
+                halves[i < first_size ? 0 : 1]->values.emplace_back(value);
+            }
+            return std::make_pair(halves[0], halves[1]);
+        }
+
+        std::pair<_m_node_ptr, _m_node_ptr> seam = _m_merge(left->children.back(), right->children[0], shift - BITS);
+        vector<_m_node_ptr> children;
+        children.reserve(2 * BRANCHING);
+        for (size_type i = 0; i + 1 < left->children.size(); ++i) children.emplace_back(_m_node_ptr(left->children[i]));
+        children.emplace_back(std::move(seam.first));
+        if (seam.second) children.emplace_back(std::move(seam.second));
+        for (size_type i = 1; i < right->children.size(); ++i) children.emplace_back(_m_node_ptr(right->children[i]));
+
+        if (children.size() <= BRANCHING) return std::make_pair(_m_inner(children, 0, children.size(), shift), _m_node_ptr());
+        size_type first_size = (children.size() + 1) / 2;
+        return std::make_pair(_m_inner(children, 0, first_size, shift), _m_inner(children, first_size, children.size(), shift));
+    }
+
+    template<typename Type, typename Allocator>
+    persistent_vector<Type, Allocator> persistent_vector<Type, Allocator>::concat(const persistent_vector& other) const {
+        if (other.empty()) return *this;
+        if (empty()) return other;
+
+        //the lower tree is raised to the same height under single child nodes, which the merge absorbs
+        unsigned shift = std::max(_m_shift, other._m_shift);
+        _m_node_ptr roots[2] = {_m_root, other._m_root};
+        unsigned shifts[2] = {_m_shift, other._m_shift};
+        size_type sizes[2] = {_m_size, other._m_size};
+        for (int side = 0; side < 2; ++side) {
+            for (; shifts[side] < shift; shifts[side] += BITS) {
+                _m_node_ptr parent = _m_new_node(0);
+                parent->children.emplace_back(std::move(roots[side]));
+                parent->sizes.emplace_back(size_type(sizes[side]));
+                roots[side] = std::move(parent);
+            }
+        }
+
+        std::pair<_m_node_ptr, _m_node_ptr> merged = _m_merge(roots[0], roots[1], shift);
+        persistent_vector result(_m_allocator);
+        result._m_size = _m_size + other._m_size;
+        result._m_shift = shift;
+        if (merged.second) {
+            vector<_m_node_ptr> top;
+            top.emplace_back(std::move(merged.first));
+            top.emplace_back(std::move(merged.second));
+            result._m_shift += BITS;
+            result._m_root = _m_inner(top, 0, 2, result._m_shift);
+        } else {
+            result._m_root = std::move(merged.first);
+        }
+        result._m_collapse();
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::transient_vector persistent_vector<Type, Allocator>::transient() const {
+        return transient_vector(*this);
+    }
+
+    template<typename Type, typename Allocator>
+    void persistent_vector<Type, Allocator>::_m_append_leaves(const _m_node& node, unsigned shift, vector<Type, Allocator>& out) const {
+        if (shift == 0) {
+            for (size_type i = 0; i < node.values.size(); ++i) out.emplace_back(node.values[i]);
+            return;
+        }
+        for (size_type i = 0; i < node.children.size(); ++i) _m_append_leaves(*node.children[i], shift - BITS, out);
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator> persistent_vector<Type, Allocator>::to_vector() const {
+        vector<Type, Allocator> result(_m_allocator);
+        result.reserve(_m_size);
+        if (_m_root) _m_append_leaves(*_m_root, _m_shift, result);
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    typename persistent_vector<Type, Allocator>::allocator_type persistent_vector<Type, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template <class Type, class Allocator>
+    bool operator==(const persistent_vector<Type, Allocator>& lhs, const persistent_vector<Type, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Type, class Allocator>
+    bool operator!=(const persistent_vector<Type, Allocator>& lhs, const persistent_vector<Type, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace art{
+
+    //what happened during one push_back/emplace_back/insert call
+    struct growth_trace_event{
+        std::size_t   old_capacity;
+        std::size_t   new_capacity;
+        std::size_t   elements_moved;   //elements relocated by growth, 0 if no reallocation
+        std::uint64_t nanoseconds;
+    };
+
+    //HDR-style histogram: values below 2^(SUB_BUCKET_BITS + 1) are exact, above that
+    //every power of two is split into 2^SUB_BUCKET_BITS linear sub-buckets (~3% error)
+    class latency_histogram{
+    public:
+        static const unsigned SUB_BUCKET_BITS = 5;
+        static const std::size_t SUB_BUCKET_COUNT = std::size_t(1) << SUB_BUCKET_BITS;
+        static const std::size_t BUCKET_COUNT = (65 - SUB_BUCKET_BITS) * SUB_BUCKET_COUNT;
+
+        latency_histogram() noexcept;
+
+        void record(std::uint64_t value) noexcept;
+        void reset() noexcept;
+
+        std::uint64_t count() const noexcept;
+        std::uint64_t min() const noexcept;
+        std::uint64_t max() const noexcept;
+
+        //highest value equivalent to the value at given percentile (0..100)
+        std::uint64_t value_at_percentile(double percentile) const noexcept;
+
+    private:
+        std::array<std::uint64_t, BUCKET_COUNT> _m_counts;
+        std::uint64_t _m_total;
+        std::uint64_t _m_min;
+        std::uint64_t _m_max;
+
+        static unsigned _m_log2(std::uint64_t value) noexcept;
+        static std::size_t _m_index_of(std::uint64_t value) noexcept;
+        static std::uint64_t _m_highest_equivalent(std::size_t index) noexcept;
+    };
+
+    //opt-in per container hook, see vector::set_push_hook (built with ART_VECTOR_PUSH_LATENCY)
+    class push_latency_hook{
+    public:
+        typedef std::function<void(const growth_trace_event&)> trace_callback;
+
+        explicit push_latency_hook(std::chrono::nanoseconds threshold = std::chrono::microseconds(10),
+                                   trace_callback on_trace = trace_callback());
+
+        void set_threshold(std::chrono::nanoseconds threshold) noexcept;
+        std::chrono::nanoseconds threshold() const noexcept;
+
+        //called for every operation slower than threshold, must not throw
+        void set_trace_callback(trace_callback on_trace);
+
+        void record(const growth_trace_event& event);
+        const latency_histogram& histogram() const noexcept;
+        void reset() noexcept;
+
+    private:
+        std::chrono::nanoseconds _m_threshold;
+        trace_callback _m_on_trace;
+        latency_histogram _m_histogram;
+    };
+
+    inline latency_histogram::latency_histogram() noexcept {
+        reset();
+    }
+
+    inline unsigned latency_histogram::_m_log2(std::uint64_t value) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+        return 63 - __builtin_clzll(value);
+#else
+        unsigned result = 0;
+        while (value >>= 1) ++result;
+        return result;
+#endif
+    }
+
+    inline std::size_t latency_histogram::_m_index_of(std::uint64_t value) noexcept {
+        if (value < 2 * SUB_BUCKET_COUNT) return value;
+        unsigned magnitude = _m_log2(value);
+        std::size_t sub_bucket = (value >> (magnitude - SUB_BUCKET_BITS)) - SUB_BUCKET_COUNT;
+        return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT + sub_bucket;
+    }
+
+    inline std::uint64_t latency_histogram::_m_highest_equivalent(std::size_t index) noexcept {
+        if (index < 2 * SUB_BUCKET_COUNT) return index;
+        unsigned magnitude = index / SUB_BUCKET_COUNT + SUB_BUCKET_BITS - 1;
+        unsigned shift = magnitude - SUB_BUCKET_BITS;
+        std::uint64_t lowest = std::uint64_t(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+        return lowest + ((std::uint64_t(1) << shift) - 1);
+    }
+
+    inline void latency_histogram::record(std::uint64_t value) noexcept {
+        ++_m_counts[_m_index_of(value)];
+        ++_m_total;
+        if (value < _m_min) _m_min = value;
+        if (value > _m_max) _m_max = value;
+    }
+
+    inline void latency_histogram::reset() noexcept {
+        _m_counts.fill(0);
+        _m_total = 0;
+        _m_min = UINT64_MAX;
+        _m_max = 0;
+    }
+
+    inline std::uint64_t latency_histogram::count() const noexcept {
+        return _m_total;
+    }
+
+    inline std::uint64_t latency_histogram::min() const noexcept {
+        return _m_total == 0 ? 0 : _m_min;
+    }
+
+    inline std::uint64_t latency_histogram::max() const noexcept {
+        return _m_max;
+    }
+
+    inline std::uint64_t latency_histogram::value_at_percentile(double percentile) const noexcept {
+        if (_m_total == 0) return 0;
+        if (percentile > 100.0) percentile = 100.0;
+        std::uint64_t wanted = (std::uint64_t)(percentile / 100.0 * _m_total + 0.5);
+        if (wanted == 0) wanted = 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += _m_counts[i];
+            if (seen >= wanted) {
+                std::uint64_t value = _m_highest_equivalent(i);
+                return value < _m_max ? value : _m_max;
+            }
+        }
+        return _m_max;
+    }
+
+    inline push_latency_hook::push_latency_hook(std::chrono::nanoseconds threshold, trace_callback on_trace)
+        : _m_threshold(threshold), _m_on_trace(std::move(on_trace)) {}
+
+    inline void push_latency_hook::set_threshold(std::chrono::nanoseconds threshold) noexcept {
+        _m_threshold = threshold;
+    }
+
+    inline std::chrono::nanoseconds push_latency_hook::threshold() const noexcept {
+        return _m_threshold;
+    }
+
+    inline void push_latency_hook::set_trace_callback(trace_callback on_trace) {
+        _m_on_trace = std::move(on_trace);
+    }
+
+    inline void push_latency_hook::record(const growth_trace_event& event) {
+        _m_histogram.record(event.nanoseconds);
+        if (_m_on_trace && event.nanoseconds > (std::uint64_t)_m_threshold.count()) _m_on_trace(event);
+    }
+
+    inline const latency_histogram& push_latency_hook::histogram() const noexcept {
+        return _m_histogram;
+    }
+
+    inline void push_latency_hook::reset() noexcept {
+        _m_histogram.reset();
+    }
+}
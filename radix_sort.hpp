@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    //Maps a sortable element to an unsigned integer with the same ordering. Provided for integers,
+    //floating point and std::pair<Key, Payload> (ordered by Key only); specialize for other types.
+    template <typename Type, typename Enable = void>
+    struct radix_key;
+
+    template <typename Type>
+    struct radix_key<Type, typename std::enable_if<std::is_integral<Type>::value && std::is_unsigned<Type>::value &&
+                                                   !std::is_same<Type, bool>::value>::type>{
+        typedef Type bits_type;
+        static bits_type bits(Type value) noexcept { return value; }
+    };
+
+    template <typename Type>
+    struct radix_key<Type, typename std::enable_if<std::is_integral<Type>::value && std::is_signed<Type>::value>::type>{
+        typedef typename std::make_unsigned<Type>::type bits_type;
+        static bits_type bits(Type value) noexcept {
+            return bits_type(value) ^ (bits_type(1) << (std::numeric_limits<bits_type>::digits - 1));
+        }
+    };
+
+    template <typename Type>
+    struct radix_key<Type, typename std::enable_if<std::is_floating_point<Type>::value>::type>{
+        typedef typename std::conditional<sizeof(Type) == 4, std::uint32_t, std::uint64_t>::type bits_type;
+        static_assert(sizeof(Type) == sizeof(bits_type), "radix_sort supports 32 and 64 bit floating point");
+
+        //negative values have every bit flipped, positive ones only the sign bit
+        static bits_type bits(Type value) noexcept {
+            bits_type raw;
+            std::memcpy(&raw, &value, sizeof(raw));
+            const bits_type sign = bits_type(1) << (std::numeric_limits<bits_type>::digits - 1);
+            return (raw & sign) ? ~raw : (raw | sign);
+        }
+    };
+
+    template <typename Key, typename Payload>
+    struct radix_key<std::pair<Key, Payload>>{
+        typedef typename radix_key<Key>::bits_type bits_type;
+        static bits_type bits(const std::pair<Key, Payload>& value) noexcept { return radix_key<Key>::bits(value.first); }
+    };
+
+    //below this many elements radix_sort uses std::stable_sort on the keys
+    const std::size_t RADIX_SORT_THRESHOLD = 256;
+
+    //Stable LSD radix sort: one counting pass builds the histograms of all digits, digits are 8 bits
+    //for keys up to 16 bits and 11 bits otherwise, and passes whose digit is the same for every key
+    //are skipped. The scratch buffer comes from the vector's allocator.
+    template <typename Type, typename Allocator>
+    void radix_sort(vector<Type, Allocator>& values);
+
+    namespace detail{
+        template <typename Bits>
+        struct radix_digits{
+            static const unsigned BITS = sizeof(Bits) <= 2 ? 8 : 11;
+            static const std::size_t RADIX = std::size_t(1) << BITS;
+            static const unsigned PASSES = (sizeof(Bits) * 8 + BITS - 1) / BITS;
+
+            static std::size_t digit(Bits bits, unsigned pass) noexcept {
+                return std::size_t(bits >> (pass * BITS)) & (RADIX - 1);
+            }
+        };
+    }
+
+    template <typename Type, typename Allocator>
+    void radix_sort(vector<Type, Allocator>& values) {
+        typedef radix_key<Type> key;
+        typedef typename key::bits_type bits_type;
+        typedef detail::radix_digits<bits_type> digits;
+        typedef std::allocator_traits<Allocator> traits;
+
+        const std::size_t count = values.size();
+        if (count < RADIX_SORT_THRESHOLD) {
+            std::stable_sort(values.begin(), values.end(), [](const Type& a, const Type& b) {
+                return key::bits(a) < key::bits(b);
+            });
+            return;
+        }
+
+        std::unique_ptr<std::size_t[]> histograms(new std::size_t[digits::PASSES * digits::RADIX]());
+        Type* data = values.data();
+        for (std::size_t i = 0; i < count; ++i) {
+            bits_type bits = key::bits(data[i]);
+            for (unsigned pass = 0; pass < digits::PASSES; ++pass) {
+                ++histograms[pass * digits::RADIX + digits::digit(bits, pass)];
+            }
+        }
+
+        unsigned needed = 0;
+        bool needed_passes[digits::PASSES];
+        for (unsigned pass = 0; pass < digits::PASSES; ++pass) {
+            std::size_t* histogram = histograms.get() + pass * digits::RADIX;
+            needed_passes[pass] = std::find(histogram, histogram + digits::RADIX, count) == histogram + digits::RADIX;
+            if (needed_passes[pass]) ++needed;
+        }
+        if (needed == 0) return;
+
+        Allocator allocator = values.get_allocator();
+        Type* scratch = traits::allocate(allocator, count);
+        Type* source = data;
+        Type* destination = scratch;
+        bool scratch_constructed = false;
+        for (unsigned pass = 0; pass < digits::PASSES; ++pass) {
+            if (!needed_passes[pass]) continue;
+            std::size_t* offsets = histograms.get() + pass * digits::RADIX;
+            std::size_t running = 0;
+            for (std::size_t d = 0; d < digits::RADIX; ++d) {
+                std::size_t size = offsets[d];
+                offsets[d] = running;
+                running += size;
+            }
+            if (scratch_constructed) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    destination[offsets[digits::digit(key::bits(source[i]), pass)]++] = std::move(source[i]);
+                }
+            } else {
+                //the first pass fills every slot of scratch exactly once
+                for (std::size_t i = 0; i < count; ++i) {
+                    traits::construct(allocator, destination + offsets[digits::digit(key::bits(source[i]), pass)]++,
+                                      std::move(source[i]));
+                }
+                scratch_constructed = true;
+            }
+            std::swap(source, destination);
+        }
+        if (source != data) std::move(source, source + count, data);
+
+        for (std::size_t i = 0; i < count; ++i) traits::destroy(allocator, scratch + i);
+        traits::deallocate(allocator, scratch, count);
+    }
+}
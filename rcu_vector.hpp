@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "concurrent_vector.hpp"
+#include "thread_slots.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Read-mostly vector: readers pin an immutable snapshot without locks, writers copy it, modify the
+    //copy and publish it with one atomic exchange. Replaced snapshots are freed by epoch based
+    //reclamation: every reading thread owns a padded slot holding the epoch it entered at, so a read
+    //only stores to the reader's own cache line and never touches a shared reference count.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class rcu_vector{
+    private:
+        struct _m_reader_slot{
+            //epoch the thread pinned, 0 while it reads nothing
+            std::atomic<std::uint64_t> epoch;
+            //guards alive on the owning thread, only touched by that thread
+            std::size_t depth;
+            char padding[64];
+
+            _m_reader_slot() : epoch(0), depth(0) {}
+        };
+
+    public:
+        typedef vector<Type, Allocator> snapshot_type;
+        typedef std::size_t             size_type;
+
+        //keeps the snapshot current at its creation alive; nests, and must be destroyed on the
+        //thread that created it
+        class read_guard{
+        public:
+            read_guard(read_guard&& other) noexcept : _m_slot(other._m_slot), _m_snapshot(other._m_snapshot) {
+                other._m_slot = nullptr;
+            }
+            read_guard(const read_guard&) = delete;
+            read_guard& operator=(const read_guard&) = delete;
+            read_guard& operator=(read_guard&&) = delete;
+            ~read_guard() {
+                if (_m_slot && --_m_slot->depth == 0) _m_slot->epoch.store(0, std::memory_order_release);
+            }
+
+            const snapshot_type& operator*() const noexcept {return *_m_snapshot;}
+            const snapshot_type* operator->() const noexcept {return _m_snapshot;}
+            const snapshot_type& get() const noexcept {return *_m_snapshot;}
+
+        private:
+            friend class rcu_vector;
+            read_guard(_m_reader_slot* slot, const snapshot_type* snapshot) noexcept : _m_slot(slot), _m_snapshot(snapshot) {}
+
+            _m_reader_slot* _m_slot;
+            const snapshot_type* _m_snapshot;
+        };
+
+        explicit rcu_vector(const Allocator& alloc = Allocator());
+        explicit rcu_vector(snapshot_type initial);
+        //no reader may be left
+        ~rcu_vector();
+
+        rcu_vector(const rcu_vector&) = delete;
+        rcu_vector& operator=(const rcu_vector&) = delete;
+
+        //wait-free once the calling thread has read this vector before
+        read_guard read() const;
+
+        //fn(snapshot_type& copy) edits a copy of the current snapshot, which is then published;
+        //writers are serialized
+        template <typename Function>
+        void update(Function fn);
+
+        //publishes replacement as the new snapshot
+        void assign(snapshot_type replacement);
+
+        //frees replaced snapshots no reader can still see, returns how many are left
+        size_type reclaim();
+        size_type retired() const;
+
+    private:
+        struct _m_retired_snapshot{
+            snapshot_type* snapshot;
+            std::uint64_t epoch;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<snapshot_type> _m_snapshot_allocator;
+        typedef std::allocator_traits<_m_snapshot_allocator> _m_snapshot_traits;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_reader_slot> _m_reader_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_retired_snapshot> _m_retired_allocator;
+
+        Allocator _m_allocator;
+        std::atomic<snapshot_type*> _m_current;
+        std::atomic<std::uint64_t> _m_epoch;
+        detail::instance_id _m_id;
+        mutable concurrent_vector<_m_reader_slot, _m_reader_allocator> _m_readers;
+        mutable std::mutex _m_writer;
+        vector<_m_retired_snapshot, _m_retired_allocator> _m_retired;
+
+        template< class... Args >
+        snapshot_type* _m_make_snapshot(Args&&... args) const;
+        void _m_free_snapshot(snapshot_type* snapshot) const noexcept;
+        void _m_publish(snapshot_type* replacement);
+        size_type _m_reclaim();
+    };
+
+    template<typename Type, typename Allocator>
+    rcu_vector<Type, Allocator>::rcu_vector(const Allocator& alloc) : rcu_vector(snapshot_type(alloc)) {}
+
+    template<typename Type, typename Allocator>
+    rcu_vector<Type, Allocator>::rcu_vector(snapshot_type initial)
+        : _m_allocator(initial.get_allocator()), _m_current(_m_make_snapshot(std::move(initial), _m_allocator)), _m_epoch(1),
+          _m_readers(_m_reader_allocator(_m_allocator)), _m_retired(_m_retired_allocator(_m_allocator)) {}
+
+    template<typename Type, typename Allocator>
+    rcu_vector<Type, Allocator>::~rcu_vector() {
+        for (size_type i = 0; i < _m_retired.size(); ++i) _m_free_snapshot(_m_retired[i].snapshot);
+        _m_free_snapshot(_m_current.load());
+    }
+
+    //snapshot objects come from the vector's allocator like their elements
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename rcu_vector<Type, Allocator>::snapshot_type* rcu_vector<Type, Allocator>::_m_make_snapshot(Args&&... args) const {
+        _m_snapshot_allocator snapshot_allocator(_m_allocator);
+        snapshot_type* snapshot = _m_snapshot_traits::allocate(snapshot_allocator, 1);
+        try {
+            _m_snapshot_traits::construct(snapshot_allocator, snapshot, std::forward<Args>(args)...);
+        } catch (...) {
+            _m_snapshot_traits::deallocate(snapshot_allocator, snapshot, 1);
+            throw;
+        }
+        return snapshot;
+    }
+
+    template<typename Type, typename Allocator>
+    void rcu_vector<Type, Allocator>::_m_free_snapshot(snapshot_type* snapshot) const noexcept {
+        _m_snapshot_allocator snapshot_allocator(_m_allocator);
+        _m_snapshot_traits::destroy(snapshot_allocator, snapshot);
+        _m_snapshot_traits::deallocate(snapshot_allocator, snapshot, 1);
+    }
+
+    template<typename Type, typename Allocator>
+    typename rcu_vector<Type, Allocator>::read_guard rcu_vector<Type, Allocator>::read() const {
+        _m_reader_slot& slot = _m_readers[detail::thread_local_index(_m_id.value(), _m_readers)];
+        if (slot.depth++ == 0) slot.epoch.store(_m_epoch.load());
+        //sequentially consistent with the writer's exchange and slot scan: either the writer sees
+        //this epoch, or this load sees the new snapshot
+        return read_guard(&slot, _m_current.load());
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Function>
+    void rcu_vector<Type, Allocator>::update(Function fn) {
+        std::lock_guard<std::mutex> lock(_m_writer);
+        snapshot_type* copy = _m_make_snapshot(*_m_current.load(), _m_allocator);
+        try {
+            fn(*copy);
+        } catch (...) {
+            _m_free_snapshot(copy);
+            throw;
+        }
+        _m_publish(copy);
+    }
+
+    template<typename Type, typename Allocator>
+    void rcu_vector<Type, Allocator>::assign(snapshot_type replacement) {
+        snapshot_type* fresh = _m_make_snapshot(std::move(replacement), _m_allocator);
+        std::lock_guard<std::mutex> lock(_m_writer);
+        _m_publish(fresh);
+    }
+
+    template<typename Type, typename Allocator>
+    typename rcu_vector<Type, Allocator>::size_type rcu_vector<Type, Allocator>::reclaim() {
+        std::lock_guard<std::mutex> lock(_m_writer);
+        return _m_reclaim();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rcu_vector<Type, Allocator>::size_type rcu_vector<Type, Allocator>::retired() const {
+        std::lock_guard<std::mutex> lock(_m_writer);
+        return _m_retired.size();
+    }
+
+    //readers that pinned an epoch up to the retire epoch may still hold the old snapshot
+    template<typename Type, typename Allocator>
+    void rcu_vector<Type, Allocator>::_m_publish(snapshot_type* replacement) {
+        snapshot_type* old = _m_current.exchange(replacement);
+        _m_retired.push_back(_m_retired_snapshot{old, _m_epoch.fetch_add(1)});
+        _m_reclaim();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rcu_vector<Type, Allocator>::size_type rcu_vector<Type, Allocator>::_m_reclaim() {
+        std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+        for (const _m_reader_slot& slot : _m_readers) {
+            std::uint64_t epoch = slot.epoch.load();
+            if (epoch != 0 && epoch < oldest) oldest = epoch;
+        }
+        size_type kept = 0;
+        for (size_type i = 0; i < _m_retired.size(); ++i) {
+            if (_m_retired[i].epoch < oldest) _m_free_snapshot(_m_retired[i].snapshot);
+            else _m_retired[kept++] = _m_retired[i];
+        }
+        _m_retired.resize(kept);
+        return kept;
+    }
+}
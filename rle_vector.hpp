@@ -0,0 +1,356 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //length of the run of first[0] at the start of [first, first + count), count > 0
+        template <typename Type>
+        std::size_t run_length(const Type* first, std::size_t count) {
+            const std::size_t BLOCK = 32;
+            const Type& value = first[0];
+            std::size_t length = 1;
+            //whole blocks compare with a fixed trip count and no early exit, so arithmetic types vectorize
+            while (length + BLOCK <= count) {
+                unsigned differs = 0;
+                const Type* block = first + length;
+                for (std::size_t i = 0; i < BLOCK; ++i) differs |= unsigned(!(block[i] == value));
+                if (differs) break;
+                length += BLOCK;
+            }
+            while (length < count && first[length] == value) ++length;
+            return length;
+        }
+    }
+
+    //Run length encoded vector: each run of equal values is stored once, together with the index one
+    //past its last element. Random access binary searches the run ends, iterators remember their run so
+    //sequential scans are O(1) per element, and runs() walks the runs themselves. Appending a value equal
+    //to the last one only extends the last run.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class rle_vector{
+    public:
+        typedef Type                                                                             value_type;
+        typedef Allocator                                                                        allocator_type;
+        typedef const value_type&                                                                const_reference;
+        typedef const value_type&                                                                reference;
+        typedef std::size_t                                                                      size_type;
+        typedef std::ptrdiff_t                                                                   difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>      size_allocator;
+
+        //one run, the elements [first, last)
+        struct run_type{
+            const Type& value;
+            size_type first;
+            size_type last;
+
+            size_type length() const noexcept {return last - first;}
+        };
+
+        template<typename ContainerT>
+        class value_iterator : public std::iterator<std::random_access_iterator_tag, Type, difference_type, const Type*, const Type&> {
+        public:
+            typedef const Type& reference;
+            typedef const Type* pointer;
+
+            value_iterator() : _container(nullptr), _index(0), _run(0) {}
+            value_iterator(ContainerT* container, size_type index) : _container(container), _index(index), _run(container->run_of(index)) {}
+
+            inline value_iterator& operator+=(difference_type rhs) {_index += rhs; _run = _container->run_of(_index); return *this;}
+            inline value_iterator& operator-=(difference_type rhs) {return *this += -rhs;}
+            inline reference operator*() const {return _container->_m_values[_run];}
+            inline reference operator[](difference_type rhs) const {return (*_container)[_index + rhs];}
+            inline pointer   operator->() const {return &_container->_m_values[_run];}
+
+            inline value_iterator& operator++() {
+                if (++_index == _container->_m_ends[_run]) ++_run;
+                return *this;
+            }
+            inline value_iterator& operator--() {
+                if (_run > 0 && _index == _container->_m_ends[_run - 1]) --_run;
+                --_index;
+                return *this;
+            }
+            inline value_iterator  operator++(int) {value_iterator tmp(*this); ++*this; return tmp;}
+            inline value_iterator  operator--(int) {value_iterator tmp(*this); --*this; return tmp;}
+            inline value_iterator  operator+(difference_type rhs) const {value_iterator tmp(*this); return tmp += rhs;}
+            inline value_iterator  operator-(difference_type rhs) const {value_iterator tmp(*this); return tmp -= rhs;}
+
+            friend inline value_iterator operator+(difference_type lhs, const value_iterator& rhs) {return rhs + lhs;}
+            friend inline difference_type operator-(const value_iterator& lhs, const value_iterator& rhs) {return difference_type(lhs._index - rhs._index);}
+            friend inline bool operator==(const value_iterator& lhs, const value_iterator& rhs) {return lhs._index == rhs._index;}
+            friend inline bool operator!=(const value_iterator& lhs, const value_iterator& rhs) {return lhs._index != rhs._index;}
+            friend inline bool operator<(const value_iterator& lhs, const value_iterator& rhs)  {return lhs._index < rhs._index;}
+            friend inline bool operator>(const value_iterator& lhs, const value_iterator& rhs)  {return lhs._index > rhs._index;}
+            friend inline bool operator<=(const value_iterator& lhs, const value_iterator& rhs) {return lhs._index <= rhs._index;}
+            friend inline bool operator>=(const value_iterator& lhs, const value_iterator& rhs) {return lhs._index >= rhs._index;}
+
+            ContainerT* container() const noexcept {return _container;}
+            size_type index() const noexcept {return _index;}
+            //run holding the current element
+            size_type run() const noexcept {return _run;}
+        private:
+            ContainerT* _container;
+            size_type _index;
+            size_type _run;
+        };
+
+    private:
+        struct _m_run_access{
+            run_type operator()(const rle_vector& container, size_type index) const {return container.run(index);}
+        };
+
+    public:
+        typedef value_iterator<const rle_vector>                                             const_iterator;
+        typedef const_iterator                                                               iterator;
+        typedef detail::index_iterator<const rle_vector, run_type, run_type, _m_run_access>  const_run_iterator;
+
+        //begin and end of the runs, for range-for
+        struct run_range{
+            const_run_iterator first;
+            const_run_iterator last;
+
+            const_run_iterator begin() const noexcept {return first;}
+            const_run_iterator end() const noexcept {return last;}
+            size_type size() const noexcept {return size_type(last - first);}
+        };
+
+        // construct/copy/destroy
+        explicit rle_vector(const Allocator& alloc = Allocator());
+        //encodes values, finding run boundaries a block at a time
+        explicit rle_vector(const vector<Type, Allocator>& values);
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        rle_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        rle_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+
+        allocator_type get_allocator() const;
+
+        const_reference operator[](size_type pos) const;
+        const_reference at(size_type pos) const;
+        const_reference front() const;
+        const_reference back() const;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        // runs
+        run_range runs() const noexcept;
+        run_type run(size_type index) const;
+        size_type run_count() const noexcept;
+        //index of the run holding pos, run_count() for pos == size()
+        size_type run_of(size_type pos) const;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        void clear() noexcept;
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        //appends count copies of value
+        void append_run(const Type& value, size_type count);
+        void pop_back();
+        void swap(rle_vector& other) noexcept;
+
+        vector<Type, Allocator> to_vector() const;
+
+    private:
+        vector<Type, Allocator> _m_values;
+        //one past the last element of each run, strictly increasing
+        vector<size_type, size_allocator> _m_ends;
+    };
+
+    template<typename Type, typename Allocator>
+    rle_vector<Type, Allocator>::rle_vector(const Allocator& alloc) : _m_values(alloc), _m_ends(size_allocator(alloc)) {}
+
+    template<typename Type, typename Allocator>
+    rle_vector<Type, Allocator>::rle_vector(const vector<Type, Allocator>& values) : rle_vector(values.get_allocator()) {
+        const Type* data = values.data();
+        size_type count = values.size();
+        for (size_type pos = 0; pos < count;) {
+            size_type length = detail::run_length(data + pos, count - pos);
+            _m_values.emplace_back(data[pos]);
+            _m_ends.emplace_back(pos + length);
+            pos += length;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    template<class InputIt, class>
+    rle_vector<Type, Allocator>::rle_vector(InputIt first, InputIt last, const Allocator& alloc) : rle_vector(alloc) {
+        for (; first != last; ++first) push_back(*first);
+    }
+
+    template<typename Type, typename Allocator>
+    rle_vector<Type, Allocator>::rle_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : rle_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::allocator_type rle_vector<Type, Allocator>::get_allocator() const {
+        return _m_values.get_allocator();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_reference rle_vector<Type, Allocator>::operator[](size_type pos) const {
+        return _m_values[run_of(pos)];
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_reference rle_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_reference rle_vector<Type, Allocator>::front() const {
+        return _m_values.front();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_reference rle_vector<Type, Allocator>::back() const {
+        return _m_values.back();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_iterator rle_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_iterator rle_vector<Type, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_iterator rle_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::const_iterator rle_vector<Type, Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::run_range rle_vector<Type, Allocator>::runs() const noexcept {
+        return run_range{const_run_iterator(this, 0), const_run_iterator(this, run_count())};
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::run_type rle_vector<Type, Allocator>::run(size_type index) const {
+        return run_type{_m_values[index], index ? _m_ends[index - 1] : 0, _m_ends[index]};
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::size_type rle_vector<Type, Allocator>::run_count() const noexcept {
+        return _m_values.size();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::size_type rle_vector<Type, Allocator>::run_of(size_type pos) const {
+        return size_type(std::upper_bound(_m_ends.begin(), _m_ends.end(), pos) - _m_ends.begin());
+    }
+
+    template<typename Type, typename Allocator>
+    bool rle_vector<Type, Allocator>::empty() const noexcept {
+        return _m_ends.empty();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::size_type rle_vector<Type, Allocator>::size() const noexcept {
+        return _m_ends.empty() ? 0 : _m_ends.back();
+    }
+
+    template<typename Type, typename Allocator>
+    typename rle_vector<Type, Allocator>::size_type rle_vector<Type, Allocator>::memory_bytes() const noexcept {
+        return _m_values.capacity() * sizeof(Type) + _m_ends.capacity() * sizeof(size_type);
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::clear() noexcept {
+        _m_values.clear();
+        _m_ends.clear();
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::push_back(const Type& value) {
+        append_run(value, 1);
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::push_back(Type&& value) {
+        if (!_m_values.empty() && _m_values.back() == value) {
+            ++_m_ends.back();
+            return;
+        }
+        _m_ends.emplace_back(size() + 1);
+        _m_values.emplace_back(std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::append_run(const Type& value, size_type count) {
+        if (count == 0) return;
+        if (!_m_values.empty() && _m_values.back() == value) {
+            _m_ends.back() += count;
+            return;
+        }
+        _m_ends.emplace_back(size() + count);
+        _m_values.emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::pop_back() {
+        size_type first = _m_ends.size() > 1 ? _m_ends[_m_ends.size() - 2] : 0;
+        if (--_m_ends.back() == first) {
+            _m_ends.pop_back();
+            _m_values.pop_back();
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    void rle_vector<Type, Allocator>::swap(rle_vector& other) noexcept {
+        _m_values.swap(other._m_values);
+        _m_ends.swap(other._m_ends);
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator> rle_vector<Type, Allocator>::to_vector() const {
+        vector<Type, Allocator> values(_m_values.get_allocator());
+        values.reserve(size());
+        size_type pos = 0;
+        for (size_type run = 0; run < _m_values.size(); ++run) {
+            for (; pos < _m_ends[run]; ++pos) values.emplace_back(_m_values[run]);
+        }
+        return values;
+    }
+
+    template <class Type, class Allocator>
+    bool operator==(const rle_vector<Type, Allocator>& lhs, const rle_vector<Type, Allocator>& rhs) {
+        //runs are maximal, so equal sequences have equal runs
+        if (lhs.run_count() != rhs.run_count()) return false;
+        for (std::size_t i = 0; i < lhs.run_count(); ++i) {
+            auto a = lhs.run(i), b = rhs.run(i);
+            if (a.last != b.last || !(a.value == b.value)) return false;
+        }
+        return true;
+    }
+
+    template <class Type, class Allocator>
+    bool operator!=(const rle_vector<Type, Allocator>& lhs, const rle_vector<Type, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
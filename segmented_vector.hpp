@@ -0,0 +1,484 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "growth_policy.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        constexpr std::size_t floor_power_of_two(std::size_t value) noexcept {
+            return value <= 1 ? 1 : 2 * floor_power_of_two(value / 2);
+        }
+
+        constexpr unsigned floor_log2(std::size_t value) noexcept {
+            return value <= 1 ? 0 : 1 + floor_log2(value / 2);
+        }
+
+        //elements per chunk of segmented_vector: a page worth, rounded down to a power of two
+        template <typename Type>
+        struct default_chunk_size{
+            static constexpr std::size_t value = floor_power_of_two(growth_policy<Type>::PAGE_BYTES / sizeof(Type));
+        };
+    }
+
+    //Vector stored in fixed size chunks listed in an index table. Growing allocates another chunk and
+    //never moves an element, so references and pointers stay valid until the element is erased, and
+    //types that are expensive or unsafe to relocate are never relocated. Element i lives in chunk
+    //i >> log2(ChunkSize) at offset i & (ChunkSize - 1). Iterators hold the container and an index,
+    //they survive push_back too.
+    template <typename Type, std::size_t ChunkSize = detail::default_chunk_size<Type>::value,
+              typename Allocator = std::allocator<Type>>
+    class segmented_vector{
+        static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    public:
+        typedef Type                                                     value_type;
+        typedef Allocator                                                allocator_type;
+        typedef value_type&                                              reference;
+        typedef const value_type&                                        const_reference;
+        typedef std::ptrdiff_t                                           difference_type;
+        typedef std::size_t                                              size_type;
+        typedef typename std::allocator_traits<Allocator>::pointer       pointer;
+        typedef typename std::allocator_traits<Allocator>::const_pointer const_pointer;
+
+        static constexpr size_type CHUNK_SIZE = ChunkSize;
+
+        typedef detail::index_iterator<segmented_vector, Type&>              iterator;
+        typedef detail::index_iterator<const segmented_vector, const Type&>  const_iterator;
+        typedef typename std::reverse_iterator<iterator>                     reverse_iterator;
+        typedef typename std::reverse_iterator<const_iterator>               const_reverse_iterator;
+
+        // construct/copy/destroy
+        explicit segmented_vector(const Allocator& alloc = Allocator());
+        explicit segmented_vector(size_type size, const Allocator& alloc = Allocator());
+        segmented_vector(size_type size, const Type& value, const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        segmented_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        segmented_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+        segmented_vector(const segmented_vector& other);
+        //takes the chunks over, nothing is moved
+        segmented_vector(segmented_vector&& other) noexcept;
+        ~segmented_vector();
+
+        segmented_vector& operator=(const segmented_vector& other);
+        segmented_vector& operator=(segmented_vector&& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+        reference       at(size_type pos);
+        const_reference at(size_type pos) const;
+        reference       operator[](size_type pos);
+        const_reference operator[](size_type pos) const;
+        reference       front();
+        const_reference front() const;
+        reference       back();
+        const_reference back() const;
+
+        iterator                begin() noexcept;
+        const_iterator          begin() const noexcept;
+        const_iterator          cbegin() const noexcept;
+        iterator                end() noexcept;
+        const_iterator          end() const noexcept;
+        const_iterator          cend() const noexcept;
+        reverse_iterator        rbegin() noexcept;
+        const_reverse_iterator  rbegin() const noexcept;
+        reverse_iterator        rend() noexcept;
+        const_reverse_iterator  rend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+        //allocates the chunks for size elements
+        void reserve(size_type size);
+        size_type capacity() const noexcept;
+        //frees the chunks past the last element
+        void shrink_to_fit();
+        size_type chunk_count() const noexcept;
+
+        // modifiers
+        //destroys the elements, the chunks are kept
+        void clear() noexcept;
+
+        //shift the following elements by move assignment, like std::deque
+        iterator insert(const_iterator pos, const Type& value);
+        iterator insert(const_iterator pos, Type&& value);
+        template< class... Args >
+        iterator emplace(const_iterator pos, Args&&... args);
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        template< class... Args >
+        reference emplace_back(Args&&... args);
+        void pop_back();
+
+        void resize(size_type count);
+        void resize(size_type count, const value_type& value);
+
+        void swap(segmented_vector& other) noexcept;
+
+    private:
+        static constexpr unsigned _m_SHIFT = detail::floor_log2(ChunkSize);
+
+        Allocator _m_allocator;
+        vector<pointer> _m_chunks;
+        size_type _m_size = 0;
+
+        static size_type _m_chunk_of(size_type index) noexcept {return index >> _m_SHIFT;}
+        static size_type _m_offset_of(size_type index) noexcept {return index & (ChunkSize - 1);}
+
+        pointer _m_slot(size_type index) const noexcept;
+        //slot for the next element, allocating a chunk if needed
+        pointer _m_next_slot();
+        void _m_destroy_from(size_type count) noexcept;
+        void _m_release_chunks() noexcept;
+    };
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename segmented_vector<Type, ChunkSize, Allocator>::size_type segmented_vector<Type, ChunkSize, Allocator>::CHUNK_SIZE;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::pointer
+    segmented_vector<Type, ChunkSize, Allocator>::_m_slot(size_type index) const noexcept {
+        return _m_chunks[_m_chunk_of(index)] + _m_offset_of(index);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::pointer segmented_vector<Type, ChunkSize, Allocator>::_m_next_slot() {
+        if (_m_size == capacity()) _m_chunks.emplace_back(std::allocator_traits<Allocator>::allocate(_m_allocator, ChunkSize));
+        return _m_slot(_m_size);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::_m_destroy_from(size_type count) noexcept {
+        if (!std::is_trivially_destructible<Type>::value) {
+            for (size_type i = count; i < _m_size; ++i) std::allocator_traits<Allocator>::destroy(_m_allocator, _m_slot(i));
+        }
+        _m_size = std::min(_m_size, count);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::_m_release_chunks() noexcept {
+        _m_destroy_from(0);
+        for (size_type i = 0; i < _m_chunks.size(); ++i) std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_chunks[i], ChunkSize);
+        _m_chunks.clear();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(const Allocator& alloc) : _m_allocator(alloc) {}
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(size_type size, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(size_type size, const Type& value, const Allocator& alloc)
+        : _m_allocator(alloc) {
+        resize(size, value);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<class InputIt, class>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(InputIt first, InputIt last, const Allocator& alloc)
+        : _m_allocator(alloc) {
+        try {
+            for (; first != last; ++first) emplace_back(*first);
+        } catch (...) {
+            _m_release_chunks();
+            throw;
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : segmented_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(const segmented_vector& other)
+        : segmented_vector(other.begin(), other.end(), std::allocator_traits<Allocator>::select_on_container_copy_construction(other._m_allocator)) {}
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::segmented_vector(segmented_vector&& other) noexcept
+        : _m_allocator(other._m_allocator), _m_chunks(std::move(other._m_chunks)), _m_size(other._m_size) {
+        other._m_size = 0;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>::~segmented_vector() {
+        _m_release_chunks();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>&
+    segmented_vector<Type, ChunkSize, Allocator>::operator=(const segmented_vector& other) {
+        if (this != &other) {
+            clear();
+            for (size_type i = 0; i < other.size(); ++i) emplace_back(other[i]);
+        }
+        return *this;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    segmented_vector<Type, ChunkSize, Allocator>&
+    segmented_vector<Type, ChunkSize, Allocator>::operator=(segmented_vector&& other) noexcept {
+        if (this != &other) {
+            _m_release_chunks();
+            swap(other);
+        }
+        return *this;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::allocator_type
+    segmented_vector<Type, ChunkSize, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reference segmented_vector<Type, ChunkSize, Allocator>::at(size_type pos) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reference segmented_vector<Type, ChunkSize, Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reference segmented_vector<Type, ChunkSize, Allocator>::operator[](size_type pos) {
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reference segmented_vector<Type, ChunkSize, Allocator>::operator[](size_type pos) const {
+        return *_m_slot(pos);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reference segmented_vector<Type, ChunkSize, Allocator>::front() {
+        return *_m_slot(0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reference segmented_vector<Type, ChunkSize, Allocator>::front() const {
+        return *_m_slot(0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reference segmented_vector<Type, ChunkSize, Allocator>::back() {
+        return *_m_slot(_m_size - 1);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reference segmented_vector<Type, ChunkSize, Allocator>::back() const {
+        return *_m_slot(_m_size - 1);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator segmented_vector<Type, ChunkSize, Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_iterator segmented_vector<Type, ChunkSize, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_iterator segmented_vector<Type, ChunkSize, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator segmented_vector<Type, ChunkSize, Allocator>::end() noexcept {
+        return iterator(this, _m_size);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_iterator segmented_vector<Type, ChunkSize, Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_iterator segmented_vector<Type, ChunkSize, Allocator>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reverse_iterator segmented_vector<Type, ChunkSize, Allocator>::rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reverse_iterator segmented_vector<Type, ChunkSize, Allocator>::rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reverse_iterator segmented_vector<Type, ChunkSize, Allocator>::rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::const_reverse_iterator segmented_vector<Type, ChunkSize, Allocator>::rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    bool segmented_vector<Type, ChunkSize, Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::size_type segmented_vector<Type, ChunkSize, Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::size_type segmented_vector<Type, ChunkSize, Allocator>::max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(Type);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::reserve(size_type size) {
+        while (capacity() < size) _m_chunks.emplace_back(std::allocator_traits<Allocator>::allocate(_m_allocator, ChunkSize));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::size_type segmented_vector<Type, ChunkSize, Allocator>::capacity() const noexcept {
+        return _m_chunks.size() * ChunkSize;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::shrink_to_fit() {
+        size_type needed = (_m_size + ChunkSize - 1) / ChunkSize;
+        for (size_type i = needed; i < _m_chunks.size(); ++i) std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_chunks[i], ChunkSize);
+        _m_chunks.resize(needed);
+        _m_chunks.shrink_to_fit();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::size_type segmented_vector<Type, ChunkSize, Allocator>::chunk_count() const noexcept {
+        return _m_chunks.size();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::clear() noexcept {
+        _m_destroy_from(0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator
+    segmented_vector<Type, ChunkSize, Allocator>::insert(const_iterator pos, const Type& value) {
+        return emplace(pos, value);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator
+    segmented_vector<Type, ChunkSize, Allocator>::insert(const_iterator pos, Type&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<class... Args>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator
+    segmented_vector<Type, ChunkSize, Allocator>::emplace(const_iterator pos, Args&&... args) {
+        size_type index = pos.index();
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator
+    segmented_vector<Type, ChunkSize, Allocator>::erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename segmented_vector<Type, ChunkSize, Allocator>::iterator
+    segmented_vector<Type, ChunkSize, Allocator>::erase(const_iterator first, const_iterator last) {
+        size_type from = first.index(), to = last.index();
+        if (from != to) {
+            std::move(begin() + to, end(), begin() + from);
+            _m_destroy_from(_m_size - (to - from));
+        }
+        return begin() + from;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::push_back(const Type& value) {
+        emplace_back(value);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::push_back(Type&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<class... Args>
+    typename segmented_vector<Type, ChunkSize, Allocator>::reference
+    segmented_vector<Type, ChunkSize, Allocator>::emplace_back(Args&&... args) {
+        pointer slot = _m_next_slot();
+        std::allocator_traits<Allocator>::construct(_m_allocator, slot, std::forward<Args>(args)...);
+        ++_m_size;
+        return *slot;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::pop_back() {
+        _m_destroy_from(_m_size - 1);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::resize(size_type count) {
+        if (count < _m_size) _m_destroy_from(count);
+        reserve(count);
+        while (_m_size < count) emplace_back();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::resize(size_type count, const value_type& value) {
+        if (count < _m_size) _m_destroy_from(count);
+        reserve(count);
+        while (_m_size < count) emplace_back(value);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void segmented_vector<Type, ChunkSize, Allocator>::swap(segmented_vector& other) noexcept {
+        std::swap(_m_allocator, other._m_allocator);
+        _m_chunks.swap(other._m_chunks);
+        std::swap(_m_size, other._m_size);
+    }
+
+    template <class Type, std::size_t ChunkSize, class Allocator>
+    bool operator==(const segmented_vector<Type, ChunkSize, Allocator>& lhs, const segmented_vector<Type, ChunkSize, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Type, std::size_t ChunkSize, class Allocator>
+    bool operator!=(const segmented_vector<Type, ChunkSize, Allocator>& lhs, const segmented_vector<Type, ChunkSize, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <class Type, std::size_t ChunkSize, class Allocator>
+    bool operator<(const segmented_vector<Type, ChunkSize, Allocator>& lhs, const segmented_vector<Type, ChunkSize, Allocator>& rhs) {
+        return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+}
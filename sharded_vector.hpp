@@ -0,0 +1,305 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "concurrent_vector.hpp"
+#include "parallel.hpp"
+#include "thread_slots.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Fan-in collection: every thread appends to its own art::vector shard without any
+    //synchronization, and the shards are padded so no two threads write the same cache line.
+    //Reading the elements (size, view, merge, for_each) must wait until the writers are done.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class sharded_vector{
+    public:
+        typedef Type                    value_type;
+        typedef Allocator               allocator_type;
+        typedef std::size_t             size_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef vector<Type, Allocator> shard_type;
+
+        //random access over all shards in shard order, without copying them
+        template <typename TypeT>
+        class basic_view{
+        private:
+            //shard of the last element read, tried first for the next one
+            struct _m_shard_cursor{
+                mutable size_type shard = 0;
+
+                TypeT& operator()(const basic_view& view, size_type index) const {
+                    shard = view._m_locate(index, shard);
+                    return view._m_data[shard][index - view._m_offsets[shard]];
+                }
+            };
+
+        public:
+            typedef detail::index_iterator<const basic_view, TypeT&, typename std::remove_const<TypeT>::type, _m_shard_cursor> iterator;
+
+            size_type size() const noexcept {return _m_offsets.back();}
+            bool empty() const noexcept {return size() == 0;}
+            iterator begin() const {return iterator(this, 0);}
+            iterator end() const {return iterator(this, size());}
+            TypeT& operator[](size_type pos) const {return *iterator(this, pos);}
+
+        private:
+            friend class sharded_vector;
+
+            vector<TypeT*> _m_data;
+            //_m_offsets[i] is the index of the first element of shard i, the last entry is the size
+            vector<size_type> _m_offsets;
+
+            //shard holding index, or the shard count for the end; hint is tried first
+            size_type _m_locate(size_type index, size_type hint = 0) const {
+                if (hint < _m_data.size() && _m_offsets[hint] <= index && index < _m_offsets[hint + 1]) return hint;
+                return size_type(std::upper_bound(_m_offsets.begin(), _m_offsets.end(), index) - _m_offsets.begin()) - 1;
+            }
+        };
+
+        typedef basic_view<Type>       view_type;
+        typedef basic_view<const Type> const_view_type;
+
+        explicit sharded_vector(const Allocator& alloc = Allocator());
+
+        sharded_vector(const sharded_vector&) = delete;
+        sharded_vector& operator=(const sharded_vector&) = delete;
+
+        //the calling thread's shard, created on first use
+        shard_type& local();
+
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        template< class... Args >
+        void emplace_back(Args&&... args);
+
+        size_type size() const noexcept;
+        bool empty() const noexcept;
+        size_type shard_count() const noexcept;
+        shard_type& shard(size_type index);
+        const shard_type& shard(size_type index) const;
+
+        view_type view();
+        const_view_type view() const;
+
+        //one contiguous vector with every element, allocated once; every shard is copied into
+        //its slice on thread_pool::instance()
+        vector<Type, Allocator> merge() const;
+        //as merge, but moves the elements out and leaves every shard empty
+        vector<Type, Allocator> take();
+
+        //fn(element) for every element of every shard, on the thread pool
+        template <typename Function>
+        void for_each(Function fn, const parallel::options& opts = parallel::options());
+        template <typename Function>
+        void for_each(Function fn, const parallel::options& opts = parallel::options()) const;
+
+        //empties the shards, which stay assigned to their threads
+        void clear() noexcept;
+
+        allocator_type get_allocator() const;
+
+    private:
+        struct _m_shard{
+            explicit _m_shard(const Allocator& alloc) : values(alloc) {}
+            shard_type values;
+            //keeps the next shard's vector off this one's cache line
+            char padding[64];
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<_m_shard> _m_shard_allocator;
+
+        Allocator _m_allocator;
+        detail::instance_id _m_id;
+        concurrent_vector<_m_shard, _m_shard_allocator> _m_shards;
+
+        template <typename ViewT, typename Self>
+        static ViewT _m_view(Self& self);
+        //builds every element from construct(shard element), one task per shard
+        template <typename Self, typename Construct>
+        static vector<Type, Allocator> _m_concatenate(Self& self, Construct construct);
+    };
+
+    template<typename Type, typename Allocator>
+    sharded_vector<Type, Allocator>::sharded_vector(const Allocator& alloc)
+        : _m_allocator(alloc), _m_shards(_m_shard_allocator(alloc)) {}
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::shard_type& sharded_vector<Type, Allocator>::local() {
+        size_type index = detail::thread_local_index(_m_id.value(), _m_shards, _m_allocator);
+        return _m_shards[index].values;
+    }
+
+    template<typename Type, typename Allocator>
+    void sharded_vector<Type, Allocator>::push_back(const Type& value) {
+        local().emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    void sharded_vector<Type, Allocator>::push_back(Type&& value) {
+        local().push_back(std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    void sharded_vector<Type, Allocator>::emplace_back(Args&&... args) {
+        local().emplace_back(std::forward<Args>(args)...);
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::size_type sharded_vector<Type, Allocator>::size() const noexcept {
+        size_type total = 0;
+        for (const _m_shard& shard : _m_shards) total += shard.values.size();
+        return total;
+    }
+
+    template<typename Type, typename Allocator>
+    bool sharded_vector<Type, Allocator>::empty() const noexcept {
+        return size() == 0;
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::size_type sharded_vector<Type, Allocator>::shard_count() const noexcept {
+        return _m_shards.size();
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::shard_type& sharded_vector<Type, Allocator>::shard(size_type index) {
+        return _m_shards.at(index).values;
+    }
+
+    template<typename Type, typename Allocator>
+    const typename sharded_vector<Type, Allocator>::shard_type& sharded_vector<Type, Allocator>::shard(size_type index) const {
+        return _m_shards.at(index).values;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename ViewT, typename Self>
+    ViewT sharded_vector<Type, Allocator>::_m_view(Self& self) {
+        ViewT result;
+        size_type shards = self._m_shards.size();
+        result._m_data.reserve(shards);
+        result._m_offsets.reserve(shards + 1);
+        size_type running = 0;
+        for (size_type i = 0; i < shards; ++i) {
+            result._m_data.push_back(self._m_shards[i].values.data());
+            result._m_offsets.push_back(size_type(running));
+            running += self._m_shards[i].values.size();
+        }
+        result._m_offsets.push_back(size_type(running));
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::view_type sharded_vector<Type, Allocator>::view() {
+        return _m_view<view_type>(*this);
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::const_view_type sharded_vector<Type, Allocator>::view() const {
+        return _m_view<const_view_type>(*this);
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Self, typename Construct>
+    vector<Type, Allocator> sharded_vector<Type, Allocator>::_m_concatenate(Self& self, Construct construct) {
+        typedef std::allocator_traits<Allocator> traits;
+        size_type shards = self._m_shards.size();
+        vector<size_type> offsets;
+        offsets.reserve(shards + 1);
+        size_type total = 0;
+        for (size_type i = 0; i < shards; ++i) {
+            offsets.emplace_back(total);
+            total += self._m_shards[i].values.size();
+        }
+        offsets.emplace_back(total);
+
+        //each shard fills its slice of one uninitialized buffer on the pool; a failed slice undoes
+        //itself, the others are undone here once every task has finished
+        task_group group(thread_pool::instance());
+        vector<char> built(shards, char(0));
+        Allocator alloc = self._m_allocator;
+        Type* base = total ? traits::allocate(alloc, total) : nullptr;
+        auto fill = [&](size_type shard) {
+            auto& values = self._m_shards[shard].values;
+            Type* out = base + offsets[shard];
+            size_type i = 0;
+            try {
+                for (; i < values.size(); ++i) traits::construct(alloc, out + i, construct(values[i]));
+            } catch (...) {
+                while (i) traits::destroy(alloc, out + --i);
+                throw;
+            }
+            built[shard] = 1;
+        };
+        auto undo = [&] {
+            for (size_type shard = 0; shard < shards; ++shard) {
+                if (!built[shard]) continue;
+                for (size_type i = offsets[shard]; i < offsets[shard + 1]; ++i) traits::destroy(alloc, base + i);
+            }
+            if (base) traits::deallocate(alloc, base, total);
+        };
+
+        try {
+            for (size_type shard = 1; shard < shards; ++shard) {
+                if (offsets[shard + 1] != offsets[shard]) group.run([&fill, shard] { fill(shard); });
+            }
+            if (shards) fill(0);
+        } catch (...) {
+            try {
+                group.wait();
+            } catch (...) {}
+            undo();
+            throw;
+        }
+        try {
+            group.wait();
+        } catch (...) {
+            undo();
+            throw;
+        }
+        return vector<Type, Allocator>(adopt_buffer, base, total, total, alloc);
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator> sharded_vector<Type, Allocator>::merge() const {
+        return _m_concatenate(*this, [](const Type& value) -> const Type& { return value; });
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator> sharded_vector<Type, Allocator>::take() {
+        vector<Type, Allocator> result = _m_concatenate(*this, [](Type& value) -> Type&& { return std::move(value); });
+        clear();
+        return result;
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Function>
+    void sharded_vector<Type, Allocator>::for_each(Function fn, const parallel::options& opts) {
+        view_type all = view();
+        parallel::parallel_for_each(all.begin(), all.end(), fn, opts);
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Function>
+    void sharded_vector<Type, Allocator>::for_each(Function fn, const parallel::options& opts) const {
+        const_view_type all = view();
+        parallel::parallel_for_each(all.begin(), all.end(), fn, opts);
+    }
+
+    template<typename Type, typename Allocator>
+    void sharded_vector<Type, Allocator>::clear() noexcept {
+        for (_m_shard& shard : _m_shards) shard.values.clear();
+    }
+
+    template<typename Type, typename Allocator>
+    typename sharded_vector<Type, Allocator>::allocator_type sharded_vector<Type, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+}
@@ -0,0 +1,551 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "growth_policy.hpp"
+#include "span.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //calls fn(std::integral_constant<std::size_t, I>()) for every I in order
+        template <typename Function, std::size_t... I>
+        void for_each_index(Function&& fn, std::index_sequence<I...>) {
+            int expand[] = {0, (fn(std::integral_constant<std::size_t, I>()), 0)...};
+            (void)expand;
+        }
+    }
+
+    //Structure of arrays: field I of every row lives in column I, its own contiguous array aligned to
+    //COLUMN_ALIGNMENT, so a kernel over one field streams only that field. All columns share one size
+    //and capacity and live in a single allocation, grown through growth_policy of the whole row.
+    //Rows are accessed through proxy tuples of references; column<I>() gives a span for SIMD loops.
+    //Allocator is rebound to bytes for the column block; soa_vector<Fields...> uses std::allocator.
+    template <typename Allocator, typename... Fields>
+    class basic_soa_vector{
+    public:
+        typedef std::tuple<Fields...>                 value_type;
+        typedef Allocator                             allocator_type;
+        typedef std::tuple<Fields&...>                reference;
+        typedef std::tuple<const Fields&...>          const_reference;
+        typedef std::size_t                           size_type;
+        typedef std::ptrdiff_t                        difference_type;
+
+        template <std::size_t I>
+        using field_type = typename std::tuple_element<I, value_type>::type;
+
+        static constexpr std::size_t COLUMNS = sizeof...(Fields);
+        static constexpr std::size_t COLUMN_ALIGNMENT = 64;
+
+        typedef detail::index_iterator<basic_soa_vector, reference, value_type>             iterator;
+        typedef detail::index_iterator<const basic_soa_vector, const_reference, value_type> const_iterator;
+
+        // construct/copy/destroy
+        basic_soa_vector() noexcept;
+        explicit basic_soa_vector(const Allocator& alloc) noexcept;
+        explicit basic_soa_vector(size_type size, const Allocator& alloc = Allocator());
+        basic_soa_vector(std::initializer_list<value_type> init, const Allocator& alloc = Allocator());
+        basic_soa_vector(const basic_soa_vector& other);
+        basic_soa_vector(basic_soa_vector&& other) noexcept;
+        ~basic_soa_vector();
+
+        basic_soa_vector& operator=(const basic_soa_vector& other);
+        basic_soa_vector& operator=(basic_soa_vector&& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+        reference       at(size_type pos);
+        const_reference at(size_type pos) const;
+        reference       operator[](size_type pos);
+        const_reference operator[](size_type pos) const;
+        reference       front();
+        const_reference front() const;
+        reference       back();
+        const_reference back() const;
+
+        //the size() values of field I, aligned to COLUMN_ALIGNMENT
+        template <std::size_t I>
+        span<field_type<I>> column() noexcept;
+        template <std::size_t I>
+        span<const field_type<I>> column() const noexcept;
+
+        iterator        begin() noexcept;
+        const_iterator  begin() const noexcept;
+        const_iterator  cbegin() const noexcept;
+        iterator        end() noexcept;
+        const_iterator  end() const noexcept;
+        const_iterator  cend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+        void reserve(size_type new_cap);
+        size_type capacity() const noexcept;
+        void shrink_to_fit();
+
+        // modifiers
+        void clear() noexcept;
+
+        iterator insert(const_iterator pos, const value_type& row);
+        iterator insert(const_iterator pos, value_type&& row);
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const value_type& row);
+        void push_back(value_type&& row);
+        //one argument per field, each constructing that field
+        template< class... Args >
+        reference emplace_back(Args&&... args);
+        void pop_back();
+
+        void resize(size_type count);
+        void resize(size_type count, const value_type& row);
+
+        void swap(basic_soa_vector& other) noexcept;
+
+    private:
+        static_assert(sizeof...(Fields) > 0, "soa_vector needs at least one field");
+
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<unsigned char> _m_byte_allocator;
+        typedef std::make_index_sequence<sizeof...(Fields)> _m_indices;
+
+        _m_byte_allocator _m_allocator;
+        unsigned char* _m_buffer = nullptr;
+        size_type _m_buffer_bytes = 0;
+        std::tuple<Fields*...> _m_columns;
+        size_type _m_size = 0;
+        size_type _m_capacity = 0;
+
+        //bytes for capacity rows, offsets receives where each column starts
+        static size_type _m_layout(size_type capacity, size_type* offsets) noexcept;
+        void _m_reallocate(size_type new_capacity);
+        void _m_grow(size_type need_size);
+        void _m_destroy_from(size_type pos) noexcept;
+        //constructs row pos of every column from the matching element of the tuple
+        template <typename Tuple>
+        void _m_construct_row(size_type pos, Tuple&& values);
+        //moves the last row to pos, shifting [pos, size() - 1) one up
+        void _m_rotate_back_to(size_type pos);
+
+        template <std::size_t... I>
+        reference _m_row(size_type pos, std::index_sequence<I...>) noexcept {return reference(std::get<I>(_m_columns)[pos]...);}
+        template <std::size_t... I>
+        const_reference _m_row(size_type pos, std::index_sequence<I...>) const noexcept {return const_reference(std::get<I>(_m_columns)[pos]...);}
+    };
+
+    template <typename Allocator, typename... Fields> constexpr std::size_t basic_soa_vector<Allocator, Fields...>::COLUMNS;
+    template <typename Allocator, typename... Fields> constexpr std::size_t basic_soa_vector<Allocator, Fields...>::COLUMN_ALIGNMENT;
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::size_type basic_soa_vector<Allocator, Fields...>::_m_layout(size_type capacity, size_type* offsets) noexcept {
+        const size_type sizes[] = {sizeof(Fields)...};
+        size_type bytes = 0;
+        for (size_type i = 0; i < COLUMNS; ++i) {
+            offsets[i] = (bytes + COLUMN_ALIGNMENT - 1) / COLUMN_ALIGNMENT * COLUMN_ALIGNMENT;
+            bytes = offsets[i] + capacity * sizes[i];
+        }
+        return bytes;
+    }
+
+    //the allocation is padded by COLUMN_ALIGNMENT - 1 bytes so the first column can be aligned
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::_m_reallocate(size_type new_capacity) {
+        size_type offsets[COLUMNS];
+        size_type bytes = _m_layout(new_capacity, offsets);
+        unsigned char* buffer = nullptr;
+        std::tuple<Fields*...> columns;
+        if (new_capacity) {
+            bytes += COLUMN_ALIGNMENT - 1;
+            buffer = _m_allocator.allocate(bytes);
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(buffer);
+            unsigned char* base = buffer + ((COLUMN_ALIGNMENT - address % COLUMN_ALIGNMENT) % COLUMN_ALIGNMENT);
+            detail::for_each_index([&](auto i) {
+                std::get<decltype(i)::value>(columns) = reinterpret_cast<field_type<decltype(i)::value>*>(base + offsets[decltype(i)::value]);
+            }, _m_indices());
+        } else {
+            bytes = 0;
+        }
+
+        detail::for_each_index([&](auto i) {
+            typedef field_type<decltype(i)::value> field;
+            field* source = std::get<decltype(i)::value>(_m_columns);
+            field* destination = std::get<decltype(i)::value>(columns);
+            for (size_type row = 0; row < _m_size; ++row) {
+                ::new (static_cast<void*>(destination + row)) field(std::move(source[row]));
+                source[row].~field();
+            }
+        }, _m_indices());
+
+        if (_m_buffer) _m_allocator.deallocate(_m_buffer, _m_buffer_bytes);
+        _m_buffer = buffer;
+        _m_buffer_bytes = bytes;
+        _m_columns = columns;
+        _m_capacity = new_capacity;
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::_m_grow(size_type need_size) {
+        if (need_size > _m_capacity) _m_reallocate(growth_policy<value_type>::next_capacity(_m_capacity, need_size));
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::_m_destroy_from(size_type pos) noexcept {
+        detail::for_each_index([&](auto i) {
+            typedef field_type<decltype(i)::value> field;
+            field* column = std::get<decltype(i)::value>(_m_columns);
+            for (size_type row = pos; row < _m_size; ++row) column[row].~field();
+        }, _m_indices());
+        _m_size = pos;
+    }
+
+    //a field that throws destroys the fields of the row already built
+    template<typename Allocator, typename... Fields>
+    template<typename Tuple>
+    void basic_soa_vector<Allocator, Fields...>::_m_construct_row(size_type pos, Tuple&& values) {
+        size_type built = 0;
+        try {
+            detail::for_each_index([&](auto i) {
+                typedef field_type<decltype(i)::value> field;
+                ::new (static_cast<void*>(std::get<decltype(i)::value>(_m_columns) + pos)) field(std::get<decltype(i)::value>(std::forward<Tuple>(values)));
+                ++built;
+            }, _m_indices());
+        } catch (...) {
+            detail::for_each_index([&](auto i) {
+                typedef field_type<decltype(i)::value> field;
+                if (decltype(i)::value < built) std::get<decltype(i)::value>(_m_columns)[pos].~field();
+            }, _m_indices());
+            throw;
+        }
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::_m_rotate_back_to(size_type pos) {
+        detail::for_each_index([&](auto i) {
+            auto column = std::get<decltype(i)::value>(_m_columns);
+            std::rotate(column + pos, column + _m_size - 1, column + _m_size);
+        }, _m_indices());
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector() noexcept {}
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector(const Allocator& alloc) noexcept : _m_allocator(alloc) {}
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector(size_type size, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector(std::initializer_list<value_type> init, const Allocator& alloc) : _m_allocator(alloc) {
+        reserve(init.size());
+        for (const value_type& row : init) push_back(row);
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector(const basic_soa_vector& other)
+        : _m_allocator(std::allocator_traits<_m_byte_allocator>::select_on_container_copy_construction(other._m_allocator)) {
+        reserve(other.size());
+        try {
+            for (size_type row = 0; row < other.size(); ++row) {
+                _m_construct_row(row, other[row]);
+                ++_m_size;
+            }
+        } catch (...) {
+            _m_destroy_from(0);
+            _m_allocator.deallocate(_m_buffer, _m_buffer_bytes);
+            throw;
+        }
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::basic_soa_vector(basic_soa_vector&& other) noexcept
+        : _m_allocator(std::move(other._m_allocator)), _m_buffer(other._m_buffer), _m_buffer_bytes(other._m_buffer_bytes), _m_columns(other._m_columns),
+          _m_size(other._m_size), _m_capacity(other._m_capacity) {
+        other._m_buffer = nullptr;
+        other._m_buffer_bytes = other._m_size = other._m_capacity = 0;
+        other._m_columns = std::tuple<Fields*...>();
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>::~basic_soa_vector() {
+        _m_destroy_from(0);
+        if (_m_buffer) _m_allocator.deallocate(_m_buffer, _m_buffer_bytes);
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>& basic_soa_vector<Allocator, Fields...>::operator=(const basic_soa_vector& other) {
+        if (this != &other) {
+            basic_soa_vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    template<typename Allocator, typename... Fields>
+    basic_soa_vector<Allocator, Fields...>& basic_soa_vector<Allocator, Fields...>::operator=(basic_soa_vector&& other) noexcept {
+        if (this != &other) {
+            basic_soa_vector moved(std::move(other));
+            swap(moved);
+        }
+        return *this;
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::allocator_type basic_soa_vector<Allocator, Fields...>::get_allocator() const {
+        return allocator_type(_m_allocator);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::reference basic_soa_vector<Allocator, Fields...>::at(size_type pos) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_reference basic_soa_vector<Allocator, Fields...>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::reference basic_soa_vector<Allocator, Fields...>::operator[](size_type pos) {
+        return _m_row(pos, _m_indices());
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_reference basic_soa_vector<Allocator, Fields...>::operator[](size_type pos) const {
+        return _m_row(pos, _m_indices());
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::reference basic_soa_vector<Allocator, Fields...>::front() {
+        return (*this)[0];
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_reference basic_soa_vector<Allocator, Fields...>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::reference basic_soa_vector<Allocator, Fields...>::back() {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_reference basic_soa_vector<Allocator, Fields...>::back() const {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Allocator, typename... Fields>
+    template<std::size_t I>
+    span<typename basic_soa_vector<Allocator, Fields...>::template field_type<I>> basic_soa_vector<Allocator, Fields...>::column() noexcept {
+        return span<field_type<I>>(std::get<I>(_m_columns), _m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    template<std::size_t I>
+    span<const typename basic_soa_vector<Allocator, Fields...>::template field_type<I>> basic_soa_vector<Allocator, Fields...>::column() const noexcept {
+        return span<const field_type<I>>(std::get<I>(_m_columns), _m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_iterator basic_soa_vector<Allocator, Fields...>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_iterator basic_soa_vector<Allocator, Fields...>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::end() noexcept {
+        return iterator(this, _m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_iterator basic_soa_vector<Allocator, Fields...>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::const_iterator basic_soa_vector<Allocator, Fields...>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    bool basic_soa_vector<Allocator, Fields...>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::size_type basic_soa_vector<Allocator, Fields...>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::size_type basic_soa_vector<Allocator, Fields...>::max_size() const noexcept {
+        const size_type sizes[] = {sizeof(Fields)...};
+        size_type row = 0;
+        for (size_type i = 0; i < COLUMNS; ++i) row += sizes[i];
+        return (std::numeric_limits<size_type>::max() - COLUMNS * COLUMN_ALIGNMENT) / row;
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::reserve(size_type new_cap) {
+        if (new_cap > _m_capacity) _m_reallocate(new_cap);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::size_type basic_soa_vector<Allocator, Fields...>::capacity() const noexcept {
+        return _m_capacity;
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::shrink_to_fit() {
+        if (_m_capacity != _m_size) _m_reallocate(_m_size);
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::clear() noexcept {
+        _m_destroy_from(0);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::insert(const_iterator pos, const value_type& row) {
+        size_type index = pos.index();
+        push_back(row);
+        _m_rotate_back_to(index);
+        return begin() + index;
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::insert(const_iterator pos, value_type&& row) {
+        size_type index = pos.index();
+        push_back(std::move(row));
+        _m_rotate_back_to(index);
+        return begin() + index;
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    template<typename Allocator, typename... Fields>
+    typename basic_soa_vector<Allocator, Fields...>::iterator basic_soa_vector<Allocator, Fields...>::erase(const_iterator first, const_iterator last) {
+        size_type from = first.index(), to = last.index();
+        if (from != to) {
+            detail::for_each_index([&](auto i) {
+                auto column = std::get<decltype(i)::value>(_m_columns);
+                std::move(column + to, column + _m_size, column + from);
+            }, _m_indices());
+            _m_destroy_from(_m_size - (to - from));
+        }
+        return begin() + from;
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::push_back(const value_type& row) {
+        _m_grow(_m_size + 1);
+        _m_construct_row(_m_size, row);
+        ++_m_size;
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::push_back(value_type&& row) {
+        _m_grow(_m_size + 1);
+        _m_construct_row(_m_size, std::move(row));
+        ++_m_size;
+    }
+
+    template<typename Allocator, typename... Fields>
+    template<class... Args>
+    typename basic_soa_vector<Allocator, Fields...>::reference basic_soa_vector<Allocator, Fields...>::emplace_back(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+        if (_m_size == _m_capacity) {
+            //args may refer to our own fields, build the row before reallocating
+            value_type row(std::forward<Args>(args)...);
+            push_back(std::move(row));
+        } else {
+            _m_construct_row(_m_size, std::forward_as_tuple(std::forward<Args>(args)...));
+            ++_m_size;
+        }
+        return back();
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::pop_back() {
+        _m_destroy_from(_m_size - 1);
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::resize(size_type count) {
+        if (count <= _m_size) {
+            _m_destroy_from(count);
+            return;
+        }
+        reserve(count);
+        while (_m_size < count) {
+            _m_construct_row(_m_size, value_type());
+            ++_m_size;
+        }
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::resize(size_type count, const value_type& row) {
+        if (count <= _m_size) {
+            _m_destroy_from(count);
+            return;
+        }
+        value_type copy(row);
+        reserve(count);
+        while (_m_size < count) {
+            _m_construct_row(_m_size, copy);
+            ++_m_size;
+        }
+    }
+
+    template<typename Allocator, typename... Fields>
+    void basic_soa_vector<Allocator, Fields...>::swap(basic_soa_vector& other) noexcept {
+        std::swap(_m_allocator, other._m_allocator);
+        std::swap(_m_buffer, other._m_buffer);
+        std::swap(_m_buffer_bytes, other._m_buffer_bytes);
+        std::swap(_m_columns, other._m_columns);
+        std::swap(_m_size, other._m_size);
+        std::swap(_m_capacity, other._m_capacity);
+    }
+
+    template <typename Allocator, typename... Fields>
+    bool operator==(const basic_soa_vector<Allocator, Fields...>& lhs, const basic_soa_vector<Allocator, Fields...>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <typename Allocator, typename... Fields>
+    bool operator!=(const basic_soa_vector<Allocator, Fields...>& lhs, const basic_soa_vector<Allocator, Fields...>& rhs) {
+        return !(lhs == rhs);
+    }
+
+    template <typename... Fields>
+    using soa_vector = basic_soa_vector<std::allocator<unsigned char>, Fields...>;
+}
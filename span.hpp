@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace art{
+
+    //Non-owning view of count contiguous elements. Iterators are raw pointers, so kernels over a
+    //span vectorize like loops over an array.
+    template <typename Type>
+    class span{
+    public:
+        typedef Type                                   element_type;
+        typedef typename std::remove_cv<Type>::type    value_type;
+        typedef std::size_t                            size_type;
+        typedef std::ptrdiff_t                         difference_type;
+        typedef Type*                                  pointer;
+        typedef Type&                                  reference;
+        typedef Type*                                  iterator;
+        typedef std::reverse_iterator<iterator>        reverse_iterator;
+
+        span() noexcept : _m_data(nullptr), _m_size(0) {}
+        span(pointer data, size_type size) noexcept : _m_data(data), _m_size(size) {}
+        span(pointer first, pointer last) noexcept : _m_data(first), _m_size(size_type(last - first)) {}
+        template<typename OtherT, typename = typename std::enable_if<std::is_convertible<OtherT(*)[], Type(*)[]>::value>::type>
+        span(const span<OtherT>& other) noexcept : _m_data(other.data()), _m_size(other.size()) {}
+
+        pointer data() const noexcept {return _m_data;}
+        size_type size() const noexcept {return _m_size;}
+        bool empty() const noexcept {return _m_size == 0;}
+
+        reference operator[](size_type pos) const {return _m_data[pos];}
+        reference at(size_type pos) const {
+            if (pos >= _m_size) throw std::out_of_range("Out of range");
+            return _m_data[pos];
+        }
+        reference front() const {return _m_data[0];}
+        reference back() const {return _m_data[_m_size - 1];}
+
+        iterator begin() const noexcept {return _m_data;}
+        iterator end() const noexcept {return _m_data + _m_size;}
+        reverse_iterator rbegin() const noexcept {return reverse_iterator(end());}
+        reverse_iterator rend() const noexcept {return reverse_iterator(begin());}
+
+        span subspan(size_type offset, size_type count) const noexcept {return span(_m_data + offset, count);}
+
+    private:
+        pointer _m_data;
+        size_type _m_size;
+    };
+}
@@ -0,0 +1,643 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "span.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    namespace detail{
+        //four independent sums break the dependency chain of the reduction; floating point sums are
+        //not reassociated by the compiler, so this is what lets them overlap
+        template <typename Type>
+        Type dense_dot(const Type* lhs, const Type* rhs, std::size_t count) {
+            Type sums[4] = {Type(), Type(), Type(), Type()};
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                for (std::size_t lane = 0; lane < 4; ++lane) sums[lane] += lhs[i + lane] * rhs[i + lane];
+            }
+            for (; i < count; ++i) sums[0] += lhs[i] * rhs[i];
+            return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+        }
+    }
+
+    //Vector of a huge logical size where most elements equal Type(). The index space is split into
+    //chunks of ChunkSize; only chunks holding a non default element are stored, found by binary search
+    //over their sorted ids. A chunk keeps sorted (offset, value) pairs while sparse and a plain
+    //ChunkSize slice once it fills past a quarter, and goes back to pairs below a sixteenth, so a chunk
+    //hovering around one threshold does not convert back and forth. Dot products and merges walk the
+    //chunks of both operands together and pick a kernel per pair of representations.
+    template <typename Type, std::size_t ChunkSize = 4096, typename Allocator = std::allocator<Type>>
+    class sparse_vector{
+        static_assert(ChunkSize >= 16 && ChunkSize <= 65536, "chunk offsets are 16 bit");
+
+    public:
+        typedef Type                                                                            value_type;
+        typedef Allocator                                                                       allocator_type;
+        typedef std::size_t                                                                     size_type;
+        typedef std::ptrdiff_t                                                                  difference_type;
+        typedef std::uint16_t                                                                   offset_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<offset_type>   offset_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>     size_allocator;
+
+        static constexpr size_type CHUNK_SIZE = ChunkSize;
+        //a sparse chunk turns dense above this many elements, a dense one sparse below the other
+        static constexpr size_type DENSE_FILL = ChunkSize / 4;
+        static constexpr size_type SPARSE_FILL = ChunkSize / 16;
+
+        //non default element
+        struct entry_type{
+            size_type index;
+            const Type& value;
+        };
+
+        //visits the non default elements in index order
+        class const_iterator : public std::iterator<std::forward_iterator_tag, entry_type, difference_type, void, entry_type> {
+        public:
+            typedef entry_type reference;
+
+            const_iterator() : _container(nullptr), _chunk(0), _slot(0) {}
+
+            inline reference operator*() const {
+                const _m_chunk& chunk = *_container->_m_chunks[_chunk];
+                size_type base = _container->_m_ids[_chunk] * ChunkSize;
+                if (chunk.dense) return entry_type{base + _slot, chunk.values[_slot]};
+                return entry_type{base + chunk.offsets[_slot], chunk.values[_slot]};
+            }
+            inline const_iterator& operator++() {
+                ++_slot;
+                _settle();
+                return *this;
+            }
+            inline const_iterator operator++(int) {const_iterator tmp(*this); ++*this; return tmp;}
+
+            friend inline bool operator==(const const_iterator& lhs, const const_iterator& rhs) {return lhs._chunk == rhs._chunk && lhs._slot == rhs._slot;}
+            friend inline bool operator!=(const const_iterator& lhs, const const_iterator& rhs) {return !(lhs == rhs);}
+        private:
+            friend class sparse_vector;
+            const_iterator(const sparse_vector* container, size_type chunk) : _container(container), _chunk(chunk), _slot(0) {_settle();}
+
+            //moves to the next slot holding a non default element, or to the end
+            void _settle() {
+                for (; _chunk < _container->_m_chunks.size(); ++_chunk, _slot = 0) {
+                    const _m_chunk& chunk = *_container->_m_chunks[_chunk];
+                    if (!chunk.dense) {
+                        if (_slot < chunk.values.size()) return;
+                        continue;
+                    }
+                    while (_slot < ChunkSize && chunk.values[_slot] == Type()) ++_slot;
+                    if (_slot < ChunkSize) return;
+                }
+                _slot = 0;
+            }
+
+            const sparse_vector* _container;
+            size_type _chunk;
+            size_type _slot;
+        };
+
+        typedef const_iterator iterator;
+
+        // construct/copy/destroy
+        explicit sparse_vector(size_type size = 0, const Allocator& alloc = Allocator());
+        //copies the non default elements of dense
+        explicit sparse_vector(span<const Type> dense, const Allocator& alloc = Allocator());
+        sparse_vector(const sparse_vector& other);
+        sparse_vector(sparse_vector&& other) noexcept;
+        ~sparse_vector();
+
+        sparse_vector& operator=(const sparse_vector& other);
+        sparse_vector& operator=(sparse_vector&& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+        //element pos, Type() unless it was set
+        value_type operator[](size_type pos) const;
+        value_type at(size_type pos) const;
+        bool contains(size_type pos) const;
+
+        const_iterator begin() const;
+        const_iterator cbegin() const;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        //fn(index, value) for every non default element in index order, faster than iterating
+        template <typename Function>
+        void for_each(Function fn) const;
+
+        // capacity
+        //logical size, counting default elements
+        size_type size() const noexcept;
+        //non default elements
+        size_type nonzero_count() const noexcept;
+        size_type chunk_count() const noexcept;
+        size_type dense_chunks() const noexcept;
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        //setting Type() erases the element
+        void set(size_type pos, const Type& value);
+        void erase(size_type pos);
+        //elements at or past count are dropped when shrinking
+        void resize(size_type count);
+        void clear() noexcept;
+        void swap(sparse_vector& other) noexcept;
+
+        // operations
+        //sum of products of the elements at equal indices
+        Type dot(const sparse_vector& other) const;
+        Type dot(span<const Type> dense) const;
+        //op(this[i], other[i]) for every index where either is non default; op(Type(), Type()) must be Type()
+        template <typename BinaryOperation>
+        sparse_vector merge(const sparse_vector& other, BinaryOperation op) const;
+
+    private:
+        struct _m_chunk{
+            bool dense;
+            //non default elements
+            size_type count;
+            //sorted offsets of the elements while sparse, empty while dense
+            vector<offset_type, offset_allocator> offsets;
+            //values parallel to offsets while sparse, all ChunkSize slots while dense
+            vector<Type, Allocator> values;
+
+            explicit _m_chunk(const Allocator& alloc) : dense(false), count(0), offsets(offset_allocator(alloc)), values(alloc) {}
+        };
+
+        size_type _m_size;
+        //sorted ids of the stored chunks and the chunks, kept as two trivially copyable arrays
+        vector<size_type, size_allocator> _m_ids;
+        vector<_m_chunk*> _m_chunks;
+        Allocator _m_allocator;
+
+        //position of chunk id in _m_ids, or where it would be inserted
+        size_type _m_find(size_type id) const noexcept;
+        void _m_insert_chunk(size_type position, size_type id, _m_chunk* chunk);
+        void _m_erase_chunk(size_type position) noexcept;
+        void _m_make_dense(_m_chunk& chunk);
+        void _m_make_sparse(_m_chunk& chunk);
+        //picks the representation for a freshly built chunk
+        void _m_settle(_m_chunk& chunk);
+        static Type _m_chunk_dot(const _m_chunk& lhs, const _m_chunk& rhs);
+    };
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::CHUNK_SIZE;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::DENSE_FILL;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    constexpr typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::SPARSE_FILL;
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>::sparse_vector(size_type size, const Allocator& alloc)
+        : _m_size(size), _m_ids(size_allocator(alloc)), _m_allocator(alloc) {}
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>::sparse_vector(span<const Type> dense, const Allocator& alloc) : sparse_vector(dense.size(), alloc) {
+        for (size_type i = 0; i < dense.size(); ++i) {
+            if (!(dense[i] == Type())) set(i, dense[i]);
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>::sparse_vector(const sparse_vector& other) : sparse_vector(other._m_size, other._m_allocator) {
+        _m_ids.reserve(other._m_ids.size());
+        _m_chunks.reserve(other._m_chunks.size());
+        for (size_type i = 0; i < other._m_chunks.size(); ++i) {
+            std::unique_ptr<_m_chunk> chunk(new _m_chunk(*other._m_chunks[i]));
+            _m_ids.emplace_back(other._m_ids[i]);
+            _m_chunks.emplace_back(chunk.release());
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>::sparse_vector(sparse_vector&& other) noexcept
+        : _m_size(0), _m_ids(size_allocator(other._m_allocator)), _m_allocator(other._m_allocator) {
+        swap(other);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>::~sparse_vector() {
+        clear();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>& sparse_vector<Type, ChunkSize, Allocator>::operator=(const sparse_vector& other) {
+        sparse_vector copy(other);
+        swap(copy);
+        return *this;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    sparse_vector<Type, ChunkSize, Allocator>& sparse_vector<Type, ChunkSize, Allocator>::operator=(sparse_vector&& other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::allocator_type sparse_vector<Type, ChunkSize, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::_m_find(size_type id) const noexcept {
+        return size_type(std::lower_bound(_m_ids.begin(), _m_ids.end(), id) - _m_ids.begin());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::_m_insert_chunk(size_type position, size_type id, _m_chunk* chunk) {
+        //emplace_back and rotate rather than insert, so either failure leaves both arrays unchanged
+        _m_ids.emplace_back(id);
+        try {
+            _m_chunks.emplace_back(chunk);
+        } catch (...) {
+            _m_ids.pop_back();
+            throw;
+        }
+        std::rotate(_m_ids.begin() + position, _m_ids.end() - 1, _m_ids.end());
+        std::rotate(_m_chunks.begin() + position, _m_chunks.end() - 1, _m_chunks.end());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::_m_erase_chunk(size_type position) noexcept {
+        delete _m_chunks[position];
+        _m_chunks.erase(_m_chunks.begin() + position);
+        _m_ids.erase(_m_ids.begin() + position);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::_m_make_dense(_m_chunk& chunk) {
+        vector<Type, Allocator> slots(ChunkSize, Type(), _m_allocator);
+        for (size_type i = 0; i < chunk.offsets.size(); ++i) slots[chunk.offsets[i]] = chunk.values[i];
+        chunk.values.swap(slots);
+        vector<offset_type, offset_allocator>(chunk.offsets.get_allocator()).swap(chunk.offsets);
+        chunk.dense = true;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::_m_make_sparse(_m_chunk& chunk) {
+        vector<offset_type, offset_allocator> offsets(chunk.offsets.get_allocator());
+        vector<Type, Allocator> values(_m_allocator);
+        offsets.reserve(chunk.count);
+        values.reserve(chunk.count);
+        for (size_type i = 0; i < ChunkSize; ++i) {
+            if (chunk.values[i] == Type()) continue;
+            offsets.emplace_back(offset_type(i));
+            values.emplace_back(chunk.values[i]);
+        }
+        chunk.offsets.swap(offsets);
+        chunk.values.swap(values);
+        chunk.dense = false;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::_m_settle(_m_chunk& chunk) {
+        if (chunk.dense && chunk.count <= DENSE_FILL) _m_make_sparse(chunk);
+        else if (!chunk.dense && chunk.count > DENSE_FILL) _m_make_dense(chunk);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::value_type sparse_vector<Type, ChunkSize, Allocator>::operator[](size_type pos) const {
+        size_type id = pos / ChunkSize;
+        size_type position = _m_find(id);
+        if (position == _m_ids.size() || _m_ids[position] != id) return Type();
+        const _m_chunk& chunk = *_m_chunks[position];
+        offset_type offset = offset_type(pos % ChunkSize);
+        if (chunk.dense) return chunk.values[offset];
+        auto found = std::lower_bound(chunk.offsets.begin(), chunk.offsets.end(), offset);
+        if (found == chunk.offsets.end() || *found != offset) return Type();
+        return chunk.values[size_type(found - chunk.offsets.begin())];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::value_type sparse_vector<Type, ChunkSize, Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    bool sparse_vector<Type, ChunkSize, Allocator>::contains(size_type pos) const {
+        return !((*this)[pos] == Type());
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::const_iterator sparse_vector<Type, ChunkSize, Allocator>::begin() const {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::const_iterator sparse_vector<Type, ChunkSize, Allocator>::cbegin() const {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::const_iterator sparse_vector<Type, ChunkSize, Allocator>::end() const noexcept {
+        const_iterator it;
+        it._container = this;
+        it._chunk = _m_chunks.size();
+        return it;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::const_iterator sparse_vector<Type, ChunkSize, Allocator>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<typename Function>
+    void sparse_vector<Type, ChunkSize, Allocator>::for_each(Function fn) const {
+        for (size_type c = 0; c < _m_chunks.size(); ++c) {
+            const _m_chunk& chunk = *_m_chunks[c];
+            size_type base = _m_ids[c] * ChunkSize;
+            if (chunk.dense) {
+                for (size_type i = 0; i < ChunkSize; ++i) {
+                    if (!(chunk.values[i] == Type())) fn(base + i, chunk.values[i]);
+                }
+            } else {
+                for (size_type i = 0; i < chunk.offsets.size(); ++i) fn(base + chunk.offsets[i], chunk.values[i]);
+            }
+        }
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::nonzero_count() const noexcept {
+        size_type count = 0;
+        for (const _m_chunk* chunk : _m_chunks) count += chunk->count;
+        return count;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::chunk_count() const noexcept {
+        return _m_chunks.size();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::dense_chunks() const noexcept {
+        size_type count = 0;
+        for (const _m_chunk* chunk : _m_chunks) count += chunk->dense;
+        return count;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    typename sparse_vector<Type, ChunkSize, Allocator>::size_type sparse_vector<Type, ChunkSize, Allocator>::memory_bytes() const noexcept {
+        size_type bytes = _m_ids.capacity() * sizeof(size_type) + _m_chunks.capacity() * sizeof(_m_chunk*);
+        for (const _m_chunk* chunk : _m_chunks) {
+            bytes += sizeof(_m_chunk) + chunk->offsets.capacity() * sizeof(offset_type) + chunk->values.capacity() * sizeof(Type);
+        }
+        return bytes;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::set(size_type pos, const Type& value) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        if (value == Type()) {
+            erase(pos);
+            return;
+        }
+        size_type id = pos / ChunkSize;
+        size_type position = _m_find(id);
+        if (position == _m_ids.size() || _m_ids[position] != id) {
+            std::unique_ptr<_m_chunk> fresh(new _m_chunk(_m_allocator));
+            _m_insert_chunk(position, id, fresh.get());
+            fresh.release();
+        }
+        _m_chunk& chunk = *_m_chunks[position];
+        offset_type offset = offset_type(pos % ChunkSize);
+        if (chunk.dense) {
+            if (chunk.values[offset] == Type()) ++chunk.count;
+            chunk.values[offset] = value;
+            return;
+        }
+        size_type slot = size_type(std::lower_bound(chunk.offsets.begin(), chunk.offsets.end(), offset) - chunk.offsets.begin());
+        if (slot < chunk.offsets.size() && chunk.offsets[slot] == offset) {
+            chunk.values[slot] = value;
+            return;
+        }
+        if (chunk.values.size() == chunk.values.capacity()) {
+            //most chunks of a very sparse vector hold one or two elements, start smaller than growth_policy
+            size_type grown = std::min(std::max<size_type>(2, chunk.values.size() * 2), DENSE_FILL + 1);
+            chunk.values.reserve(grown);
+            chunk.offsets.reserve(grown);
+        }
+        chunk.values.emplace_back(value);
+        try {
+            chunk.offsets.emplace_back(offset);
+        } catch (...) {
+            chunk.values.pop_back();
+            throw;
+        }
+        std::rotate(chunk.values.begin() + slot, chunk.values.end() - 1, chunk.values.end());
+        std::rotate(chunk.offsets.begin() + slot, chunk.offsets.end() - 1, chunk.offsets.end());
+        if (++chunk.count > DENSE_FILL) _m_make_dense(chunk);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::erase(size_type pos) {
+        size_type id = pos / ChunkSize;
+        size_type position = _m_find(id);
+        if (position == _m_ids.size() || _m_ids[position] != id) return;
+        _m_chunk& chunk = *_m_chunks[position];
+        offset_type offset = offset_type(pos % ChunkSize);
+        if (chunk.dense) {
+            if (chunk.values[offset] == Type()) return;
+            chunk.values[offset] = Type();
+            --chunk.count;
+        } else {
+            auto found = std::lower_bound(chunk.offsets.begin(), chunk.offsets.end(), offset);
+            if (found == chunk.offsets.end() || *found != offset) return;
+            size_type slot = size_type(found - chunk.offsets.begin());
+            chunk.offsets.erase(found);
+            chunk.values.erase(chunk.values.begin() + slot);
+            --chunk.count;
+        }
+        if (chunk.count == 0) _m_erase_chunk(position);
+        else if (chunk.dense && chunk.count < SPARSE_FILL) _m_make_sparse(chunk);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::resize(size_type count) {
+        if (count < _m_size) {
+            size_type kept = (count + ChunkSize - 1) / ChunkSize;
+            while (!_m_ids.empty() && _m_ids.back() >= kept) _m_erase_chunk(_m_ids.size() - 1);
+            if (!_m_ids.empty() && _m_ids.back() == kept - 1 && count % ChunkSize) {
+                _m_chunk& chunk = *_m_chunks.back();
+                size_type first = count % ChunkSize;
+                if (chunk.dense) {
+                    for (size_type i = first; i < ChunkSize; ++i) {
+                        if (chunk.values[i] == Type()) continue;
+                        chunk.values[i] = Type();
+                        --chunk.count;
+                    }
+                } else {
+                    size_type slot = size_type(std::lower_bound(chunk.offsets.begin(), chunk.offsets.end(), offset_type(first)) - chunk.offsets.begin());
+                    chunk.offsets.erase(chunk.offsets.begin() + slot, chunk.offsets.end());
+                    chunk.values.erase(chunk.values.begin() + slot, chunk.values.end());
+                    chunk.count = slot;
+                }
+                if (chunk.count == 0) _m_erase_chunk(_m_ids.size() - 1);
+                else if (chunk.dense && chunk.count < SPARSE_FILL) _m_make_sparse(chunk);
+            }
+        }
+        _m_size = count;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::clear() noexcept {
+        for (_m_chunk* chunk : _m_chunks) delete chunk;
+        _m_chunks.clear();
+        _m_ids.clear();
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    void sparse_vector<Type, ChunkSize, Allocator>::swap(sparse_vector& other) noexcept {
+        std::swap(_m_size, other._m_size);
+        _m_ids.swap(other._m_ids);
+        _m_chunks.swap(other._m_chunks);
+        std::swap(_m_allocator, other._m_allocator);
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    Type sparse_vector<Type, ChunkSize, Allocator>::_m_chunk_dot(const _m_chunk& lhs, const _m_chunk& rhs) {
+        if (lhs.dense && rhs.dense) return detail::dense_dot(lhs.values.data(), rhs.values.data(), ChunkSize);
+        if (lhs.dense || rhs.dense) {
+            //gather the dense side at the offsets of the sparse one
+            const _m_chunk& sparse = lhs.dense ? rhs : lhs;
+            const Type* slots = (lhs.dense ? lhs : rhs).values.data();
+            Type sum = Type();
+            for (size_type i = 0; i < sparse.offsets.size(); ++i) sum += sparse.values[i] * slots[sparse.offsets[i]];
+            return sum;
+        }
+        //intersect the sorted offsets
+        Type sum = Type();
+        size_type i = 0, j = 0;
+        while (i < lhs.offsets.size() && j < rhs.offsets.size()) {
+            offset_type a = lhs.offsets[i], b = rhs.offsets[j];
+            if (a == b) sum += lhs.values[i] * rhs.values[j];
+            i += a <= b;
+            j += b <= a;
+        }
+        return sum;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    Type sparse_vector<Type, ChunkSize, Allocator>::dot(const sparse_vector& other) const {
+        if (_m_size != other._m_size) throw std::invalid_argument("Sparse vector sizes differ");
+        Type sum = Type();
+        size_type i = 0, j = 0;
+        while (i < _m_ids.size() && j < other._m_ids.size()) {
+            if (_m_ids[i] < other._m_ids[j]) ++i;
+            else if (other._m_ids[j] < _m_ids[i]) ++j;
+            else sum += _m_chunk_dot(*_m_chunks[i++], *other._m_chunks[j++]);
+        }
+        return sum;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    Type sparse_vector<Type, ChunkSize, Allocator>::dot(span<const Type> dense) const {
+        if (_m_size != dense.size()) throw std::invalid_argument("Sparse vector sizes differ");
+        Type sum = Type();
+        for (size_type c = 0; c < _m_chunks.size(); ++c) {
+            const _m_chunk& chunk = *_m_chunks[c];
+            const Type* slots = dense.data() + _m_ids[c] * ChunkSize;
+            if (chunk.dense) {
+                sum += detail::dense_dot(chunk.values.data(), slots, std::min(ChunkSize, _m_size - _m_ids[c] * ChunkSize));
+                continue;
+            }
+            for (size_type i = 0; i < chunk.offsets.size(); ++i) sum += chunk.values[i] * slots[chunk.offsets[i]];
+        }
+        return sum;
+    }
+
+    template<typename Type, std::size_t ChunkSize, typename Allocator>
+    template<typename BinaryOperation>
+    sparse_vector<Type, ChunkSize, Allocator> sparse_vector<Type, ChunkSize, Allocator>::merge(const sparse_vector& other, BinaryOperation op) const {
+        if (_m_size != other._m_size) throw std::invalid_argument("Sparse vector sizes differ");
+        sparse_vector result(_m_size, _m_allocator);
+        const _m_chunk none(_m_allocator);
+        size_type i = 0, j = 0;
+        while (i < _m_ids.size() || j < other._m_ids.size()) {
+            bool take_left = j == other._m_ids.size() || (i < _m_ids.size() && _m_ids[i] <= other._m_ids[j]);
+            bool take_right = i == _m_ids.size() || (j < other._m_ids.size() && other._m_ids[j] <= _m_ids[i]);
+            const _m_chunk& lhs = take_left ? *_m_chunks[i] : none;
+            const _m_chunk& rhs = take_right ? *other._m_chunks[j] : none;
+            size_type id = take_left ? _m_ids[i] : other._m_ids[j];
+            i += take_left;
+            j += take_right;
+
+            std::unique_ptr<_m_chunk> merged(new _m_chunk(_m_allocator));
+            if (lhs.dense || rhs.dense) {
+                //expand both into slots and combine them in one pass the compiler can vectorize
+                vector<Type, Allocator> left(_m_allocator), right(_m_allocator);
+                const Type* a = lhs.values.data();
+                const Type* b = rhs.values.data();
+                if (!lhs.dense) {
+                    left.resize(ChunkSize);
+                    for (size_type k = 0; k < lhs.offsets.size(); ++k) left[lhs.offsets[k]] = lhs.values[k];
+                    a = left.data();
+                }
+                if (!rhs.dense) {
+                    right.resize(ChunkSize);
+                    for (size_type k = 0; k < rhs.offsets.size(); ++k) right[rhs.offsets[k]] = rhs.values[k];
+                    b = right.data();
+                }
+                merged->values.resize(ChunkSize);
+                Type* out = merged->values.data();
+                for (size_type k = 0; k < ChunkSize; ++k) out[k] = op(a[k], b[k]);
+                size_type count = 0;
+                for (size_type k = 0; k < ChunkSize; ++k) count += !(out[k] == Type());
+                merged->dense = true;
+                merged->count = count;
+            } else {
+                //union of the sorted offsets
+                size_type p = 0, q = 0;
+                while (p < lhs.offsets.size() || q < rhs.offsets.size()) {
+                    bool left = q == rhs.offsets.size() || (p < lhs.offsets.size() && lhs.offsets[p] <= rhs.offsets[q]);
+                    bool right = p == lhs.offsets.size() || (q < rhs.offsets.size() && rhs.offsets[q] <= lhs.offsets[p]);
+                    offset_type offset = left ? lhs.offsets[p] : rhs.offsets[q];
+                    Type value = op(left ? lhs.values[p] : Type(), right ? rhs.values[q] : Type());
+                    p += left;
+                    q += right;
+                    if (value == Type()) continue;
+                    merged->offsets.emplace_back(offset);
+                    merged->values.emplace_back(value);
+                }
+                merged->count = merged->offsets.size();
+            }
+            if (merged->count == 0) continue;
+            result._m_settle(*merged);
+            result._m_insert_chunk(result._m_ids.size(), id, merged.get());
+            merged.release();
+        }
+        return result;
+    }
+
+    template <class Type, std::size_t ChunkSize, class Allocator>
+    bool operator==(const sparse_vector<Type, ChunkSize, Allocator>& lhs, const sparse_vector<Type, ChunkSize, Allocator>& rhs) {
+        if (lhs.size() != rhs.size() || lhs.nonzero_count() != rhs.nonzero_count()) return false;
+        auto a = lhs.begin(), b = rhs.begin();
+        for (; a != lhs.end(); ++a, ++b) {
+            if ((*a).index != (*b).index || !((*a).value == (*b).value)) return false;
+        }
+        return true;
+    }
+
+    template <class Type, std::size_t ChunkSize, class Allocator>
+    bool operator!=(const sparse_vector<Type, ChunkSize, Allocator>& lhs, const sparse_vector<Type, ChunkSize, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
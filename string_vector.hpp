@@ -0,0 +1,453 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "radix_sort.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Non owning view of characters, valid as long as the storage it points into
+    class string_ref{
+    public:
+        typedef char               value_type;
+        typedef const char*        const_iterator;
+        typedef const char*        iterator;
+        typedef std::size_t        size_type;
+
+        string_ref() noexcept : _m_data(nullptr), _m_size(0) {}
+        string_ref(const char* data, size_type size) noexcept : _m_data(data), _m_size(size) {}
+        string_ref(const char* text) noexcept : _m_data(text), _m_size(std::strlen(text)) {}
+        string_ref(const std::string& text) noexcept : _m_data(text.data()), _m_size(text.size()) {}
+
+        const char* data() const noexcept {return _m_data;}
+        size_type size() const noexcept {return _m_size;}
+        size_type length() const noexcept {return _m_size;}
+        bool empty() const noexcept {return _m_size == 0;}
+
+        const_iterator begin() const noexcept {return _m_data;}
+        const_iterator end() const noexcept {return _m_data + _m_size;}
+        char operator[](size_type pos) const noexcept {return _m_data[pos];}
+        char front() const noexcept {return _m_data[0];}
+        char back() const noexcept {return _m_data[_m_size - 1];}
+
+        string_ref substr(size_type pos, size_type count = size_type(-1)) const {
+            if (pos > _m_size) throw std::out_of_range("Out of range");
+            return string_ref(_m_data + pos, std::min(count, _m_size - pos));
+        }
+
+        //negative, zero or positive like std::string::compare, bytes compared as unsigned
+        int compare(string_ref other) const noexcept {
+            size_type common = std::min(_m_size, other._m_size);
+            int result = common ? std::memcmp(_m_data, other._m_data, common) : 0;
+            if (result != 0) return result;
+            return _m_size < other._m_size ? -1 : _m_size > other._m_size ? 1 : 0;
+        }
+
+        std::string str() const {return std::string(_m_data, _m_size);}
+        explicit operator std::string() const {return str();}
+
+    private:
+        const char* _m_data;
+        size_type _m_size;
+    };
+
+    inline bool operator==(string_ref lhs, string_ref rhs) noexcept {
+        return lhs.size() == rhs.size() && (lhs.empty() || std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0);
+    }
+    inline bool operator!=(string_ref lhs, string_ref rhs) noexcept {return !(lhs == rhs);}
+    inline bool operator<(string_ref lhs, string_ref rhs) noexcept {return lhs.compare(rhs) < 0;}
+    inline bool operator>(string_ref lhs, string_ref rhs) noexcept {return lhs.compare(rhs) > 0;}
+    inline bool operator<=(string_ref lhs, string_ref rhs) noexcept {return lhs.compare(rhs) <= 0;}
+    inline bool operator>=(string_ref lhs, string_ref rhs) noexcept {return lhs.compare(rhs) >= 0;}
+
+    inline std::ostream& operator<<(std::ostream& out, string_ref text) {
+        return out.write(text.data(), std::streamsize(text.size()));
+    }
+
+    namespace detail{
+        //first 8 bytes, most significant first and zero padded, so prefixes order like the strings
+        inline std::uint64_t string_prefix64(const char* data, std::size_t size) noexcept {
+            std::uint64_t prefix = 0;
+            std::size_t count = std::min<std::size_t>(size, 8);
+            for (std::size_t i = 0; i < count; ++i) prefix |= std::uint64_t(static_cast<unsigned char>(data[i])) << (56 - 8 * i);
+            return prefix;
+        }
+    }
+
+    //Strings stored back to back in one character arena, with the offset where each one starts and a
+    //cached 8 byte prefix per string. Appending never allocates per string, and comparisons decide on
+    //the prefixes alone unless both strings share their first 8 bytes. Elements are string_refs into
+    //the arena, valid until the next modification.
+    template <typename Allocator = std::allocator<char>>
+    class basic_string_vector{
+    public:
+        typedef string_ref                                                                    value_type;
+        typedef string_ref                                                                    reference;
+        typedef string_ref                                                                    const_reference;
+        typedef Allocator                                                                     allocator_type;
+        typedef std::size_t                                                                   size_type;
+        typedef std::ptrdiff_t                                                                difference_type;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<char>        char_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>   size_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<std::uint64_t> prefix_allocator;
+        typedef vector<size_type, size_allocator>                                             permutation_type;
+
+        typedef detail::index_iterator<const basic_string_vector, string_ref> const_iterator;
+        typedef const_iterator                                                iterator;
+
+        // construct/copy/destroy
+        explicit basic_string_vector(const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        basic_string_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        basic_string_vector(std::initializer_list<string_ref> init, const Allocator& alloc = Allocator());
+
+        allocator_type get_allocator() const;
+
+        const_reference operator[](size_type pos) const noexcept;
+        const_reference at(size_type pos) const;
+        const_reference front() const noexcept;
+        const_reference back() const noexcept;
+        //cached first 8 bytes of string pos, most significant first
+        std::uint64_t prefix(size_type pos) const noexcept;
+
+        const_iterator begin() const noexcept;
+        const_iterator cbegin() const noexcept;
+        const_iterator end() const noexcept;
+        const_iterator cend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        //characters of all strings together
+        size_type char_count() const noexcept;
+        void reserve(size_type strings, size_type chars);
+        size_type memory_bytes() const noexcept;
+
+        // modifiers
+        //value may point into this vector
+        void push_back(string_ref value);
+        void pop_back();
+        void clear() noexcept;
+        void swap(basic_string_vector& other) noexcept;
+
+        // ordering
+        //orders strings pos and other like string_ref::compare
+        int compare(size_type pos, size_type other) const noexcept;
+        //indices of the strings in ascending order, equal strings keep their order
+        permutation_type sort_permutation() const;
+        //rebuilds the arena with the strings in order
+        void permute(const permutation_type& order);
+        void sort();
+
+    private:
+        vector<char, char_allocator> _m_chars;
+        //size() + 1 entries, string i is [_m_offsets[i], _m_offsets[i + 1])
+        vector<size_type, size_allocator> _m_offsets;
+        vector<std::uint64_t, prefix_allocator> _m_prefixes;
+
+        //sorts the strings listed in [first, last), which share their first 8 * depth bytes, by the 8
+        //bytes after those, recursing into runs that are still equal
+        void _m_sort_from(size_type* first, size_type* last, size_type depth) const;
+        //sorts strings with equal prefixes: shorter than 8 bytes first, by length, then the rest
+        //from their second chunk on
+        void _m_sort_equal_prefix(size_type* first, size_type* last) const;
+    };
+
+    typedef basic_string_vector<> string_vector;
+
+    template<typename Allocator>
+    basic_string_vector<Allocator>::basic_string_vector(const Allocator& alloc)
+        : _m_chars(char_allocator(alloc)), _m_offsets(size_allocator(alloc)), _m_prefixes(prefix_allocator(alloc)) {
+        _m_offsets.emplace_back(0);
+    }
+
+    template<typename Allocator>
+    template<class InputIt, class>
+    basic_string_vector<Allocator>::basic_string_vector(InputIt first, InputIt last, const Allocator& alloc) : basic_string_vector(alloc) {
+        for (; first != last; ++first) push_back(string_ref(*first));
+    }
+
+    template<typename Allocator>
+    basic_string_vector<Allocator>::basic_string_vector(std::initializer_list<string_ref> init, const Allocator& alloc)
+        : basic_string_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::allocator_type basic_string_vector<Allocator>::get_allocator() const {
+        return allocator_type(_m_chars.get_allocator());
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_reference basic_string_vector<Allocator>::operator[](size_type pos) const noexcept {
+        size_type first = _m_offsets[pos];
+        return string_ref(_m_chars.data() + first, _m_offsets[pos + 1] - first);
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_reference basic_string_vector<Allocator>::at(size_type pos) const {
+        if (pos >= size()) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_reference basic_string_vector<Allocator>::front() const noexcept {
+        return (*this)[0];
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_reference basic_string_vector<Allocator>::back() const noexcept {
+        return (*this)[size() - 1];
+    }
+
+    template<typename Allocator>
+    std::uint64_t basic_string_vector<Allocator>::prefix(size_type pos) const noexcept {
+        return _m_prefixes[pos];
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_iterator basic_string_vector<Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_iterator basic_string_vector<Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_iterator basic_string_vector<Allocator>::end() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::const_iterator basic_string_vector<Allocator>::cend() const noexcept {
+        return const_iterator(this, size());
+    }
+
+    template<typename Allocator>
+    bool basic_string_vector<Allocator>::empty() const noexcept {
+        return _m_prefixes.empty();
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::size_type basic_string_vector<Allocator>::size() const noexcept {
+        return _m_prefixes.size();
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::size_type basic_string_vector<Allocator>::char_count() const noexcept {
+        return _m_chars.size();
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::reserve(size_type strings, size_type chars) {
+        _m_chars.reserve(chars);
+        _m_offsets.reserve(strings + 1);
+        _m_prefixes.reserve(strings);
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::size_type basic_string_vector<Allocator>::memory_bytes() const noexcept {
+        return _m_chars.capacity() + _m_offsets.capacity() * sizeof(size_type) + _m_prefixes.capacity() * sizeof(std::uint64_t);
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::push_back(string_ref value) {
+        size_type first = _m_chars.size();
+        //the characters may live in the arena that is about to grow
+        const char* arena = _m_chars.data();
+        bool inside = !value.empty() && !std::less<const char*>()(value.data(), arena) && std::less<const char*>()(value.data(), arena + first);
+        size_type source = inside ? size_type(value.data() - arena) : 0;
+
+        _m_chars.resize(first + value.size());
+        const char* data = inside ? _m_chars.data() + source : value.data();
+        if (!value.empty()) std::memcpy(_m_chars.data() + first, data, value.size());
+        try {
+            _m_offsets.emplace_back(first + value.size());
+            _m_prefixes.emplace_back(detail::string_prefix64(_m_chars.data() + first, value.size()));
+        } catch (...) {
+            if (_m_offsets.size() > _m_prefixes.size() + 1) _m_offsets.pop_back();
+            _m_chars.erase(_m_chars.begin() + first, _m_chars.end());
+            throw;
+        }
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::pop_back() {
+        _m_prefixes.pop_back();
+        _m_offsets.pop_back();
+        _m_chars.erase(_m_chars.begin() + _m_offsets.back(), _m_chars.end());
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::clear() noexcept {
+        _m_chars.clear();
+        _m_prefixes.clear();
+        _m_offsets.erase(_m_offsets.begin() + 1, _m_offsets.end());
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::swap(basic_string_vector& other) noexcept {
+        _m_chars.swap(other._m_chars);
+        _m_offsets.swap(other._m_offsets);
+        _m_prefixes.swap(other._m_prefixes);
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::_m_sort_equal_prefix(size_type* first, size_type* last) const {
+        //equal prefixes leave only the length to compare within the first 8 bytes, so this level
+        //reads offsets but no characters
+        std::stable_sort(first, last, [this](size_type lhs, size_type rhs) {
+            return std::min<size_type>(_m_offsets[lhs + 1] - _m_offsets[lhs], 8) < std::min<size_type>(_m_offsets[rhs + 1] - _m_offsets[rhs], 8);
+        });
+        size_type* longer = std::find_if(first, last, [this](size_type index) {return _m_offsets[index + 1] - _m_offsets[index] >= 8;});
+        if (last - longer > 1) _m_sort_from(longer, last, 1);
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::_m_sort_from(size_type* first, size_type* last, size_type depth) const {
+        //bytes of the chunk a string covers break ties between zero padding and real zero bytes
+        struct chunk_key{
+            std::uint64_t chunk;
+            size_type covered;
+            size_type index;
+        };
+        //run of strings equal in their first 8 * depth bytes, still to be ordered
+        struct work_range{
+            size_type* first;
+            size_type* last;
+            size_type depth;
+        };
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<chunk_key> key_allocator;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<work_range> work_allocator;
+        vector<chunk_key, key_allocator> keys(key_allocator(_m_chars.get_allocator()));
+        keys.reserve(size_type(last - first));
+        //an explicit stack, long shared prefixes would otherwise recurse once per 8 bytes
+        vector<work_range, work_allocator> pending(work_allocator(_m_chars.get_allocator()));
+        pending.emplace_back(work_range{first, last, depth});
+        while (!pending.empty()) {
+            work_range work = pending.back();
+            pending.pop_back();
+            size_type skip = 8 * work.depth;
+
+            //jump over the bytes the whole run shares in one scan; byte identical strings only need
+            //their original order back
+            string_ref lead = (*this)[*work.first];
+            size_type shared = lead.size() - skip;
+            bool same_size = true;
+            for (size_type* it = work.first + 1; it != work.last; ++it) {
+                string_ref value = (*this)[*it];
+                same_size = same_size && value.size() == lead.size();
+                size_type limit = std::min(shared, value.size() - skip);
+                shared = size_type(std::mismatch(lead.data() + skip, lead.data() + skip + limit, value.data() + skip).first - (lead.data() + skip));
+                if (shared == 0) {
+                    same_size = false;
+                    break;
+                }
+            }
+            if (same_size && shared == lead.size() - skip) {
+                std::sort(work.first, work.last);
+                continue;
+            }
+            skip += shared / 8 * 8;
+
+            keys.erase(keys.begin(), keys.end());
+            for (size_type* it = work.first; it != work.last; ++it) {
+                string_ref value = (*this)[*it];
+                size_type rest = value.size() - skip;
+                keys.emplace_back(chunk_key{detail::string_prefix64(value.data() + skip, rest), std::min<size_type>(rest, 8), *it});
+            }
+            //the index keeps equal strings in their original order
+            std::sort(keys.begin(), keys.end(), [](const chunk_key& lhs, const chunk_key& rhs) {
+                if (lhs.chunk != rhs.chunk) return lhs.chunk < rhs.chunk;
+                if (lhs.covered != rhs.covered) return lhs.covered < rhs.covered;
+                return lhs.index < rhs.index;
+            });
+            for (size_type i = 0; i < keys.size(); ++i) work.first[i] = keys[i].index;
+            for (size_type run = 0; run < keys.size();) {
+                size_type end = run + 1;
+                while (end < keys.size() && keys[end].chunk == keys[run].chunk && keys[end].covered == keys[run].covered) ++end;
+                //strings that ended inside this chunk are equal, the others continue
+                if (end - run > 1 && keys[run].covered == 8) pending.emplace_back(work_range{work.first + run, work.first + end, skip / 8 + 1});
+                run = end;
+            }
+        }
+    }
+
+    template<typename Allocator>
+    int basic_string_vector<Allocator>::compare(size_type pos, size_type other) const noexcept {
+        std::uint64_t lhs = _m_prefixes[pos], rhs = _m_prefixes[other];
+        if (lhs != rhs) return lhs < rhs ? -1 : 1;
+        return (*this)[pos].compare((*this)[other]);
+    }
+
+    template<typename Allocator>
+    typename basic_string_vector<Allocator>::permutation_type basic_string_vector<Allocator>::sort_permutation() const {
+        //radix sort (prefix, index) pairs on the prefix, then order the runs of equal prefixes
+        typedef std::pair<std::uint64_t, size_type> keyed;
+        typedef typename std::allocator_traits<Allocator>::template rebind_alloc<keyed> keyed_allocator;
+        size_type count = size();
+        vector<keyed, keyed_allocator> keys(keyed_allocator(_m_chars.get_allocator()));
+        keys.reserve(count);
+        for (size_type i = 0; i < count; ++i) keys.emplace_back(_m_prefixes[i], i);
+        radix_sort(keys);
+
+        permutation_type order(size_allocator(_m_chars.get_allocator()));
+        order.reserve(count);
+        for (size_type i = 0; i < count; ++i) order.emplace_back(keys[i].second);
+        for (size_type first = 0; first < count;) {
+            size_type last = first + 1;
+            while (last < count && keys[last].first == keys[first].first) ++last;
+            if (last - first > 1) _m_sort_equal_prefix(order.data() + first, order.data() + last);
+            first = last;
+        }
+        return order;
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::permute(const permutation_type& order) {
+        if (order.size() != size()) throw std::invalid_argument("Permutation size mismatch");
+        basic_string_vector sorted(get_allocator());
+        sorted.reserve(size(), char_count());
+        for (size_type i = 0; i < order.size(); ++i) {
+            string_ref value = (*this)[order[i]];
+            size_type first = sorted._m_chars.size();
+            sorted._m_chars.resize(first + value.size());
+            if (!value.empty()) std::memcpy(sorted._m_chars.data() + first, value.data(), value.size());
+            sorted._m_offsets.emplace_back(first + value.size());
+            sorted._m_prefixes.emplace_back(_m_prefixes[order[i]]);
+        }
+        swap(sorted);
+    }
+
+    template<typename Allocator>
+    void basic_string_vector<Allocator>::sort() {
+        permute(sort_permutation());
+    }
+
+    template <class Allocator>
+    bool operator==(const basic_string_vector<Allocator>& lhs, const basic_string_vector<Allocator>& rhs) {
+        if (lhs.size() != rhs.size() || lhs.char_count() != rhs.char_count()) return false;
+        for (std::size_t i = 0; i < lhs.size(); ++i) {
+            if (lhs.prefix(i) != rhs.prefix(i) || lhs[i] != rhs[i]) return false;
+        }
+        return true;
+    }
+
+    template <class Allocator>
+    bool operator!=(const basic_string_vector<Allocator>& lhs, const basic_string_vector<Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
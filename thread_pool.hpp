@@ -0,0 +1,284 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace art{
+
+    //Work-stealing pool: every worker owns a deque, pushes and pops its own tasks at the back and
+    //steals the oldest task from the front of another deque when it runs dry. Threads waiting on a
+    //task_group run pending tasks meanwhile, so nested parallelism from inside tasks does not deadlock.
+    class thread_pool{
+    public:
+        typedef std::function<void()> task;
+
+        explicit thread_pool(std::size_t workers = default_workers());
+        ~thread_pool();
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        //number of worker threads, not counting callers
+        std::size_t size() const noexcept;
+
+        //queues a task, on the calling worker's own deque if called from a worker of this pool
+        void submit(task work);
+
+        //runs one pending task on the calling thread, false if none was found
+        bool run_pending_task();
+
+        //calls fn(first, last) for consecutive index ranges covering [0, count), one per thread,
+        //waits for all of them and rethrows the first exception thrown by fn
+        template <typename Function>
+        void parallel_chunks(std::size_t count, Function fn);
+
+        //pool shared by the containers, hardware_concurrency() - 1 workers
+        static thread_pool& instance();
+        static std::size_t default_workers() noexcept;
+
+    private:
+        //padded so neighbouring queues do not share a cache line; alignas would need C++17 aligned new
+        struct _m_worker_queue{
+            std::mutex mutex;
+            std::deque<task> tasks;
+            char padding[64];
+        };
+
+        std::vector<std::thread> _m_workers;
+        std::unique_ptr<_m_worker_queue[]> _m_queues;
+        std::size_t _m_queue_count;
+        std::atomic<std::size_t> _m_pending;
+        std::atomic<std::size_t> _m_next_queue;
+        std::mutex _m_sleep_mutex;
+        std::condition_variable _m_wake;
+        bool _m_stop = false;
+
+        //worker this thread belongs to, if any
+        struct _m_worker_identity{
+            const thread_pool* pool;
+            std::size_t index;
+        };
+        static _m_worker_identity& _m_current_worker() noexcept;
+        _m_worker_queue* _m_own_queue() noexcept;
+        bool _m_pop_own(_m_worker_queue& queue, task& work);
+        bool _m_steal(std::size_t start, task& work);
+        void _m_worker_loop(std::size_t index);
+    };
+
+    //set of tasks that can be waited for together; tasks may add more tasks to their own group
+    class task_group{
+    public:
+        explicit task_group(thread_pool& pool = thread_pool::instance());
+        ~task_group();
+
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+
+        template <typename Function>
+        void run(Function fn);
+
+        //runs pending tasks until the group is done, then rethrows the first exception of its tasks
+        void wait();
+
+        thread_pool& pool() const noexcept;
+
+    private:
+        thread_pool& _m_pool;
+        std::atomic<std::size_t> _m_running;
+        std::mutex _m_error_mutex;
+        std::exception_ptr _m_error;
+
+        void _m_wait_running() noexcept;
+    };
+
+    //vectors with at least this many elements construct, copy and destroy them on
+    //thread_pool::instance(), which also spreads first-touch page placement over the workers.
+    //0 (the default) disables it
+    namespace detail{
+        inline std::atomic<std::size_t>& parallel_threshold_storage() noexcept {
+            static std::atomic<std::size_t> threshold(0);
+            return threshold;
+        }
+    }
+
+    inline void set_parallel_threshold(std::size_t elements) noexcept {
+        detail::parallel_threshold_storage().store(elements, std::memory_order_relaxed);
+    }
+
+    inline std::size_t parallel_threshold() noexcept {
+        return detail::parallel_threshold_storage().load(std::memory_order_relaxed);
+    }
+
+    inline thread_pool::thread_pool(std::size_t workers)
+        : _m_queues(new _m_worker_queue[workers + 1]), _m_queue_count(workers + 1), _m_pending(0), _m_next_queue(0) {
+        //the extra last queue takes tasks submitted from outside the pool
+        _m_workers.reserve(workers);
+        for (std::size_t i = 0; i < workers; ++i) _m_workers.emplace_back([this, i] { _m_worker_loop(i); });
+    }
+
+    inline thread_pool::~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(_m_sleep_mutex);
+            _m_stop = true;
+        }
+        _m_wake.notify_all();
+        for (auto& worker : _m_workers) worker.join();
+    }
+
+    inline std::size_t thread_pool::size() const noexcept {
+        return _m_workers.size();
+    }
+
+    inline thread_pool& thread_pool::instance() {
+        static thread_pool pool;
+        return pool;
+    }
+
+    inline std::size_t thread_pool::default_workers() noexcept {
+        std::size_t threads = std::thread::hardware_concurrency();
+        return threads > 1 ? threads - 1 : 0;
+    }
+
+    inline thread_pool::_m_worker_identity& thread_pool::_m_current_worker() noexcept {
+        static thread_local _m_worker_identity identity{nullptr, 0};
+        return identity;
+    }
+
+    inline thread_pool::_m_worker_queue* thread_pool::_m_own_queue() noexcept {
+        const _m_worker_identity& identity = _m_current_worker();
+        return identity.pool == this ? &_m_queues[identity.index] : nullptr;
+    }
+
+    inline void thread_pool::submit(task work) {
+        _m_worker_queue* own = _m_own_queue();
+        _m_worker_queue& queue = own ? *own : _m_queues[_m_queue_count - 1];
+        _m_pending.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks.push_back(std::move(work));
+        }
+        {
+            std::lock_guard<std::mutex> lock(_m_sleep_mutex);
+        }
+        _m_wake.notify_one();
+    }
+
+    inline bool thread_pool::_m_pop_own(_m_worker_queue& queue, task& work) {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) return false;
+        work = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+        _m_pending.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    inline bool thread_pool::_m_steal(std::size_t start, task& work) {
+        for (std::size_t i = 0; i < _m_queue_count; ++i) {
+            _m_worker_queue& victim = _m_queues[(start + i) % _m_queue_count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.tasks.empty()) continue;
+            work = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _m_pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    inline bool thread_pool::run_pending_task() {
+        if (_m_pending.load(std::memory_order_acquire) == 0) return false;
+        task work;
+        _m_worker_queue* own = _m_own_queue();
+        std::size_t start = own ? _m_current_worker().index + 1 : _m_next_queue.fetch_add(1, std::memory_order_relaxed);
+        if (!(own && _m_pop_own(*own, work)) && !_m_steal(start, work)) return false;
+        work();
+        return true;
+    }
+
+    inline void thread_pool::_m_worker_loop(std::size_t index) {
+        _m_current_worker() = _m_worker_identity{this, index};
+        for (;;) {
+            task work;
+            if (_m_pop_own(_m_queues[index], work) || _m_steal(index + 1, work)) {
+                work();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(_m_sleep_mutex);
+            _m_wake.wait(lock, [this] { return _m_stop || _m_pending.load(std::memory_order_acquire) != 0; });
+            if (_m_stop && _m_pending.load(std::memory_order_acquire) == 0) return;
+        }
+    }
+
+    template <typename Function>
+    void thread_pool::parallel_chunks(std::size_t count, Function fn) {
+        std::size_t parts = std::min(size() + 1, count);
+        if (parts <= 1) {
+            fn(std::size_t(0), count);
+            return;
+        }
+
+        auto bound = [count, parts](std::size_t part) {
+            return count / parts * part + std::min(part, count % parts);
+        };
+        task_group group(*this);
+        for (std::size_t part = 1; part < parts; ++part) {
+            group.run([&fn, &bound, part] { fn(bound(part), bound(part + 1)); });
+        }
+        try {
+            fn(bound(0), bound(1));
+        } catch (...) {
+            group.wait();
+            throw;
+        }
+        group.wait();
+    }
+
+    inline task_group::task_group(thread_pool& pool) : _m_pool(pool), _m_running(0) {}
+
+    inline task_group::~task_group() {
+        _m_wait_running();
+    }
+
+    inline thread_pool& task_group::pool() const noexcept {
+        return _m_pool;
+    }
+
+    template <typename Function>
+    void task_group::run(Function fn) {
+        _m_running.fetch_add(1, std::memory_order_relaxed);
+        _m_pool.submit([this, fn] {
+            try {
+                fn();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(_m_error_mutex);
+                if (!_m_error) _m_error = std::current_exception();
+            }
+            _m_running.fetch_sub(1, std::memory_order_acq_rel);
+        });
+    }
+
+    inline void task_group::_m_wait_running() noexcept {
+        while (_m_running.load(std::memory_order_acquire) != 0) {
+            if (!_m_pool.run_pending_task()) std::this_thread::yield();
+        }
+    }
+
+    inline void task_group::wait() {
+        _m_wait_running();
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(_m_error_mutex);
+            std::swap(error, _m_error);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+}
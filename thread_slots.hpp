@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "concurrent_vector.hpp"
+#include "vector.hpp"
+
+namespace art{
+
+    //Per-thread state of the sharded and rcu containers: every container takes an id, and every
+    //thread keeps a small table from ids to the index of its own element in the container.
+    namespace detail{
+        //ids of the live containers keeping per-thread state; ids are never reused, so a thread's
+        //entry for a destroyed container is never mistaken for a new one
+        struct instance_registry{
+            std::mutex mutex;
+            //sorted, ids are handed out in increasing order
+            vector<std::uint64_t> live;
+            std::uint64_t next = 1;
+            //bumped whenever an id is released, threads prune their entries when it moved
+            std::atomic<std::uint64_t> generation{0};
+        };
+
+        inline instance_registry& instances() {
+            static instance_registry registry;
+            return registry;
+        }
+
+        //id of a container keeping per-thread state, live for the lifetime of the container
+        class instance_id{
+        public:
+            instance_id() {
+                instance_registry& registry = instances();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.live.emplace_back(registry.next);
+                _m_value = registry.next++;
+            }
+            ~instance_id() {
+                instance_registry& registry = instances();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.live.erase(std::lower_bound(registry.live.begin(), registry.live.end(), _m_value));
+                registry.generation.fetch_add(1, std::memory_order_release);
+            }
+
+            instance_id(const instance_id&) = delete;
+            instance_id& operator=(const instance_id&) = delete;
+
+            std::uint64_t value() const noexcept {return _m_value;}
+        private:
+            std::uint64_t _m_value;
+        };
+
+        struct thread_slot{
+            std::uint64_t owner;
+            std::size_t index;
+        };
+
+        //per-thread elements the calling thread owns, by container id
+        struct thread_slot_table{
+            vector<thread_slot> slots;
+            //last slot used, a thread mostly works with one container at a time
+            thread_slot last{0, 0};
+            //registry generation the slots were last pruned at
+            std::uint64_t generation = 0;
+
+            //drops the slots of destroyed containers
+            void prune() {
+                instance_registry& registry = instances();
+                std::uint64_t seen = registry.generation.load(std::memory_order_acquire);
+                if (seen == generation) return;
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                auto dead = [&registry](const thread_slot& slot) {
+                    return !std::binary_search(registry.live.begin(), registry.live.end(), slot.owner);
+                };
+                slots.erase(std::remove_if(slots.begin(), slots.end(), dead), slots.end());
+                generation = seen;
+            }
+        };
+
+        inline thread_slot_table& thread_slots() {
+            static thread_local thread_slot_table table;
+            return table;
+        }
+
+        //index of the calling thread's element of elements, appended from args on first use; returns
+        //once the element is published, so every thread iterating elements afterwards sees it
+        template <typename Type, typename Allocator, typename... Args>
+        std::size_t thread_local_index(std::uint64_t owner, concurrent_vector<Type, Allocator>& elements, Args&&... args) {
+            thread_slot_table& table = thread_slots();
+            if (table.last.owner == owner) return table.last.index;
+            table.prune();
+            //most recently created containers are the likeliest to be in use
+            for (std::size_t i = table.slots.size(); i-- > 0;) {
+                if (table.slots[i].owner != owner) continue;
+                table.last = table.slots[i];
+                return table.last.index;
+            }
+            std::size_t index = elements.emplace_back(std::forward<Args>(args)...);
+            table.slots.emplace_back(thread_slot{owner, index});
+            table.last = thread_slot{owner, index};
+            while (elements.size() <= index) std::this_thread::yield();
+            return index;
+        }
+    }
+}
@@ -0,0 +1,530 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "vector.hpp"
+
+namespace art{
+
+    //Tiered vector: elements live in blocks of B slots, B a power of two near sqrt(n), each block a
+    //circular buffer. Every block before the one holding the end is full, so element i is slot
+    //(head + i % B) % B of block i / B and random access stays O(1). Inserting or erasing shifts
+    //elements inside one block and moves one element between the circular ends of each following
+    //block, O(B + n / B) = O(sqrt n). B doubles or halves with a rebuild as the size moves away from
+    //B * B.
+    template <typename Type, typename Allocator = std::allocator<Type>>
+    class tiered_vector{
+    public:
+        typedef Type                                                     value_type;
+        typedef Allocator                                                allocator_type;
+        typedef value_type&                                              reference;
+        typedef const value_type&                                        const_reference;
+        typedef std::ptrdiff_t                                           difference_type;
+        typedef std::size_t                                              size_type;
+        typedef typename std::allocator_traits<Allocator>::pointer       pointer;
+        typedef typename std::allocator_traits<Allocator>::const_pointer const_pointer;
+
+        static const size_type MIN_BLOCK_SIZE = 16;
+
+        typedef detail::index_iterator<tiered_vector, Type&>                 iterator;
+        typedef detail::index_iterator<const tiered_vector, const Type&>     const_iterator;
+        typedef typename std::reverse_iterator<iterator>                     reverse_iterator;
+        typedef typename std::reverse_iterator<const_iterator>               const_reverse_iterator;
+
+        // construct/copy/destroy
+        explicit tiered_vector(const Allocator& alloc = Allocator());
+        explicit tiered_vector(size_type size, const Allocator& alloc = Allocator());
+        tiered_vector(size_type size, const Type& value, const Allocator& alloc = Allocator());
+        template< class InputIt, class = typename std::enable_if <!std::is_integral <InputIt>::value>::type >
+        tiered_vector(InputIt first, InputIt last, const Allocator& alloc = Allocator());
+        tiered_vector(std::initializer_list<Type> init, const Allocator& alloc = Allocator());
+        tiered_vector(const tiered_vector& other);
+        tiered_vector(tiered_vector&& other) noexcept;
+        ~tiered_vector();
+
+        tiered_vector& operator=(const tiered_vector& other);
+        tiered_vector& operator=(tiered_vector&& other) noexcept;
+
+        allocator_type get_allocator() const;
+
+        reference       at(size_type pos);
+        const_reference at(size_type pos) const;
+        reference       operator[](size_type pos);
+        const_reference operator[](size_type pos) const;
+        reference       front();
+        const_reference front() const;
+        reference       back();
+        const_reference back() const;
+
+        iterator                begin() noexcept;
+        const_iterator          begin() const noexcept;
+        const_iterator          cbegin() const noexcept;
+        iterator                end() noexcept;
+        const_iterator          end() const noexcept;
+        const_iterator          cend() const noexcept;
+        reverse_iterator        rbegin() noexcept;
+        const_reverse_iterator  rbegin() const noexcept;
+        reverse_iterator        rend() noexcept;
+        const_reverse_iterator  rend() const noexcept;
+
+        // capacity
+        bool empty() const noexcept;
+        size_type size() const noexcept;
+        size_type max_size() const noexcept;
+        size_type capacity() const noexcept;
+        size_type block_size() const noexcept;
+
+        // modifiers
+        void clear() noexcept;
+
+        iterator insert(const_iterator pos, const Type& value);
+        iterator insert(const_iterator pos, Type&& value);
+        template< class... Args >
+        iterator emplace(const_iterator pos, Args&&... args);
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const Type& value);
+        void push_back(Type&& value);
+        template< class... Args >
+        reference emplace_back(Args&&... args);
+        void pop_back();
+
+        void resize(size_type count);
+        void resize(size_type count, const value_type& value);
+
+        void swap(tiered_vector& other) noexcept;
+
+    private:
+        struct _m_block{
+            pointer slots;
+            size_type head;
+            size_type count;
+        };
+
+        Allocator _m_allocator;
+        vector<_m_block> _m_blocks;
+        size_type _m_size = 0;
+        unsigned _m_shift = _m_log2(MIN_BLOCK_SIZE);
+
+        static constexpr unsigned _m_log2(size_type value) noexcept {
+            return value <= 1 ? 0 : 1 + _m_log2(value / 2);
+        }
+
+        size_type _m_mask() const noexcept {return (size_type(1) << _m_shift) - 1;}
+        pointer _m_slot(const _m_block& block, size_type offset) const noexcept {
+            return block.slots + ((block.head + offset) & _m_mask());
+        }
+
+        void _m_add_block();
+        void _m_free_blocks() noexcept;
+        //moves every element into blocks of 1 << shift slots
+        void _m_rebuild(unsigned shift);
+        //rebuilds when the size drifted too far from block_size() squared
+        void _m_rebalance();
+
+        template< class... Args >
+        void _m_push_front(_m_block& block, Args&&... args);
+        template< class... Args >
+        void _m_push_back(_m_block& block, Args&&... args);
+        Type _m_pop_front(_m_block& block);
+        Type _m_pop_back(_m_block& block);
+    };
+
+    template<typename Type, typename Allocator>
+    const typename tiered_vector<Type, Allocator>::size_type tiered_vector<Type, Allocator>::MIN_BLOCK_SIZE;
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::_m_add_block() {
+        pointer slots = std::allocator_traits<Allocator>::allocate(_m_allocator, size_type(1) << _m_shift);
+        _m_blocks.push_back(_m_block{slots, 0, 0});
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::_m_free_blocks() noexcept {
+        for (size_type b = 0; b < _m_blocks.size(); ++b) {
+            _m_block& block = _m_blocks[b];
+            for (size_type i = 0; i < block.count; ++i) std::allocator_traits<Allocator>::destroy(_m_allocator, _m_slot(block, i));
+            std::allocator_traits<Allocator>::deallocate(_m_allocator, block.slots, size_type(1) << _m_shift);
+        }
+        _m_blocks.clear();
+        _m_size = 0;
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::_m_rebuild(unsigned shift) {
+        tiered_vector rebuilt(_m_allocator);
+        rebuilt._m_shift = shift;
+        for (size_type i = 0; i < _m_size; ++i) rebuilt.emplace_back(std::move((*this)[i]));
+        swap(rebuilt);
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::_m_rebalance() {
+        size_type block = size_type(1) << _m_shift;
+        if (_m_size > 2 * block * block) _m_rebuild(_m_shift + 1);
+        else if (block > MIN_BLOCK_SIZE && _m_size < block * block / 8) _m_rebuild(_m_shift - 1);
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    void tiered_vector<Type, Allocator>::_m_push_front(_m_block& block, Args&&... args) {
+        size_type head = (block.head - 1) & _m_mask();
+        std::allocator_traits<Allocator>::construct(_m_allocator, block.slots + head, std::forward<Args>(args)...);
+        block.head = head;
+        ++block.count;
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    void tiered_vector<Type, Allocator>::_m_push_back(_m_block& block, Args&&... args) {
+        std::allocator_traits<Allocator>::construct(_m_allocator, _m_slot(block, block.count), std::forward<Args>(args)...);
+        ++block.count;
+    }
+
+    template<typename Type, typename Allocator>
+    Type tiered_vector<Type, Allocator>::_m_pop_front(_m_block& block) {
+        pointer slot = _m_slot(block, 0);
+        Type value(std::move(*slot));
+        std::allocator_traits<Allocator>::destroy(_m_allocator, slot);
+        block.head = (block.head + 1) & _m_mask();
+        --block.count;
+        return value;
+    }
+
+    template<typename Type, typename Allocator>
+    Type tiered_vector<Type, Allocator>::_m_pop_back(_m_block& block) {
+        pointer slot = _m_slot(block, block.count - 1);
+        Type value(std::move(*slot));
+        std::allocator_traits<Allocator>::destroy(_m_allocator, slot);
+        --block.count;
+        return value;
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(const Allocator& alloc) : _m_allocator(alloc) {}
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(size_type size, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size);
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(size_type size, const Type& value, const Allocator& alloc) : _m_allocator(alloc) {
+        resize(size, value);
+    }
+
+    template<typename Type, typename Allocator>
+    template<class InputIt, class>
+    tiered_vector<Type, Allocator>::tiered_vector(InputIt first, InputIt last, const Allocator& alloc) : _m_allocator(alloc) {
+        try {
+            for (; first != last; ++first) emplace_back(*first);
+        } catch (...) {
+            _m_free_blocks();
+            throw;
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(std::initializer_list<Type> init, const Allocator& alloc)
+        : tiered_vector(init.begin(), init.end(), alloc) {}
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(const tiered_vector& other)
+        : tiered_vector(other.begin(), other.end(), std::allocator_traits<Allocator>::select_on_container_copy_construction(other._m_allocator)) {}
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::tiered_vector(tiered_vector&& other) noexcept
+        : _m_allocator(other._m_allocator), _m_blocks(std::move(other._m_blocks)), _m_size(other._m_size), _m_shift(other._m_shift) {
+        other._m_size = 0;
+        other._m_shift = _m_log2(MIN_BLOCK_SIZE);
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>::~tiered_vector() {
+        _m_free_blocks();
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>& tiered_vector<Type, Allocator>::operator=(const tiered_vector& other) {
+        if (this != &other) {
+            tiered_vector copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    template<typename Type, typename Allocator>
+    tiered_vector<Type, Allocator>& tiered_vector<Type, Allocator>::operator=(tiered_vector&& other) noexcept {
+        if (this != &other) {
+            _m_free_blocks();
+            swap(other);
+        }
+        return *this;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::allocator_type tiered_vector<Type, Allocator>::get_allocator() const {
+        return _m_allocator;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reference tiered_vector<Type, Allocator>::at(size_type pos) {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reference tiered_vector<Type, Allocator>::at(size_type pos) const {
+        if (pos >= _m_size) throw std::out_of_range("Out of range");
+        return (*this)[pos];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reference tiered_vector<Type, Allocator>::operator[](size_type pos) {
+        return *_m_slot(_m_blocks[pos >> _m_shift], pos & _m_mask());
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reference tiered_vector<Type, Allocator>::operator[](size_type pos) const {
+        return *_m_slot(_m_blocks[pos >> _m_shift], pos & _m_mask());
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reference tiered_vector<Type, Allocator>::front() {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reference tiered_vector<Type, Allocator>::front() const {
+        return (*this)[0];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reference tiered_vector<Type, Allocator>::back() {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reference tiered_vector<Type, Allocator>::back() const {
+        return (*this)[_m_size - 1];
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_iterator tiered_vector<Type, Allocator>::begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_iterator tiered_vector<Type, Allocator>::cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::end() noexcept {
+        return iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_iterator tiered_vector<Type, Allocator>::end() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_iterator tiered_vector<Type, Allocator>::cend() const noexcept {
+        return const_iterator(this, _m_size);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reverse_iterator tiered_vector<Type, Allocator>::rbegin() noexcept {
+        return reverse_iterator(end());
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reverse_iterator tiered_vector<Type, Allocator>::rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::reverse_iterator tiered_vector<Type, Allocator>::rend() noexcept {
+        return reverse_iterator(begin());
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::const_reverse_iterator tiered_vector<Type, Allocator>::rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    template<typename Type, typename Allocator>
+    bool tiered_vector<Type, Allocator>::empty() const noexcept {
+        return _m_size == 0;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::size_type tiered_vector<Type, Allocator>::size() const noexcept {
+        return _m_size;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::size_type tiered_vector<Type, Allocator>::max_size() const noexcept {
+        return std::numeric_limits<size_type>::max() / sizeof(Type);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::size_type tiered_vector<Type, Allocator>::capacity() const noexcept {
+        return _m_blocks.size() << _m_shift;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::size_type tiered_vector<Type, Allocator>::block_size() const noexcept {
+        return size_type(1) << _m_shift;
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::clear() noexcept {
+        _m_free_blocks();
+        _m_shift = _m_log2(MIN_BLOCK_SIZE);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::insert(const_iterator pos, const Type& value) {
+        return emplace(pos, value);
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::insert(const_iterator pos, Type&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    //the last element of every block from the target to the end moves to the front of the next one,
+    //then the target block shifts its elements after the position up by one
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::emplace(const_iterator pos, Args&&... args) {
+        size_type index = pos.index();
+        if (index == _m_size) {
+            emplace_back(std::forward<Args>(args)...);
+            return begin() + index;
+        }
+        Type value(std::forward<Args>(args)...);
+        if (_m_size == capacity()) _m_add_block();
+        size_type target = index >> _m_shift;
+        for (size_type b = _m_size >> _m_shift; b > target; --b) _m_push_front(_m_blocks[b], _m_pop_back(_m_blocks[b - 1]));
+
+        _m_block& block = _m_blocks[target];
+        size_type offset = index & _m_mask();
+        if (offset == block.count) {
+            _m_push_back(block, std::move(value));
+        } else {
+            _m_push_back(block, std::move(*_m_slot(block, block.count - 1)));
+            for (size_type i = block.count - 2; i > offset; --i) *_m_slot(block, i) = std::move(*_m_slot(block, i - 1));
+            *_m_slot(block, offset) = std::move(value);
+        }
+        ++_m_size;
+        _m_rebalance();
+        return begin() + index;
+    }
+
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::erase(const_iterator pos) {
+        size_type index = pos.index();
+        size_type target = index >> _m_shift;
+        _m_block& block = _m_blocks[target];
+        for (size_type i = index & _m_mask(); i + 1 < block.count; ++i) *_m_slot(block, i) = std::move(*_m_slot(block, i + 1));
+        std::allocator_traits<Allocator>::destroy(_m_allocator, _m_slot(block, block.count - 1));
+        --block.count;
+        for (size_type b = target + 1; b < _m_blocks.size() && _m_blocks[b].count; ++b) {
+            _m_push_back(_m_blocks[b - 1], _m_pop_front(_m_blocks[b]));
+        }
+        //at most one empty block is kept as spare room
+        if (_m_blocks.size() > 1 && _m_blocks[_m_blocks.size() - 2].count == 0) {
+            std::allocator_traits<Allocator>::deallocate(_m_allocator, _m_blocks.back().slots, block_size());
+            _m_blocks.erase(_m_blocks.cend() - 1, _m_blocks.cend());
+        }
+        --_m_size;
+        _m_rebalance();
+        return begin() + index;
+    }
+
+    //short ranges erase one by one in O(sqrt n) each, long ones move the tail down in O(n)
+    template<typename Type, typename Allocator>
+    typename tiered_vector<Type, Allocator>::iterator tiered_vector<Type, Allocator>::erase(const_iterator first, const_iterator last) {
+        size_type from = first.index(), count = last.index() - first.index();
+        if (count * block_size() < _m_size) {
+            for (size_type i = 0; i < count; ++i) erase(cbegin() + from);
+        } else {
+            std::move(begin() + from + count, end(), begin() + from);
+            for (size_type i = 0; i < count; ++i) pop_back();
+        }
+        return begin() + from;
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::push_back(const Type& value) {
+        emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::push_back(Type&& value) {
+        emplace_back(std::move(value));
+    }
+
+    template<typename Type, typename Allocator>
+    template<class... Args>
+    typename tiered_vector<Type, Allocator>::reference tiered_vector<Type, Allocator>::emplace_back(Args&&... args) {
+        if (_m_size == capacity()) _m_add_block();
+        _m_block& block = _m_blocks[_m_size >> _m_shift];
+        _m_push_back(block, std::forward<Args>(args)...);
+        ++_m_size;
+        if (_m_size > 2 * block_size() * block_size()) _m_rebuild(_m_shift + 1);
+        return back();
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::pop_back() {
+        erase(cend() - 1);
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::resize(size_type count) {
+        while (_m_size > count) pop_back();
+        while (_m_size < count) emplace_back();
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::resize(size_type count, const value_type& value) {
+        while (_m_size > count) pop_back();
+        while (_m_size < count) emplace_back(value);
+    }
+
+    template<typename Type, typename Allocator>
+    void tiered_vector<Type, Allocator>::swap(tiered_vector& other) noexcept {
+        std::swap(_m_allocator, other._m_allocator);
+        _m_blocks.swap(other._m_blocks);
+        std::swap(_m_size, other._m_size);
+        std::swap(_m_shift, other._m_shift);
+    }
+
+    template <class Type, class Allocator>
+    bool operator==(const tiered_vector<Type, Allocator>& lhs, const tiered_vector<Type, Allocator>& rhs) {
+        return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    }
+
+    template <class Type, class Allocator>
+    bool operator!=(const tiered_vector<Type, Allocator>& lhs, const tiered_vector<Type, Allocator>& rhs) {
+        return !(lhs == rhs);
+    }
+}
@@ -1,11 +1,139 @@
+#pragma once
+
 #include <algorithm>
 #include <exception>
 #include <stdexcept>
 #include <initializer_list>
 #include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "growth_policy.hpp"
+#include "thread_pool.hpp"
+#ifdef ART_VECTOR_PUSH_LATENCY
+#include "push_latency.hpp"
+#endif
 
 namespace art{
 
+    //Iterators of art::vector are raw pointers, so standard algorithms take their memmove/memcmp
+    //paths exactly as for std::vector. Defining ART_VECTOR_WRAPPED_ITERATORS switches to this class,
+    //a distinct type that still unwraps for free through base() and art::to_address.
+    template<typename TypeT>
+    class vector_iterator : public std::iterator<std::random_access_iterator_tag, TypeT> {
+    public:
+        typedef TypeT&         reference;
+        typedef TypeT*         pointer;
+        typedef std::ptrdiff_t difference_type;
+
+        vector_iterator() : _ptr(nullptr) {}
+        vector_iterator(TypeT* rhs) : _ptr(rhs) {}
+        vector_iterator(const vector_iterator &rhs) : _ptr(rhs._ptr) {}
+        template<typename OtherT, typename = typename std::enable_if<std::is_convertible<OtherT*, TypeT*>::value>::type>
+        vector_iterator(const vector_iterator<OtherT> &rhs) : _ptr(rhs.base()) {}
+        inline vector_iterator& operator=(const vector_iterator &rhs) {_ptr = rhs._ptr; return *this;}
+        inline vector_iterator& operator+=(difference_type rhs) {_ptr += rhs; return *this;}
+        inline vector_iterator& operator-=(difference_type rhs) {_ptr -= rhs; return *this;}
+
+        inline reference operator*() const {return *_ptr;}
+        inline reference operator[](difference_type rhs) const {return _ptr[rhs];}
+        inline pointer   operator->() const {return _ptr;}
+        inline pointer   base() const noexcept {return _ptr;}
+
+        inline vector_iterator& operator++() {++_ptr; return *this;}
+        inline vector_iterator& operator--() {--_ptr; return *this;}
+        inline vector_iterator  operator++(int) {vector_iterator tmp(*this); ++_ptr; return tmp;}
+        inline vector_iterator  operator--(int) {vector_iterator tmp(*this); --_ptr; return tmp;}
+        inline vector_iterator  operator+(difference_type rhs) const {return vector_iterator(_ptr+rhs);}
+        inline vector_iterator  operator-(difference_type rhs) const {return vector_iterator(_ptr-rhs);}
+
+        //friends, so that iterator and const_iterator mix through the converting constructor
+        friend inline vector_iterator operator+(difference_type lhs, const vector_iterator& rhs) {return rhs + lhs;}
+        friend inline difference_type operator-(const vector_iterator& lhs, const vector_iterator& rhs) {return lhs._ptr - rhs._ptr;}
+        friend inline bool operator==(const vector_iterator& lhs, const vector_iterator& rhs) {return lhs._ptr == rhs._ptr;}
+        friend inline bool operator!=(const vector_iterator& lhs, const vector_iterator& rhs) {return lhs._ptr != rhs._ptr;}
+        friend inline bool operator>(const vector_iterator& lhs, const vector_iterator& rhs)  {return lhs._ptr > rhs._ptr;}
+        friend inline bool operator<(const vector_iterator& lhs, const vector_iterator& rhs)  {return lhs._ptr < rhs._ptr;}
+        friend inline bool operator>=(const vector_iterator& lhs, const vector_iterator& rhs) {return lhs._ptr >= rhs._ptr;}
+        friend inline bool operator<=(const vector_iterator& lhs, const vector_iterator& rhs) {return lhs._ptr <= rhs._ptr;}
+    private:
+        pointer _ptr;
+    };
+
+    //raw pointer behind a vector iterator, whichever iterator type is configured
+    template<typename TypeT>
+    inline TypeT* to_address(TypeT* ptr) noexcept {return ptr;}
+
+    template<typename TypeT>
+    inline TypeT* to_address(const vector_iterator<TypeT>& it) noexcept {return it.base();}
+
+    namespace detail{
+        //reads an element as container[index]
+        struct subscript_access{
+            template <typename ContainerT>
+            auto operator()(ContainerT& container, std::size_t index) const -> decltype(container[index]) {return container[index];}
+        };
+
+        //Random access iterator of the containers addressed by position: a container pointer and an
+        //index, dereferenced through AccessT. An AccessT may remember in mutable members where the last
+        //element was found (a leaf, a run, a shard) so sequential reads skip the lookup. ReferenceT may
+        //be a proxy returned by value, pointer is void and operator-> unusable then.
+        template <typename ContainerT, typename ReferenceT, typename ValueT = typename std::decay<ReferenceT>::type,
+                  typename AccessT = subscript_access>
+        class index_iterator : public std::iterator<std::random_access_iterator_tag, ValueT, std::ptrdiff_t,
+                                                    typename std::conditional<std::is_reference<ReferenceT>::value,
+                                                                              typename std::remove_reference<ReferenceT>::type*, void>::type,
+                                                    ReferenceT>,
+                               private AccessT {
+        public:
+            typedef ReferenceT     reference;
+            typedef typename std::conditional<std::is_reference<ReferenceT>::value,
+                                              typename std::remove_reference<ReferenceT>::type*, void>::type pointer;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::size_t    size_type;
+
+            index_iterator() : _container(nullptr), _index(0) {}
+            index_iterator(ContainerT* container, size_type index) : _container(container), _index(index) {}
+            template<typename OtherC, typename OtherR, typename OtherV,
+                     typename = typename std::enable_if<std::is_convertible<OtherC*, ContainerT*>::value>::type>
+            index_iterator(const index_iterator<OtherC, OtherR, OtherV, AccessT>& rhs) : _container(rhs.container()), _index(rhs.index()) {}
+
+            inline index_iterator& operator+=(difference_type rhs) {_index += rhs; return *this;}
+            inline index_iterator& operator-=(difference_type rhs) {_index -= rhs; return *this;}
+            inline reference operator*() const {return AccessT::operator()(*_container, _index);}
+            inline reference operator[](difference_type rhs) const {return AccessT::operator()(*_container, _index + rhs);}
+            inline pointer   operator->() const {return &**this;}
+
+            inline index_iterator& operator++() {++_index; return *this;}
+            inline index_iterator& operator--() {--_index; return *this;}
+            inline index_iterator  operator++(int) {index_iterator tmp(*this); ++_index; return tmp;}
+            inline index_iterator  operator--(int) {index_iterator tmp(*this); --_index; return tmp;}
+            inline index_iterator  operator+(difference_type rhs) const {index_iterator tmp(*this); return tmp += rhs;}
+            inline index_iterator  operator-(difference_type rhs) const {index_iterator tmp(*this); return tmp -= rhs;}
+
+            //friends, so that iterator and const_iterator mix through the converting constructor
+            friend inline index_iterator operator+(difference_type lhs, const index_iterator& rhs) {return rhs + lhs;}
+            friend inline difference_type operator-(const index_iterator& lhs, const index_iterator& rhs) {return difference_type(lhs._index - rhs._index);}
+            friend inline bool operator==(const index_iterator& lhs, const index_iterator& rhs) {return lhs._index == rhs._index;}
+            friend inline bool operator!=(const index_iterator& lhs, const index_iterator& rhs) {return lhs._index != rhs._index;}
+            friend inline bool operator<(const index_iterator& lhs, const index_iterator& rhs)  {return lhs._index < rhs._index;}
+            friend inline bool operator>(const index_iterator& lhs, const index_iterator& rhs)  {return lhs._index > rhs._index;}
+            friend inline bool operator<=(const index_iterator& lhs, const index_iterator& rhs) {return lhs._index <= rhs._index;}
+            friend inline bool operator>=(const index_iterator& lhs, const index_iterator& rhs) {return lhs._index >= rhs._index;}
+
+            ContainerT* container() const noexcept {return _container;}
+            size_type index() const noexcept {return _index;}
+        private:
+            ContainerT* _container;
+            size_type _index;
+        };
+    }
+
+    //tag of the vector constructor taking over storage filled by the caller
+    struct adopt_buffer_t{};
+    const adopt_buffer_t adopt_buffer = adopt_buffer_t();
+
     template <typename Type, typename Allocator = std::allocator<Type>>
     class vector{
     public:
@@ -18,40 +146,13 @@ namespace art{
         typedef typename std::allocator_traits<Allocator>::pointer       pointer;
         typedef typename std::allocator_traits<Allocator>::const_pointer const_pointer;
 
-        template<typename TypeT>
-        class vector_iterator : public std::iterator<std::random_access_iterator_tag, TypeT> {
-        public:
-            vector_iterator() : _ptr(nullptr) {}
-            vector_iterator(TypeT* rhs) : _ptr(rhs) {}
-            vector_iterator(const vector_iterator &rhs) : _ptr(rhs._ptr) {}
-            inline vector_iterator& operator=(const vector_iterator &rhs) {_ptr = rhs._ptr; return *this;}
-            inline vector_iterator& operator+=(difference_type rhs) {_ptr += rhs; return *this;}
-            inline vector_iterator& operator-=(difference_type rhs) {_ptr -= rhs; return *this;}
-
-            inline reference operator*() const {return *_ptr;}
-            inline reference operator[](difference_type rhs) const {return _ptr[rhs];}
-            inline pointer   operator->() const {return _ptr;}
-
-            inline vector_iterator& operator++() {++_ptr; return *this;}
-            inline vector_iterator& operator--() {--_ptr; return *this;}
-            inline vector_iterator  operator++(int) {vector_iterator tmp(*this); ++_ptr; return tmp;}
-            inline vector_iterator  operator--(int) {vector_iterator tmp(*this); --_ptr; return tmp;}
-            inline vector_iterator  operator+(difference_type rhs) const {return vector_iterator(_ptr+rhs);}
-            inline vector_iterator  operator-(difference_type rhs) const {return vector_iterator(_ptr-rhs);}
-            inline difference_type  operator-(const vector_iterator& rhs) const {return _ptr-rhs._ptr;}
-
-            inline bool operator==(const vector_iterator& rhs) const {return _ptr == rhs._ptr;}
-            inline bool operator!=(const vector_iterator& rhs) const {return _ptr != rhs._ptr;}
-            inline bool operator>(const vector_iterator& rhs)  const {return _ptr > rhs._ptr;}
-            inline bool operator<(const vector_iterator& rhs)  const {return _ptr < rhs._ptr;}
-            inline bool operator>=(const vector_iterator& rhs) const {return _ptr >= rhs._ptr;}
-            inline bool operator<=(const vector_iterator& rhs) const {return _ptr <= rhs._ptr;}
-        private:
-            pointer _ptr;
-        };
-
-        typedef vector_iterator<Type>                              iterator;
-        typedef const vector_iterator<Type>                        const_iterator;
+#ifdef ART_VECTOR_WRAPPED_ITERATORS
+        typedef vector_iterator<Type>                                    iterator;
+        typedef vector_iterator<const Type>                              const_iterator;
+#else
+        typedef Type*                                                    iterator;
+        typedef const Type*                                              const_iterator;
+#endif
         typedef typename std::reverse_iterator<iterator>                 reverse_iterator;
         typedef typename std::reverse_iterator<const_iterator>           const_reverse_iterator;
 
@@ -63,10 +164,14 @@ namespace art{
         template< class InputIt >
         vector( InputIt first, InputIt last, const Allocator& alloc = Allocator() );
 
-        vector( const vector& other, const Allocator& alloc );
+        vector( const vector& other, const Allocator& alloc = Allocator() );
         vector( std::initializer_list<Type> init, const Allocator& alloc = Allocator() );
 
-        vector( vector&& other, const Allocator& alloc );
+        vector( vector&& other, const Allocator& alloc = Allocator() );
+
+        //takes over capacity elements allocated from alloc, the first size of them constructed,
+        //so builders can fill uninitialized storage in any order before handing it over
+        vector( adopt_buffer_t, pointer first, size_type size, size_type capacity, const Allocator& alloc = Allocator() ) noexcept;
 
         ~vector();
 
@@ -104,11 +209,11 @@ namespace art{
         //iterators
         iterator                begin() noexcept;
         const_iterator          begin() const noexcept;
-        const_iterator          cbegin() noexcept;
+        const_iterator          cbegin() const noexcept;
 
         iterator                end() noexcept;
         const_iterator          end() const noexcept;
-        const_iterator          cend() noexcept;
+        const_iterator          cend() const noexcept;
 
         reverse_iterator        rbegin() noexcept;
         const_reverse_iterator  rbegin() const noexcept;
@@ -154,6 +259,12 @@ namespace art{
 
         void swap( vector& other ) noexcept;
 
+#ifdef ART_VECTOR_PUSH_LATENCY
+        //latency tracing of push_back/emplace_back/insert, nullptr disables it; compiled in only
+        //with ART_VECTOR_PUSH_LATENCY, so the default vector has no hook pointer and no branch
+        void set_push_hook(push_latency_hook* hook) noexcept;
+        push_latency_hook* push_hook() const noexcept;
+#endif
 
 
         //Operators
@@ -176,55 +287,134 @@ namespace art{
         friend bool operator<=(const vector<U, UAllocator>& lhs, const vector<U, UAllocator>& rhs);
 
     private:
-        const int _m_SIZE_INCREASE_FACTOR = 2;
-
         Allocator _m_allocator;
         pointer _m_first = nullptr;
         pointer _m_last = nullptr;
         pointer _m_end_of_capacity = nullptr;
+#ifdef ART_VECTOR_PUSH_LATENCY
+        push_latency_hook* _m_push_hook = nullptr;
+
+        //times one growing operation and reports it to the hook if there is one
+        class _m_push_probe{
+        public:
+            explicit _m_push_probe(const vector& owner);
+            void finish();
+        private:
+            const vector& _m_owner;
+            size_type _m_old_capacity = 0;
+            size_type _m_old_size = 0;
+            std::chrono::steady_clock::time_point _m_start;
+        };
+#else
+        //tracing compiled out, the probe folds away
+        struct _m_push_probe{
+            explicit _m_push_probe(const vector&) noexcept {}
+            void finish() noexcept {}
+        };
+#endif
 
-        void _m_allocate_and_copy(size_type need_size);
+        void _m_allocate_and_copy(size_type new_capacity);
+        void _m_grow(size_type need_size);
         void _m_initialize(iterator first, iterator last);
         void _m_destroy(iterator first, iterator last);
+
+        //runs fn(first, last) over index ranges of [0, count), split across
+        //thread_pool::instance() once count reaches parallel_threshold()
+        template <typename Function>
+        static void _m_for_each_chunk(size_type count, Function fn);
+
+        template <typename InputIt>
+        void _m_construct_from(InputIt first, size_type count, std::input_iterator_tag);
+        template <typename RandomIt>
+        void _m_construct_from(RandomIt first, size_type count, std::random_access_iterator_tag);
     };
 
     template<typename Type, typename Allocator>
-    void vector<Type, Allocator>::_m_allocate_and_copy(size_type need_size) {
-        if (need_size >= capacity()) {
-            need_size = need_size * _m_SIZE_INCREASE_FACTOR;
-        }
-        pointer new_first = _m_allocator.allocate(need_size);
-        if (new_first == _m_first)
-            return;
-        for (size_type i = 0; i < size(); ++i){
+    void vector<Type, Allocator>::_m_allocate_and_copy(size_type new_capacity) {
+        pointer new_first = new_capacity ? _m_allocator.allocate(new_capacity) : nullptr;
+        size_type old_size = size();
+        for (size_type i = 0; i < old_size; ++i){
             std::allocator_traits<Allocator>::construct(_m_allocator, new_first + i, std::forward<Type>(_m_first[i]));
             std::allocator_traits<Allocator>::destroy(_m_allocator, _m_first + i);
         }
-        size_type old_size = size();
+        if (_m_first) _m_allocator.deallocate(_m_first, capacity());
         _m_first = new_first;
         _m_last = new_first + old_size;
-        _m_end_of_capacity = _m_first + need_size;
+        _m_end_of_capacity = _m_first + new_capacity;
     }
 
+    template<typename Type, typename Allocator>
+    void vector<Type, Allocator>::_m_grow(size_type need_size) {
+        if (need_size > capacity()) _m_allocate_and_copy(growth_policy<Type>::next_capacity(capacity(), need_size));
+    }
+
+#ifdef ART_VECTOR_PUSH_LATENCY
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator>::_m_push_probe::_m_push_probe(const vector& owner) : _m_owner(owner) {
+        if (!_m_owner._m_push_hook) return;
+        _m_old_capacity = _m_owner.capacity();
+        _m_old_size = _m_owner.size();
+        _m_start = std::chrono::steady_clock::now();
+    }
+
+    template<typename Type, typename Allocator>
+    void vector<Type, Allocator>::_m_push_probe::finish() {
+        if (!_m_owner._m_push_hook) return;
+        auto elapsed = std::chrono::steady_clock::now() - _m_start;
+        growth_trace_event event;
+        event.old_capacity = _m_old_capacity;
+        event.new_capacity = _m_owner.capacity();
+        event.elements_moved = event.new_capacity != _m_old_capacity ? _m_old_size : 0;
+        event.nanoseconds = (std::uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        _m_owner._m_push_hook->record(event);
+    }
+#endif
+
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::_m_initialize(iterator first, iterator last) {
-        for (auto it = first; it != last; ++it){
-            _m_allocator.construct(&*it, Type());
-        }
+        pointer base = to_address(first);
+        _m_for_each_chunk(last - first, [this, base](size_type from, size_type to) {
+            for (size_type i = from; i < to; ++i) _m_allocator.construct(base + i, Type());
+        });
     }
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::_m_destroy(iterator first, iterator last) {
-        for (iterator it = first; it != last; ++it){
-            _m_allocator.destroy(&*it);
-        }
+        if (std::is_trivially_destructible<Type>::value || first == last) return;
+        pointer base = to_address(first);
+        _m_for_each_chunk(last - first, [this, base](size_type from, size_type to) {
+            for (size_type i = from; i < to; ++i) _m_allocator.destroy(base + i);
+        });
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename Function>
+    void vector<Type, Allocator>::_m_for_each_chunk(size_type count, Function fn) {
+        size_type threshold = parallel_threshold();
+        if (threshold == 0 || count < threshold) fn(size_type(0), count);
+        else thread_pool::instance().parallel_chunks(count, fn);
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename InputIt>
+    void vector<Type, Allocator>::_m_construct_from(InputIt first, size_type count, std::input_iterator_tag) {
+        for (size_type i = 0; i < count; ++i, ++first) _m_allocator.construct(_m_first + i, value_type(*first));
+    }
+
+    template<typename Type, typename Allocator>
+    template<typename RandomIt>
+    void vector<Type, Allocator>::_m_construct_from(RandomIt first, size_type count, std::random_access_iterator_tag) {
+        _m_for_each_chunk(count, [this, first](size_type from, size_type to) {
+            for (size_type i = from; i < to; ++i) _m_allocator.construct(_m_first + i, first[i]);
+        });
     }
 
     template<typename Type, typename Allocator>
     vector<Type, Allocator>::vector(const vector& other, const Allocator& alloc ) {
         _m_allocator = alloc;
         _m_allocate_and_copy(other.size());
-        for (size_type i = 0; i < other.size(); ++i) _m_allocator.construct(_m_first + i, other[i]);
+        _m_construct_from(other._m_first, other.size(), std::random_access_iterator_tag());
+        _m_last = _m_first + other.size();
     }
     template<typename Type, typename Allocator>
     vector<Type, Allocator>::vector(size_type new_size) {
@@ -253,10 +443,23 @@ namespace art{
     template<typename Type, typename Allocator>
     vector<Type, Allocator>::vector( vector&& other, const Allocator& alloc ) {
         _m_allocator = alloc;
-        _m_first = other._m_first;
-        _m_last = other._m_last;
-        _m_end_of_capacity = other._m_end_of_capacity;
-        assign(other.begin(), other.end());
+        if (_m_allocator == other._m_allocator) {
+            std::swap(_m_first, other._m_first);
+            std::swap(_m_last, other._m_last);
+            std::swap(_m_end_of_capacity, other._m_end_of_capacity);
+        } else {
+            _m_allocate_and_copy(other.size());
+            _m_construct_from(std::make_move_iterator(other._m_first), other.size(), std::random_access_iterator_tag());
+            _m_last = _m_first + other.size();
+        }
+    }
+
+    template<typename Type, typename Allocator>
+    vector<Type, Allocator>::vector(adopt_buffer_t, pointer first, size_type size, size_type capacity, const Allocator& alloc) noexcept {
+        _m_allocator = alloc;
+        _m_first = first;
+        _m_last = first + size;
+        _m_end_of_capacity = first + capacity;
     }
 
     template<typename Type, typename Allocator>
@@ -279,9 +482,7 @@ namespace art{
             if (other.size() > capacity()) {
                 _m_allocate_and_copy(other.size());
             }
-            for (size_type i = 0; i < other.size(); ++i) {
-                _m_allocator.construct(_m_first + i, other[i]);
-            }
+            _m_construct_from(other._m_first, other.size(), std::random_access_iterator_tag());
             _m_last = _m_first + other.size();
         }
         return *this;
@@ -302,11 +503,11 @@ namespace art{
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::begin() const noexcept {
-        return iterator(_m_first);
+        return const_iterator(_m_first);
     }
 
     template<typename Type, typename Allocator>
-    typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::cbegin() noexcept {
+    typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::cbegin() const noexcept {
         return begin();
     }
 
@@ -317,49 +518,51 @@ namespace art{
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::end() const noexcept {
-        return iterator(_m_last);
+        return const_iterator(_m_last);
     }
 
     template<typename Type, typename Allocator>
-    typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::cend() noexcept {
+    typename vector<Type, Allocator>::const_iterator vector<Type, Allocator>::cend() const noexcept {
         return end();
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::reverse_iterator vector<Type, Allocator>::rbegin() noexcept {
-        return vector<Type, Allocator>::reverse_iterator(_m_first + size());
+        return reverse_iterator(end());
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_reverse_iterator vector<Type, Allocator>::rbegin() const noexcept {
-        return vector<Type, Allocator>::const_reverse_iterator(_m_last - 1);
+        return const_reverse_iterator(end());
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_reverse_iterator vector<Type, Allocator>::crbegin() const noexcept {
-        return vector<Type, Allocator>::const_reverse_iterator(_m_last - 1);
+        return const_reverse_iterator(end());
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::reverse_iterator vector<Type, Allocator>::rend() noexcept {
-        return vector<Type, Allocator>::reverse_iterator(_m_first - 1);
+        return reverse_iterator(begin());
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_reverse_iterator vector<Type, Allocator>::rend() const noexcept {
-        return vector<Type, Allocator>::const_reverse_iterator(_m_first - 1);
+        return const_reverse_iterator(begin());
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::const_reverse_iterator vector<Type, Allocator>::crend() const noexcept {
-        return vector<Type, Allocator>::const_reverse_iterator(_m_first - 1);
+        return const_reverse_iterator(begin());
     }
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::assign(size_type count, const Type& value) {
         erase(begin(), end());
         if (count > capacity()) _m_allocate_and_copy(count);
-        for (size_type i = 0; i < count; ++i) _m_allocator.construct(_m_first + i, value);
+        _m_for_each_chunk(count, [this, &value](size_type from, size_type to) {
+            for (size_type i = from; i < to; ++i) _m_allocator.construct(_m_first + i, value);
+        });
         _m_last = _m_first + count;
     }
 
@@ -373,68 +576,75 @@ namespace art{
             _m_allocate_and_copy((unsigned int) count);
         }
 
-        for (auto it = begin(); first != last; ++it, ++first) {
-            _m_allocator.construct(&*it, value_type(*first));
-        }
-
+        _m_construct_from(first, count, typename std::iterator_traits<InputIt>::iterator_category());
         _m_last = _m_first + count;
     }
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::push_back(Type&& value) {
-        size_type new_size = size() + 1;
-        if (new_size >= capacity()) _m_allocate_and_copy(new_size);
-        std::swap(*(_m_last++), value);
+        _m_push_probe probe(*this);
+        _m_grow(size() + 1);
+        std::allocator_traits<Allocator>::construct(_m_allocator, _m_last, std::move(value));
+        ++_m_last;
+        probe.finish();
     }
 
     template<typename Type, typename Allocator>
     template<class... Args>
     void vector<Type, Allocator>::emplace_back(Args&& ... args) {
-        _m_allocate_and_copy(size() + 1);
+        _m_push_probe probe(*this);
+        _m_grow(size() + 1);
         std::allocator_traits<Allocator>::construct(_m_allocator, _m_first + size(), std::forward<Args&&>(args)...);
         ++_m_last;
+        probe.finish();
     }
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::pop_back() {
-        std::allocator_traits<Allocator>::destroy(_m_allocator, _m_last);
         --_m_last;
+        std::allocator_traits<Allocator>::destroy(_m_allocator, _m_last);
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::iterator vector<Type, Allocator>::insert(const_iterator pos, const Type& value) {
+        _m_push_probe probe(*this);
         size_type new_size = size() + 1;
-        size_type index = pos - begin();
-        if (new_size > capacity()) _m_allocate_and_copy(new_size);
-        pos = begin() + index;
-        std::copy_backward(pos, end(), pos + size() - index + 1);
-        *pos = value;
+        size_type index = pos - cbegin();
+        _m_grow(new_size);
+        iterator it = begin() + index;
+        std::copy_backward(it, end(), end() + 1);
+        *it = value;
         ++_m_last;
-        return pos;
+        probe.finish();
+        return it;
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::iterator vector<Type, Allocator>::insert(const_iterator pos, Type&& value) {
+        _m_push_probe probe(*this);
         size_type new_size = size() + 1;
-        size_type insert_to = pos - begin();
-        if (new_size > capacity()) _m_allocate_and_copy(new_size);
+        size_type insert_to = pos - cbegin();
+        _m_grow(new_size);
         auto new_iter_for_insert = begin() + insert_to;
         std::copy_backward(new_iter_for_insert, end(), end() + 1);
         *new_iter_for_insert = value;
         ++(_m_last);
+        probe.finish();
         return new_iter_for_insert;
     }
 
     template<typename Type, typename Allocator>
     typename vector<Type, Allocator>::iterator vector<Type, Allocator>::insert(const_iterator pos, size_type n, const Type& value) {
+        _m_push_probe probe(*this);
         size_type new_size = size() + n;
-        size_type insert_to = pos - begin();
-        if (new_size > capacity()) _m_allocate_and_copy(new_size);
-        pos = begin() + insert_to;
-        std::copy_backward(pos, end(), pos + n + size() - insert_to);
-        std::fill(pos, pos + n, value);
+        size_type insert_to = pos - cbegin();
+        _m_grow(new_size);
+        iterator it = begin() + insert_to;
+        std::copy_backward(it, end(), end() + n);
+        std::fill(it, it + n, value);
         _m_last = _m_first + new_size;
-        return pos;
+        probe.finish();
+        return it;
     }
 
     template<typename Type, typename Allocator>
@@ -445,43 +655,45 @@ namespace art{
     template<typename T, typename Allocator>
     template<class... Args>
     typename vector<T, Allocator>::iterator vector<T, Allocator>::emplace(const_iterator pos, Args&& ... args) {
-        size_type index = pos - begin();
+        size_type index = pos - cbegin();
         size_type new_size = size() + 1;
-        if (new_size > capacity()) _m_allocate_and_copy(new_size);
+        _m_grow(new_size);
         auto new_iter = begin() + index;
-        std::copy_backward(new_iter, end(), ++_m_last);
-        _m_allocator.construct(&*new_iter, std::forward<Args>(args)...);
+        std::copy_backward(new_iter, end(), end() + 1);
+        ++_m_last;
+        _m_allocator.construct(to_address(new_iter), std::forward<Args>(args)...);
         return new_iter;
     }
 
     template<typename Type, typename Allocator>
     template<typename InputIt, typename isIterator>
     typename vector<Type, Allocator>::iterator vector<Type, Allocator>::insert(const_iterator from, InputIt first, InputIt last) {
+        _m_push_probe probe(*this);
         difference_type distance = std::distance(first, last);
         size_type new_size = size() + distance;
-        size_type index = from - begin();
-        if (new_size > capacity()) _m_allocate_and_copy(new_size);
+        size_type index = from - cbegin();
+        _m_grow(new_size);
         auto iter = begin() + index;
         std::copy_backward(iter, end(), end() + distance);
         std::copy(first, last, iter);
         _m_last = _m_first + new_size;
+        probe.finish();
         return iter;
     }
 
     template<typename Type, typename Allocator>
-    typename vector<Type, Allocator>::iterator vector<Type, Allocator>::erase(iterator pos) {
-        std::allocator_traits<Allocator>::destroy(_m_allocator, &*pos);
-        std::copy(pos + 1, end(), pos);
-        --_m_last;
-        return pos;
+    typename vector<Type, Allocator>::iterator vector<Type, Allocator>::erase(const_iterator pos) {
+        return erase(pos, pos + 1);
     }
 
     template<typename Type, typename Allocator>
-    typename vector<Type, Allocator>::iterator vector<Type, Allocator>::erase(iterator first, iterator last) {
-        for (iterator it = first; it != last; ++it) std::allocator_traits<Allocator>::destroy(_m_allocator, &*it);
-        if (end() > last + 1) std::copy(last + 1, end(), first + 1);
-        _m_last -= std::distance(first, last);
-        return first;
+    typename vector<Type, Allocator>::iterator vector<Type, Allocator>::erase(const_iterator first, const_iterator last) {
+        iterator it = begin() + (first - cbegin());
+        if (first == last) return it;
+        iterator new_end = std::move(it + (last - first), end(), it);
+        for (iterator dead = new_end; dead != end(); ++dead) std::allocator_traits<Allocator>::destroy(_m_allocator, to_address(dead));
+        _m_last = to_address(new_end);
+        return it;
     }
 
     template<typename Type, typename Allocator>
@@ -494,10 +706,23 @@ namespace art{
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::clear() noexcept {
+        _m_destroy(begin(), end());
         _m_allocator.deallocate(_m_first, capacity());
         _m_first = _m_last = _m_end_of_capacity = nullptr;
     }
 
+#ifdef ART_VECTOR_PUSH_LATENCY
+    template<typename Type, typename Allocator>
+    void vector<Type, Allocator>::set_push_hook(push_latency_hook* hook) noexcept {
+        _m_push_hook = hook;
+    }
+
+    template<typename Type, typename Allocator>
+    push_latency_hook* vector<Type, Allocator>::push_hook() const noexcept {
+        return _m_push_hook;
+    }
+#endif
+
     template<typename Type, typename Allocator>
     Allocator vector<Type, Allocator>::get_allocator() const{
         return _m_allocator;
@@ -506,7 +731,7 @@ namespace art{
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::resize(size_type count) {
         size_type current_size = size();
-        if (count > capacity()) _m_allocate_and_copy(count);
+        _m_grow(count);
         _m_last = _m_first + count;
         if (current_size < size()) _m_initialize(begin() + current_size, end());
         else _m_destroy(end(), begin() + current_size);
@@ -527,7 +752,7 @@ namespace art{
 
     template<typename Type, typename Allocator>
     void vector<Type, Allocator>::shrink_to_fit() {
-        _m_allocate_and_copy(size());
+        if (capacity() != size()) _m_allocate_and_copy(size());
     }
 
     template<typename Type, typename Allocator>
@@ -609,16 +834,7 @@ namespace art{
             return false;
         }
 
-        auto iterL = lhs.begin();
-        auto iterR = rhs.begin();
-
-        for (;iterL != lhs.end(); iterL++, iterR++) {
-            if (*iterL != *iterR) {
-                return false;
-            }
-        }
-
-        return true;
+        return std::equal(lhs.data(), lhs.data() + lhs.size(), rhs.data());
     }
 
     template<class U, class UAllocator>
@@ -667,21 +883,10 @@ namespace art{
 
     template<class U, class UAllocator>
     bool operator==(const art::vector<U, UAllocator>& lhs, const std::vector<U, UAllocator>& rhs) {
-        auto a = lhs.size();
         if (lhs.size() != rhs.size()) {
             return false;
         }
-        auto a8 = lhs[0];
-        auto a1 = lhs[1];
-        auto a2= lhs[2];
-        auto a3 = lhs[3];
-
-        for (auto i = 0; i < lhs.size(); ++i) {
-            if (lhs[i] != rhs[i]) {
-                return false;
-            }
-        }
 
-        return true;
+        return std::equal(lhs.data(), lhs.data() + lhs.size(), rhs.data());
     }
 }
\ No newline at end of file